@@ -2,6 +2,16 @@
 
 
 #include "UIMLayer.h"
+#include "Engine/GameInstance.h"
+#include "UIMStackWidget.h"
+#include "UIMSubsystem.h"
+
+void UUIMLayer::NativeOnInitialized()
+{
+    Super::NativeOnInitialized();
+
+    PrewarmWidgets();
+}
 
 TOptional<UUserWidget*> UUIMLayer::Push(TSubclassOf<UUserWidget> WidgetClass)
 {
@@ -11,11 +21,12 @@ TOptional<UUserWidget*> UUIMLayer::Push(TSubclassOf<UUserWidget> WidgetClass)
         return TOptional<UUserWidget*>();
     }
 
-    // Create the widget and add it to the layer
-    UUserWidget* Widget = CreateWidget<UUserWidget>(GetOwningPlayer(), WidgetClass);
+    // Reuse a pooled widget if possible and add it to the layer
+    UUIMSubsystem* UIMSubsystem = GetUIMSubsystem();
+    UUserWidget* Widget = UIMSubsystem ? UIMSubsystem->AcquireWidget(WidgetClass, GetOwningPlayer()) : CreateWidget<UUserWidget>(GetOwningPlayer(), WidgetClass);
     if (ensure(Widget))
     {
-        Push(Widget);
+        PushEntry(Widget, UIMSubsystem != nullptr);
     }
 
     return Widget;
@@ -23,42 +34,186 @@ TOptional<UUserWidget*> UUIMLayer::Push(TSubclassOf<UUserWidget> WidgetClass)
 
 void UUIMLayer::Push(UUserWidget* Widget)
 {
-    if (ensure(LayerBorder && Widget && Widgets.Top() != Widget))
-    {
-        LayerBorder->SetContent(Widget);
-        Widgets.Push(Widget);
-    }
+    PushEntry(Widget, false);
 }
 
 void UUIMLayer::Pop()
 {
-    UUserWidget* Widget = Widgets.Pop();
-    if (Widget) 
+    if (Entries.IsEmpty())
     {
-        Widget->RemoveFromParent();
+        return;
     }
+
+    FUIMLayerEntry Entry = Entries.Pop();
+    RemoveEntry(Entry);
+
+    UpdateEntryStates();
 }
 
 UUserWidget* UUIMLayer::Peek()
 {
-    return Widgets.Top();
+    return Entries.IsEmpty() ? nullptr : Entries.Top().Widget.Get();
 }
 
 void UUIMLayer::Clear()
 {
-    for (UUserWidget* Widget : Widgets) 
+    // Top first, so widgets are suspended in the order they were covered
+    while (!Entries.IsEmpty())
+    {
+        FUIMLayerEntry Entry = Entries.Pop();
+        RemoveEntry(Entry);
+    }
+
+    if (ensure(LayerBorder))
+    {
+        //#Todo_Amr: consider a fallback widget
+        LayerBorder->SetContent(nullptr);
+    }
+}
+
+void UUIMLayer::PrewarmWidgets()
+{
+    UUIMSubsystem* UIMSubsystem = GetUIMSubsystem();
+    if (!UIMSubsystem || !GetOwningPlayer())
+    {
+        return;
+    }
+
+    for (const auto& PrewarmEntry : PrewarmCounts)
     {
-        if (ensure(Widget)) 
+        UIMSubsystem->PrewarmWidgets(PrewarmEntry.Key, PrewarmEntry.Value, GetOwningPlayer());
+    }
+}
+
+TArray<UUserWidget*> UUIMLayer::GetWidgets() const
+{
+    TArray<UUserWidget*> Widgets;
+    Widgets.Reserve(Entries.Num());
+    for (const FUIMLayerEntry& Entry : Entries)
+    {
+        if (Entry.Widget)
         {
-            Widget->RemoveFromParent();
+            Widgets.Add(Entry.Widget);
         }
     }
 
-    Widgets.Empty();
+    return Widgets;
+}
 
-    if (ensure(LayerBorder)) 
+void UUIMLayer::PushEntry(UUserWidget* Widget, const bool bPooled)
+{
+    if (ensure(LayerBorder && Widget && (Entries.IsEmpty() || Entries.Top().Widget != Widget)))
     {
-        //#Todo_Amr: consider a fallback widget
-        LayerBorder->SetContent(nullptr);
+        FUIMLayerEntry& Entry = Entries.AddDefaulted_GetRef();
+        Entry.Widget = Widget;
+        Entry.WidgetClass = Widget->GetClass();
+        Entry.State = EUIMWidgetState::Suspended;
+        Entry.bPooled = bPooled;
+
+        UpdateEntryStates();
     }
 }
+
+void UUIMLayer::RemoveEntry(FUIMLayerEntry& Entry)
+{
+    // Released entries have nothing left to remove
+    if (Entry.State == EUIMWidgetState::Released)
+    {
+        return;
+    }
+
+    SetEntryState(Entry, EUIMWidgetState::Suspended);
+
+    UUserWidget* Widget = Entry.Widget;
+    if (!Widget)
+    {
+        return;
+    }
+
+    // Widgets pushed by instance can be further down the stack
+    const bool bStillInStack = !Entry.bPooled && Entries.ContainsByPredicate([Widget](const FUIMLayerEntry& Other) { return Other.Widget == Widget; });
+
+    UUIMSubsystem* UIMSubsystem = GetUIMSubsystem();
+    if (Entry.bPooled && UIMSubsystem)
+    {
+        UIMSubsystem->ReleaseWidget(Widget);
+    }
+    else if (!bStillInStack)
+    {
+        Widget->RemoveFromParent();
+    }
+
+    Entry.Widget = nullptr;
+}
+
+void UUIMLayer::SetEntryState(FUIMLayerEntry& Entry, const EUIMWidgetState NewState)
+{
+    const EUIMWidgetState OldState = Entry.State;
+    if (OldState == NewState)
+    {
+        return;
+    }
+
+    Entry.State = NewState;
+
+    if (OldState == EUIMWidgetState::Active && Entry.Widget && Entry.Widget->Implements<UUIMStackWidget>())
+    {
+        IUIMStackWidget::Execute_OnStackSuspended(Entry.Widget);
+    }
+
+    // Coming back into view, recreate the widget from the pool
+    if (OldState == EUIMWidgetState::Released)
+    {
+        UUIMSubsystem* UIMSubsystem = GetUIMSubsystem();
+        Entry.Widget = UIMSubsystem ? UIMSubsystem->AcquireWidget(Entry.WidgetClass, GetOwningPlayer()) : CreateWidget<UUserWidget>(GetOwningPlayer(), Entry.WidgetClass);
+        ensure(Entry.Widget);
+    }
+
+    if (NewState == EUIMWidgetState::Released)
+    {
+        UUIMSubsystem* UIMSubsystem = GetUIMSubsystem();
+        if (ensure(Entry.bPooled && UIMSubsystem) && Entry.Widget)
+        {
+            UIMSubsystem->ReleaseWidget(Entry.Widget, true);
+            Entry.Widget = nullptr;
+        }
+    }
+    else if (NewState == EUIMWidgetState::Active && Entry.Widget && Entry.Widget->Implements<UUIMStackWidget>())
+    {
+        IUIMStackWidget::Execute_OnStackActivated(Entry.Widget);
+    }
+}
+
+void UUIMLayer::UpdateEntryStates()
+{
+    // Only entries around the suspended depth change when a single widget is pushed or popped
+    const int32 LastChangedDepth = FMath::Min(MaxSuspendedWidgets + 1, Entries.Num() - 1);
+    for (int32 Depth = LastChangedDepth; Depth >= 0; --Depth)
+    {
+        FUIMLayerEntry& Entry = Entries[Entries.Num() - 1 - Depth];
+
+        EUIMWidgetState State = EUIMWidgetState::Active;
+        if (Depth > MaxSuspendedWidgets && Entry.bPooled)
+        {
+            State = EUIMWidgetState::Released;
+        }
+        else if (Depth > 0)
+        {
+            State = EUIMWidgetState::Suspended;
+        }
+
+        SetEntryState(Entry, State);
+    }
+
+    if (ensure(LayerBorder))
+    {
+        // Covered widgets leave the Slate tree, so they aren't painted or ticked anymore
+        LayerBorder->SetContent(Entries.IsEmpty() ? nullptr : Entries.Top().Widget.Get());
+    }
+}
+
+UUIMSubsystem* UUIMLayer::GetUIMSubsystem() const
+{
+    const UGameInstance* GameInstance = GetGameInstance();
+    return GameInstance ? GameInstance->GetSubsystem<UUIMSubsystem>() : nullptr;
+}
@@ -0,0 +1,5 @@
+// Copyright Amr Hamed
+
+
+#include "UIMStackWidget.h"
+
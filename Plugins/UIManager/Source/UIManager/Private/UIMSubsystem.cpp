@@ -2,8 +2,30 @@
 
 
 #include "UIMSubsystem.h"
+#include "Blueprint/UserWidget.h"
+#include "UIManager.h"
 #include "UIMLayer.h"
 #include "UIMLayout.h"
+#include "UIMPoolableWidget.h"
+
+void UUIMSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UUIMSubsystem::OnWorldCleanup);
+}
+
+void UUIMSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+    const FUIMWidgetPoolStats TotalStats = GetTotalWidgetPoolStats();
+    UE_LOG(LogUIManager, Log, TEXT("Widget pool: %d hits, %d misses, %d discards"), TotalStats.Hits, TotalStats.Misses, TotalStats.Discards);
+
+    EmptyWidgetPools();
+
+    Super::Deinitialize();
+}
 
 TOptional<UUserWidget*> UUIMSubsystem::PushWidgetToLayer(const FGameplayTag LayerTag, TSubclassOf<UUserWidget> WidgetClass, APlayerController* PlayerController)
 {
@@ -32,7 +54,17 @@ void UUIMSubsystem::PushWidgetToLayer(const FGameplayTag LayerTag, UUserWidget*
 
 void UUIMSubsystem::PopWidgetFromLayer(const FGameplayTag LayerTag)
 {
-    return nullptr;
+    check(Layout);
+
+    // Find the layer
+    UUIMLayer* Layer = Layout->Layers.FindRef(LayerTag);
+    if (!Layer)
+    {
+        UE_LOG(LogUIManager, Warning, TEXT("Trying to pop a widget from a non-existing layer with tag '%s'"), *LayerTag.ToString());
+        return;
+    }
+
+    Layer->Pop();
 }
 
 TOptional<UUserWidget*> UUIMSubsystem::PeekWidgetInLayer(const FGameplayTag LayerTag) const
@@ -61,5 +93,162 @@ void UUIMSubsystem::Clear()
 
 TArray<UUserWidget*> UUIMSubsystem::GetWidgetsInLayer(const FGameplayTag LayerTag) const
 {
-    return TArray<UUserWidget*>();
+    check(Layout);
+
+    // Find the layer
+    const UUIMLayer* Layer = Layout->Layers.FindRef(LayerTag);
+    if (!Layer)
+    {
+        UE_LOG(LogUIManager, Warning, TEXT("Trying to get widgets of a non-existing layer with tag '%s'"), *LayerTag.ToString());
+        return TArray<UUserWidget*>();
+    }
+
+    return Layer->GetWidgets();
+}
+
+UUserWidget* UUIMSubsystem::AcquireWidget(TSubclassOf<UUserWidget> WidgetClass, APlayerController* PlayerController)
+{
+    if (!ensureMsgf((WidgetClass && PlayerController), TEXT("Failed to acquire widget: Invalid WidgetClass or PlayerController")))
+    {
+        return nullptr;
+    }
+
+    FUIMWidgetPool& Pool = WidgetPools.FindOrAdd(WidgetClass);
+
+    UUserWidget* Widget = nullptr;
+    while (!Widget && !Pool.FreeWidgets.IsEmpty())
+    {
+        Widget = Pool.FreeWidgets.Pop(EAllowShrinking::No);
+    }
+
+    if (Widget)
+    {
+        ++Pool.Stats.Hits;
+        if (Widget->GetOwningPlayer() != PlayerController)
+        {
+            Widget->SetOwningPlayer(PlayerController);
+        }
+    }
+    else
+    {
+        ++Pool.Stats.Misses;
+        Widget = CreateWidget<UUserWidget>(PlayerController, WidgetClass);
+        if (!ensure(Widget))
+        {
+            return nullptr;
+        }
+    }
+
+    if (Widget->Implements<UUIMPoolableWidget>())
+    {
+        IUIMPoolableWidget::Execute_OnPoolActivated(Widget);
+    }
+
+    return Widget;
+}
+
+void UUIMSubsystem::ReleaseWidget(UUserWidget* Widget, const bool bReleaseSlateResources)
+{
+    if (!ensure(Widget))
+    {
+        return;
+    }
+
+    Widget->RemoveFromParent();
+
+    if (Widget->Implements<UUIMPoolableWidget>())
+    {
+        IUIMPoolableWidget::Execute_OnPoolReset(Widget);
+    }
+
+    if (bReleaseSlateResources)
+    {
+        Widget->ReleaseSlateResources(true);
+    }
+
+    FUIMWidgetPool& Pool = WidgetPools.FindOrAdd(Widget->GetClass());
+    if (Pool.FreeWidgets.Num() >= MaxPooledWidgetsPerClass)
+    {
+        ++Pool.Stats.Discards;
+        return;
+    }
+
+    Pool.FreeWidgets.AddUnique(Widget);
+}
+
+void UUIMSubsystem::PrewarmWidgets(TSubclassOf<UUserWidget> WidgetClass, const int32 Count, APlayerController* PlayerController)
+{
+    if (!ensureMsgf((WidgetClass && PlayerController), TEXT("Failed to pre-warm widgets: Invalid WidgetClass or PlayerController")))
+    {
+        return;
+    }
+
+    FUIMWidgetPool& Pool = WidgetPools.FindOrAdd(WidgetClass);
+
+    const int32 TargetCount = FMath::Min(Count, MaxPooledWidgetsPerClass);
+    Pool.FreeWidgets.Reserve(TargetCount);
+    while (Pool.FreeWidgets.Num() < TargetCount)
+    {
+        UUserWidget* Widget = CreateWidget<UUserWidget>(PlayerController, WidgetClass);
+        if (!ensure(Widget))
+        {
+            return;
+        }
+
+        Pool.FreeWidgets.Add(Widget);
+    }
+}
+
+void UUIMSubsystem::PrewarmLayer(const FGameplayTag LayerTag)
+{
+    check(Layout);
+
+    // Find the layer
+    UUIMLayer* Layer = Layout->Layers.FindRef(LayerTag);
+    if (!Layer)
+    {
+        UE_LOG(LogUIManager, Warning, TEXT("Trying to pre-warm a non-existing layer with tag '%s'"), *LayerTag.ToString());
+        return;
+    }
+
+    Layer->PrewarmWidgets();
+}
+
+void UUIMSubsystem::EmptyWidgetPools()
+{
+    for (auto& PoolEntry : WidgetPools)
+    {
+        PoolEntry.Value.FreeWidgets.Empty();
+    }
+}
+
+FUIMWidgetPoolStats UUIMSubsystem::GetWidgetPoolStats(TSubclassOf<UUserWidget> WidgetClass) const
+{
+    const FUIMWidgetPool* Pool = WidgetPools.Find(WidgetClass);
+    return Pool ? Pool->Stats : FUIMWidgetPoolStats();
+}
+
+FUIMWidgetPoolStats UUIMSubsystem::GetTotalWidgetPoolStats() const
+{
+    FUIMWidgetPoolStats TotalStats;
+    for (const auto& PoolEntry : WidgetPools)
+    {
+        TotalStats.Hits += PoolEntry.Value.Stats.Hits;
+        TotalStats.Misses += PoolEntry.Value.Stats.Misses;
+        TotalStats.Discards += PoolEntry.Value.Stats.Discards;
+    }
+
+    return TotalStats;
+}
+
+void UUIMSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    // Drop widgets created in the world going away, they'd keep it and its player controllers alive
+    for (auto& PoolEntry : WidgetPools)
+    {
+        PoolEntry.Value.FreeWidgets.RemoveAll([World](const UUserWidget* Widget)
+            {
+                return !Widget || Widget->GetWorld() == World;
+            });
+    }
 }
@@ -8,6 +8,41 @@
 #include "GameplayTagContainer.h"
 #include "UIMLayer.generated.h"
 
+class UUIMSubsystem;
+
+/** Lifecycle state of a widget in a layer stack. */
+UENUM(BlueprintType)
+enum class EUIMWidgetState : uint8
+{
+    /** Top widget, shown and bound */
+    Active,
+    /** Covered, kept alive but unbound */
+    Suspended,
+    /** Covered deep in the stack, handed back to the pool and recreated from its class when it comes back into view */
+    Released
+};
+
+/** A widget in a layer stack. */
+USTRUCT(BlueprintType)
+struct FUIMLayerEntry
+{
+    GENERATED_BODY()
+
+    /** The widget, null while released */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    TObjectPtr<UUserWidget> Widget;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    TSubclassOf<UUserWidget> WidgetClass;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    EUIMWidgetState State = EUIMWidgetState::Active;
+
+    /** Whether the widget came from the pool, only those can be released */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    bool bPooled = false;
+};
+
 /** A single UI Layer containing a stack of widgets. */
 UCLASS()
 class UIMANAGER_API UUIMLayer : public UUserWidget
@@ -35,6 +70,31 @@ public:
     UFUNCTION(BlueprintCallable)
     void Clear();
 
+    /** Fills the widget pool with the widgets in PrewarmCounts */
+    UFUNCTION(BlueprintCallable)
+    void PrewarmWidgets();
+
+    /** Gets the widgets of the stack that aren't released, bottom to top. */
+    UFUNCTION(BlueprintCallable)
+    TArray<UUserWidget*> GetWidgets() const;
+
+protected:
+    virtual void NativeOnInitialized() override;
+
+    /** Pushes an entry for Widget on top of the stack, suspending and releasing the ones it covers */
+    void PushEntry(UUserWidget* Widget, const bool bPooled);
+
+    /** Removes Entry's widget from the layer, handing it back to the pool if it came from there */
+    void RemoveEntry(FUIMLayerEntry& Entry);
+
+    /** Moves Entry to NewState, calling stack hooks and acquiring or releasing its widget */
+    void SetEntryState(FUIMLayerEntry& Entry, const EUIMWidgetState NewState);
+
+    /** Updates states of the entries whose depth changed and shows the top widget */
+    void UpdateEntryStates();
+
+    UUIMSubsystem* GetUIMSubsystem() const;
+
 protected:
     /** Gameplay Tag representing the layer type. */
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -42,12 +102,20 @@ protected:
 
     /** Stack of widgets in this layer. */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-    TArray<UUserWidget*> Widgets;
+    TArray<FUIMLayerEntry> Entries;
+
+    /** Covered widgets kept suspended under the top one, deeper pooled widgets are released. */
+    UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+    int32 MaxSuspendedWidgets = 2;
 
     /** Border to display the top widget of this layer. */
     UPROPERTY(BlueprintReadOnly, meta = (BindWidget))
     UBorder* LayerBorder = nullptr;
 
+    /** Widgets created up front for the pool when the layer is initialized, per class. */
+    UPROPERTY(EditAnywhere, Category = "Widget Pool", meta = (ClampMin = "0"))
+    TMap<TSubclassOf<UUserWidget>, int32> PrewarmCounts;
+
 private:
     friend class UUIMSubsystem;
 };
@@ -0,0 +1,28 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "UIMPoolableWidget.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UUIMPoolableWidget : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/** Optional hooks for widgets reused by the UI Manager widget pool. */
+class UIMANAGER_API IUIMPoolableWidget
+{
+	GENERATED_BODY()
+
+public:
+    /** Called every time the widget is taken from the pool or created for it, before it's shown */
+    UFUNCTION(BlueprintNativeEvent, Category = "Widget Pool")
+    void OnPoolActivated();
+
+    /** Called when the widget is returned to the pool, should clear any state a new user mustn't see */
+    UFUNCTION(BlueprintNativeEvent, Category = "Widget Pool")
+    void OnPoolReset();
+};
@@ -0,0 +1,31 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "UIMStackWidget.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UUIMStackWidget : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional hooks for widgets pushed to a UI Layer, called as they get covered and uncovered.
+ * Widgets bind gameplay delegates (e.g. score updates) and start timers when activated, and undo it when suspended.
+ */
+class UIMANAGER_API IUIMStackWidget
+{
+	GENERATED_BODY()
+
+public:
+    /** Called when the widget becomes the top, visible widget of its layer */
+    UFUNCTION(BlueprintNativeEvent, Category = "Layer")
+    void OnStackActivated();
+
+    /** Called when the widget is covered by another one or removed from its layer */
+    UFUNCTION(BlueprintNativeEvent, Category = "Layer")
+    void OnStackSuspended();
+};
@@ -8,6 +8,39 @@
 #include "UIMSubsystem.generated.h"
 
 class UUIMLayout;
+class UUserWidget;
+
+/** Hit and miss counts of the widget pool. */
+USTRUCT(BlueprintType)
+struct FUIMWidgetPoolStats
+{
+    GENERATED_BODY()
+
+    /** Acquired widgets that were taken from the pool */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    int32 Hits = 0;
+
+    /** Acquired widgets that had to be created */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    int32 Misses = 0;
+
+    /** Released widgets left for GC because the pool was full */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    int32 Discards = 0;
+};
+
+/** Free widgets of a single class. */
+USTRUCT()
+struct FUIMWidgetPool
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<TObjectPtr<UUserWidget>> FreeWidgets;
+
+    UPROPERTY()
+    FUIMWidgetPoolStats Stats;
+};
 
 /**
  * UI Manager Subsystem
@@ -18,6 +51,9 @@ class UIMANAGER_API UUIMSubsystem : public UGameInstanceSubsystem
 	GENERATED_BODY()
 	
 public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
     /** Adds a widget to a specific layer by class. */
     UFUNCTION(BlueprintCallable)
     TOptional<UUserWidget*> PushWidgetToLayer(const FGameplayTag LayerTag, TSubclassOf<UUserWidget> WidgetClass, APlayerController* PlayerController);
@@ -46,8 +82,54 @@ public:
     UFUNCTION(BlueprintCallable)
     TArray<UUserWidget*> GetWidgetsInLayer(const FGameplayTag LayerTag) const;
 
+    // Widget Pool
+public:
+    /** Takes a widget of WidgetClass from the pool, or creates one if there's none, and activates it. */
+    UFUNCTION(BlueprintCallable)
+    UUserWidget* AcquireWidget(TSubclassOf<UUserWidget> WidgetClass, APlayerController* PlayerController);
+
+    /**
+     * Removes Widget from its parent, resets it and keeps it for reuse. Callers mustn't use it afterwards.
+     * Releasing its Slate resources frees the Slate tree until the widget is shown again, which rebuilds it.
+     */
+    UFUNCTION(BlueprintCallable)
+    void ReleaseWidget(UUserWidget* Widget, const bool bReleaseSlateResources = false);
+
+    /** Creates widgets of WidgetClass until at least Count of them are pooled. */
+    UFUNCTION(BlueprintCallable)
+    void PrewarmWidgets(TSubclassOf<UUserWidget> WidgetClass, const int32 Count, APlayerController* PlayerController);
+
+    /** Pre-warms the pool with the widgets configured on a specific layer. */
+    UFUNCTION(BlueprintCallable)
+    void PrewarmLayer(const FGameplayTag LayerTag);
+
+    /** Drops all pooled widgets for GC, stats are kept. */
+    UFUNCTION(BlueprintCallable)
+    void EmptyWidgetPools();
+
+    UFUNCTION(BlueprintCallable)
+    FUIMWidgetPoolStats GetWidgetPoolStats(TSubclassOf<UUserWidget> WidgetClass) const;
+
+    /** Stats of all widget classes combined. */
+    UFUNCTION(BlueprintCallable)
+    FUIMWidgetPoolStats GetTotalWidgetPoolStats() const;
+
 protected:
     /** The single active layout containing all layers. */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
     TObjectPtr<UUIMLayout> Layout;
+
+    /** Most free widgets kept per class, widgets released beyond it are left for GC. */
+    UPROPERTY(EditDefaultsOnly, Category = "Widget Pool", meta = (UIMin = "0", ClampMin = "0"))
+    int32 MaxPooledWidgetsPerClass = 8;
+
+private:
+    /** Pooled widgets belong to the world they were created in */
+    void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+private:
+    UPROPERTY(Transient)
+    TMap<TSubclassOf<UUserWidget>, FUIMWidgetPool> WidgetPools;
+
+    FDelegateHandle WorldCleanupHandle;
 };
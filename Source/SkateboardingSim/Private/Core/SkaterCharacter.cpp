@@ -40,10 +40,52 @@ ASkaterCharacter::ASkaterCharacter(const FObjectInitializer& ObjectInitializer)
 	Skateboard->SetupAttachment(GetMesh());
 	Skateboard->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
 
+	// Keep ragdoll bodies around while not bailing so bailing and recovering don't rebuild physics state
+	GetMesh()->bAlwaysCreatePhysicsState = true;
+	Skateboard->bAlwaysCreatePhysicsState = true;
+
 	ScoreComponent = CreateDefaultSubobject<UScoreComponent>(TEXT("ScoreComponent"));
 	SkatingTricksComponent = CreateDefaultSubobject<USkatingTricksComponent>(TEXT("TricksComponent"));
 }
 
+void ASkaterCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	InitialAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+
+	if (USkaterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<USkaterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->RegisterSkater(this);
+	}
+}
+
+void ASkaterCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USkaterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<USkaterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->UnregisterSkater(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASkaterCharacter::ApplySignificanceTier(const ESkaterSignificanceTier Tier, const FSkaterSignificanceTierSettings& TierSettings)
+{
+	SignificanceTier = Tier;
+
+	SetActorTickInterval(TierSettings.TickInterval);
+
+	const EVisibilityBasedAnimTickOption AnimTickOption = TierSettings.bOnlyTickPoseWhenRendered ? EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered : InitialAnimTickOption;
+	for (USkeletalMeshComponent* SkeletalMesh : { GetMesh(), Skateboard.Get() })
+	{
+		SkeletalMesh->bEnableUpdateRateOptimizations = TierSettings.bEnableAnimationURO;
+		SkeletalMesh->VisibilityBasedAnimTickOption = AnimTickOption;
+	}
+
+	SkatingMovementComponent->ApplySignificanceTier(TierSettings);
+}
+
 void ASkaterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
@@ -52,12 +94,13 @@ void ASkaterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 	if (UEnhancedInputComponent* EnhancedInputComponent = CastChecked<UEnhancedInputComponent>(PlayerInputComponent)) {
 
 		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ASkaterCharacter::Move);
+		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Completed, this, &ASkaterCharacter::MoveCompleted);
 		EnhancedInputComponent->BindAction(SlowDownAction, ETriggerEvent::Triggered, this, &ASkaterCharacter::SlowDownTriggered);
 		EnhancedInputComponent->BindAction(SpeedUpAction, ETriggerEvent::Triggered, this, &ASkaterCharacter::SpeedUpTriggered);
 
 		EnhancedInputComponent->BindAction(OllieAction, ETriggerEvent::Ongoing, this, &ASkaterCharacter::Ollie);
-		EnhancedInputComponent->BindAction(OllieAction, ETriggerEvent::Completed, this, &ACharacter::Jump);
-		EnhancedInputComponent->BindAction(OllieAction, ETriggerEvent::Canceled, this, &ACharacter::Jump);
+		EnhancedInputComponent->BindAction(OllieAction, ETriggerEvent::Completed, this, &ASkaterCharacter::OllieReleased);
+		EnhancedInputComponent->BindAction(OllieAction, ETriggerEvent::Canceled, this, &ASkaterCharacter::OllieReleased);
 
 		EnhancedInputComponent->BindAction(GrindAction, ETriggerEvent::Ongoing, this, &ASkaterCharacter::Grind);
 		EnhancedInputComponent->BindAction(FlipAction, ETriggerEvent::Triggered, this, &ASkaterCharacter::Flip);
@@ -70,10 +113,20 @@ void ASkaterCharacter::Move(const FInputActionValue& Value)
 	SkatingMovementComponent->HandleMoveInput(MovementVector.X, MovementVector.Y);
 
 	XMoveValue = MovementVector.X;
+	CapturedInput.SetMove(MovementVector);
+
+	SkatingTricksComponent->HandleTrickDirection(MovementVector);
+}
+
+void ASkaterCharacter::MoveCompleted(const FInputActionValue& Value)
+{
+	SkatingTricksComponent->HandleTrickDirection(FVector2D::ZeroVector);
 }
 
 void ASkaterCharacter::SpeedUpTriggered(const FInputActionValue& Value)
 {
+	CapturedInput.AddFlag(ESkaterInputFlags::SpeedUp);
+
 	if (SkatingMovementComponent->CanSpeedUp()) 
 	{
 		PlayAnimMontage(SpeedUpMontage);
@@ -82,6 +135,8 @@ void ASkaterCharacter::SpeedUpTriggered(const FInputActionValue& Value)
 
 void ASkaterCharacter::SlowDownTriggered(const FInputActionValue& Value)
 {
+	CapturedInput.AddFlag(ESkaterInputFlags::SlowDown);
+
 	if (XMoveValue == 0.f)
 	{
 		SkatingMovementComponent->SlowDown();
@@ -90,17 +145,91 @@ void ASkaterCharacter::SlowDownTriggered(const FInputActionValue& Value)
 
 void ASkaterCharacter::Ollie(const FInputActionValue& Value)
 {
+	CapturedInput.AddFlag(ESkaterInputFlags::Ollie);
+
 	SkatingMovementComponent->IncreaseOllyingAlpha();
 }
 
+void ASkaterCharacter::OllieReleased(const FInputActionValue& Value)
+{
+	CapturedInput.AddFlag(ESkaterInputFlags::OllieReleased);
+
+	Jump();
+
+	SkatingTricksComponent->HandleTrickInput(ESkatingTrickInput::Ollie);
+}
+
 void ASkaterCharacter::Grind(const FInputActionValue& Value)
 {
-	SkatingMovementComponent->TryGrinding();
+	CapturedInput.AddFlag(ESkaterInputFlags::Grind);
+
+	if (SkatingMovementComponent->TryGrinding())
+	{
+		SkatingTricksComponent->HandleTrickInput(ESkatingTrickInput::Grind);
+	}
 }
 
 void ASkaterCharacter::Flip(const FInputActionValue& Value)
 {
-	SkatingTricksComponent->PerformRandomFlipTrick();
+	CapturedInput.AddFlag(ESkaterInputFlags::Flip);
+
+	// Flip inputs not completing a combo keep performing a random flip
+	if (!SkatingTricksComponent->HandleTrickInput(ESkatingTrickInput::Flip))
+	{
+		SkatingTricksComponent->PerformRandomFlipTrick();
+	}
+}
+
+void ASkaterCharacter::ApplyRecordedInput(const FSkaterInputFrame& InputFrame)
+{
+	// Same order as the input bindings
+	const FVector2D MovementVector = InputFrame.GetMove();
+	if (!MovementVector.IsZero())
+	{
+		Move(FInputActionValue(MovementVector));
+	}
+	else
+	{
+		MoveCompleted(FInputActionValue(MovementVector));
+	}
+
+	if (InputFrame.HasFlag(ESkaterInputFlags::SlowDown))
+	{
+		SlowDownTriggered(FInputActionValue(true));
+	}
+
+	if (InputFrame.HasFlag(ESkaterInputFlags::SpeedUp))
+	{
+		SpeedUpTriggered(FInputActionValue(true));
+	}
+
+	if (InputFrame.HasFlag(ESkaterInputFlags::Ollie))
+	{
+		Ollie(FInputActionValue(true));
+	}
+
+	if (InputFrame.HasFlag(ESkaterInputFlags::OllieReleased))
+	{
+		OllieReleased(FInputActionValue(false));
+	}
+
+	if (InputFrame.HasFlag(ESkaterInputFlags::Grind))
+	{
+		Grind(FInputActionValue(true));
+	}
+
+	if (InputFrame.HasFlag(ESkaterInputFlags::Flip))
+	{
+		Flip(FInputActionValue(true));
+	}
+}
+
+FSkaterInputFrame ASkaterCharacter::ConsumeCapturedInput()
+{
+	const FSkaterInputFrame InputFrame = CapturedInput;
+	CapturedInput = FSkaterInputFrame();
+
+	return InputFrame;
 }
 
 void ASkaterCharacter::MoveBlockedBy(const FHitResult& Impact)
@@ -108,6 +237,13 @@ void ASkaterCharacter::MoveBlockedBy(const FHitResult& Impact)
 	HandleWallCollision(Impact);
 }
 
+void ASkaterCharacter::Landed(const FHitResult& Hit)
+{
+	SkatingMovementComponent->OnLanded(Hit);
+
+	Super::Landed(Hit);
+}
+
 void ASkaterCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
 {
 	if (SkatingMovementComponent->IsGrinding()) 
@@ -0,0 +1,329 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkaterGhostRun.h"
+#include "Core/SkatingQuantization.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Memory/MemoryView.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SkateboardingSim.h"
+
+namespace SkaterGhostRun
+{
+	/** Running state of a block being decoded, mirrors what the writer encoded against */
+	struct FDecodeState
+	{
+		FVector3f Location = FVector3f::ZeroVector;
+		FSkatingCompressedRotation Rotation;
+		FSkatingCompressedRotation BoardRotation;
+		FSkatingCompressedRotation BoardRootRotation;
+		uint32 TrickId = 0;
+
+		void SerializeKeyframe(FArchive& Ar)
+		{
+			Ar << Location.X << Location.Y << Location.Z;
+			Ar << Rotation << BoardRotation << BoardRootRotation << TrickId;
+		}
+
+		static FSkatingCompressedRotation AddRotation(const FSkatingCompressedRotation& Rotation, const FSkatingCompressedRotation& Delta)
+		{
+			return { static_cast<uint16>(Rotation.Pitch + Delta.Pitch), static_cast<uint16>(Rotation.Yaw + Delta.Yaw), static_cast<uint16>(Rotation.Roll + Delta.Roll) };
+		}
+
+		static FSkatingCompressedRotation SubtractRotation(const FSkatingCompressedRotation& Rotation, const FSkatingCompressedRotation& Base)
+		{
+			return { static_cast<uint16>(Rotation.Pitch - Base.Pitch), static_cast<uint16>(Rotation.Yaw - Base.Yaw), static_cast<uint16>(Rotation.Roll - Base.Roll) };
+		}
+
+		void ApplyDelta(const int16 (&DeltaLocation)[3], const FSkatingCompressedRotation& DeltaRotation, const FSkatingCompressedRotation& DeltaBoardRotation,
+			const FSkatingCompressedRotation& DeltaBoardRootRotation, const uint32 InTrickId)
+		{
+			Location += FVector3f(DeltaLocation[0], DeltaLocation[1], DeltaLocation[2]) * LocationPrecision;
+			Rotation = AddRotation(Rotation, DeltaRotation);
+			BoardRotation = AddRotation(BoardRotation, DeltaBoardRotation);
+			BoardRootRotation = AddRotation(BoardRootRotation, DeltaBoardRootRotation);
+			TrickId = InTrickId;
+		}
+
+		void ReadDelta(FArchive& Ar)
+		{
+			int16 DeltaLocation[3];
+			FSkatingCompressedRotation DeltaRotation;
+			FSkatingCompressedRotation DeltaBoardRotation;
+			FSkatingCompressedRotation DeltaBoardRootRotation;
+			uint32 NewTrickId = 0;
+			Ar << DeltaLocation[0] << DeltaLocation[1] << DeltaLocation[2];
+			Ar << DeltaRotation << DeltaBoardRotation << DeltaBoardRootRotation << NewTrickId;
+
+			ApplyDelta(DeltaLocation, DeltaRotation, DeltaBoardRotation, DeltaBoardRootRotation, NewTrickId);
+		}
+
+		FSkaterGhostSample ToSample() const
+		{
+			FSkaterGhostSample Sample;
+			Sample.Location = FVector(Location);
+			Sample.Rotation = Rotation.Decompress();
+			Sample.BoardRotation = BoardRotation.Decompress();
+			Sample.BoardRootRotation = BoardRootRotation.Decompress();
+			Sample.TrickId = TrickId;
+			return Sample;
+		}
+	};
+}
+
+FSkaterGhostSample FSkaterGhostSample::Blend(const FSkaterGhostSample& From, const FSkaterGhostSample& To, const float Alpha)
+{
+	FSkaterGhostSample Sample;
+	Sample.Location = FMath::Lerp(From.Location, To.Location, Alpha);
+	Sample.Rotation = FMath::Lerp(From.Rotation, To.Rotation, Alpha);
+	Sample.BoardRotation = FMath::Lerp(From.BoardRotation, To.BoardRotation, Alpha);
+	Sample.BoardRootRotation = FMath::Lerp(From.BoardRootRotation, To.BoardRootRotation, Alpha);
+	Sample.TrickId = From.TrickId;
+	return Sample;
+}
+
+FSkaterGhostRunWriter::FSkaterGhostRunWriter(const float InStepSeconds, const uint32 InTrickRegistryVersion)
+	: StepSeconds(InStepSeconds)
+	, TrickRegistryVersion(InTrickRegistryVersion)
+{
+}
+
+void FSkaterGhostRunWriter::AddSample(const FSkaterGhostSample& Sample)
+{
+	using namespace SkaterGhostRun;
+
+	FMemoryWriter Writer(BlockBytes, false, true);
+
+	FDecodeState Encoded;
+	Encoded.Location = FVector3f(LastDecodedSample.Location);
+	Encoded.Rotation = FSkatingCompressedRotation::Compress(LastDecodedSample.Rotation);
+	Encoded.BoardRotation = FSkatingCompressedRotation::Compress(LastDecodedSample.BoardRotation);
+	Encoded.BoardRootRotation = FSkatingCompressedRotation::Compress(LastDecodedSample.BoardRootRotation);
+
+	if (NumSamples % SamplesPerBlock == 0)
+	{
+		Encoded.Location = FVector3f(Sample.Location);
+		Encoded.Rotation = FSkatingCompressedRotation::Compress(Sample.Rotation);
+		Encoded.BoardRotation = FSkatingCompressedRotation::Compress(Sample.BoardRotation);
+		Encoded.BoardRootRotation = FSkatingCompressedRotation::Compress(Sample.BoardRootRotation);
+		Encoded.TrickId = Sample.TrickId;
+		Encoded.SerializeKeyframe(Writer);
+	}
+	else
+	{
+		// Deltas against the decoded previous sample, so quantization error is corrected by the next delta
+		int16 DeltaLocation[3];
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const int32 Delta = FMath::RoundToInt32((Sample.Location[Axis] - Encoded.Location[Axis]) / LocationPrecision);
+			DeltaLocation[Axis] = static_cast<int16>(FMath::Clamp(Delta, static_cast<int32>(MIN_int16), static_cast<int32>(MAX_int16)));
+		}
+
+		FSkatingCompressedRotation DeltaRotation = FDecodeState::SubtractRotation(FSkatingCompressedRotation::Compress(Sample.Rotation), Encoded.Rotation);
+		FSkatingCompressedRotation DeltaBoardRotation = FDecodeState::SubtractRotation(FSkatingCompressedRotation::Compress(Sample.BoardRotation), Encoded.BoardRotation);
+		FSkatingCompressedRotation DeltaBoardRootRotation = FDecodeState::SubtractRotation(FSkatingCompressedRotation::Compress(Sample.BoardRootRotation), Encoded.BoardRootRotation);
+		uint32 TrickId = Sample.TrickId;
+
+		Writer << DeltaLocation[0] << DeltaLocation[1] << DeltaLocation[2];
+		Writer << DeltaRotation << DeltaBoardRotation << DeltaBoardRootRotation << TrickId;
+
+		Encoded.ApplyDelta(DeltaLocation, DeltaRotation, DeltaBoardRotation, DeltaBoardRootRotation, TrickId);
+	}
+
+	LastDecodedSample = Encoded.ToSample();
+	++NumSamples;
+}
+
+TArray<uint8> FSkaterGhostRunWriter::Finish() const
+{
+	using namespace SkaterGhostRun;
+
+	const int32 NumBlocks = FMath::DivideAndRoundUp(NumSamples, SamplesPerBlock);
+
+	TArray<uint8> Bytes;
+	Bytes.Reserve(HeaderSize + NumBlocks * BlockIndexEntrySize + BlockBytes.Num());
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	float Step = StepSeconds;
+	int32 Samples = NumSamples;
+	int32 Blocks = NumBlocks;
+	uint32 RegistryVersion = TrickRegistryVersion;
+	Writer << Magic << Version << Step << Samples << Blocks << RegistryVersion;
+
+	uint32 Offset = HeaderSize + NumBlocks * BlockIndexEntrySize;
+	for (int32 Block = 0; Block < NumBlocks; ++Block)
+	{
+		uint32 Size = GetBlockSize(FMath::Min(SamplesPerBlock, NumSamples - Block * SamplesPerBlock));
+		Writer << Offset << Size;
+		Offset += Size;
+	}
+
+	Writer.Serialize(const_cast<uint8*>(BlockBytes.GetData()), BlockBytes.Num());
+
+	return Bytes;
+}
+
+bool FSkaterGhostRunWriter::SaveToFile(const FString& Filename) const
+{
+	return FFileHelper::SaveArrayToFile(Finish(), *Filename);
+}
+
+FSkaterGhostRunReader::FSkaterGhostRunReader() = default;
+
+FSkaterGhostRunReader::~FSkaterGhostRunReader()
+{
+	Close();
+}
+
+bool FSkaterGhostRunReader::Open(const FString& Filename)
+{
+	Close();
+
+	// Mapping lets the OS page in only the blocks that get decoded
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (MappedFile)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion());
+	}
+
+	if (MappedRegion)
+	{
+		Bytes = TArrayView<const uint8>(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize()));
+	}
+	else
+	{
+		MappedFile.Reset();
+		if (!FFileHelper::LoadFileToArray(OwnedBytes, *Filename))
+		{
+			return false;
+		}
+
+		Bytes = OwnedBytes;
+	}
+
+	if (!ParseHeader())
+	{
+		UE_LOG(LogSkateboardingSim, Warning, TEXT("'%s' isn't a valid ghost run"), *Filename);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool FSkaterGhostRunReader::Open(TArray<uint8>&& InBytes)
+{
+	Close();
+
+	OwnedBytes = MoveTemp(InBytes);
+	Bytes = OwnedBytes;
+
+	if (!ParseHeader())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void FSkaterGhostRunReader::Close()
+{
+	Bytes = TArrayView<const uint8>();
+	BlockIndex.Reset();
+	NumSamples = 0;
+	TrickRegistryVersion = 0;
+
+	// Region has to go before the file it maps
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	OwnedBytes.Empty();
+}
+
+bool FSkaterGhostRunReader::ParseHeader()
+{
+	using namespace SkaterGhostRun;
+
+	FMemoryReaderView Reader(MakeMemoryView(Bytes.GetData(), Bytes.Num()));
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 NumBlocks = 0;
+	Reader << Magic << Version << StepSeconds << NumSamples << NumBlocks << TrickRegistryVersion;
+
+	if (Reader.IsError() || Magic != FileMagic || Version != FileVersion || NumSamples < 0 || StepSeconds <= 0.f
+		|| NumBlocks != FMath::DivideAndRoundUp(NumSamples, SamplesPerBlock))
+	{
+		return false;
+	}
+
+	BlockIndex.SetNum(NumBlocks);
+	for (int32 Block = 0; Block < NumBlocks; ++Block)
+	{
+		FBlockIndexEntry& Entry = BlockIndex[Block];
+		Reader << Entry.Offset << Entry.Size;
+
+		const int32 NumBlockSamples = FMath::Min(SamplesPerBlock, NumSamples - Block * SamplesPerBlock);
+		if (Reader.IsError() || Entry.Size != static_cast<uint32>(GetBlockSize(NumBlockSamples)) || static_cast<int64>(Entry.Offset) + Entry.Size > Bytes.Num())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FSkaterGhostRunReader::DecodeKeyframe(const int32 Block, FSkaterGhostSample& OutSample) const
+{
+	if (!BlockIndex.IsValidIndex(Block))
+	{
+		return false;
+	}
+
+	const FBlockIndexEntry& Entry = BlockIndex[Block];
+	FMemoryReaderView Reader(MakeMemoryView(Bytes.GetData() + Entry.Offset, SkaterGhostRun::KeyframeSize));
+
+	SkaterGhostRun::FDecodeState State;
+	State.SerializeKeyframe(Reader);
+	OutSample = State.ToSample();
+
+	return !Reader.IsError();
+}
+
+int32 FSkaterGhostRunReader::DecodeBlock(const int32 Block, TArrayView<FSkaterGhostSample> OutSamples) const
+{
+	using namespace SkaterGhostRun;
+
+	if (!BlockIndex.IsValidIndex(Block) || !ensure(OutSamples.Num() > SamplesPerBlock))
+	{
+		return 0;
+	}
+
+	const FBlockIndexEntry& Entry = BlockIndex[Block];
+	FMemoryReaderView Reader(MakeMemoryView(Bytes.GetData() + Entry.Offset, Entry.Size));
+
+	const int32 NumBlockSamples = FMath::Min(SamplesPerBlock, NumSamples - Block * SamplesPerBlock);
+
+	FDecodeState State;
+	State.SerializeKeyframe(Reader);
+	OutSamples[0] = State.ToSample();
+
+	for (int32 SampleIndex = 1; SampleIndex < NumBlockSamples; ++SampleIndex)
+	{
+		State.ReadDelta(Reader);
+		OutSamples[SampleIndex] = State.ToSample();
+	}
+
+	if (!DecodeKeyframe(Block + 1, OutSamples[NumBlockSamples]))
+	{
+		OutSamples[NumBlockSamples] = OutSamples[NumBlockSamples - 1];
+	}
+
+	return Reader.IsError() ? 0 : NumBlockSamples;
+}
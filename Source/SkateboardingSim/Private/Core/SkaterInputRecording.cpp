@@ -0,0 +1,73 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkaterInputRecording.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FSkaterInputFrame::SetMove(const FVector2D& Move)
+{
+	MoveX = static_cast<int8>(FMath::RoundToInt32(FMath::Clamp(Move.X, -1.0, 1.0) * 127.0));
+	MoveY = static_cast<int8>(FMath::RoundToInt32(FMath::Clamp(Move.Y, -1.0, 1.0) * 127.0));
+}
+
+FVector2D FSkaterInputFrame::GetMove() const
+{
+	return FVector2D(MoveX / 127.0, MoveY / 127.0);
+}
+
+FArchive& operator<<(FArchive& Ar, FSkaterInputFrame& Frame)
+{
+	uint8 FlagBits = static_cast<uint8>(Frame.Flags);
+	Ar << Frame.MoveX << Frame.MoveY << FlagBits;
+	Frame.Flags = static_cast<ESkaterInputFlags>(FlagBits);
+
+	return Ar;
+}
+
+void FSkaterInputRecording::Serialize(FArchive& Ar)
+{
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	Ar << Magic << Version;
+
+	if (Ar.IsLoading() && (Magic != FileMagic || Version == 0 || Version > FileVersion))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << StepSeconds;
+	Ar << StartTransform;
+
+	if (Version >= 2)
+	{
+		Ar << RandomSeed;
+	}
+
+	Ar << Frames;
+}
+
+bool FSkaterInputRecording::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	const_cast<FSkaterInputRecording*>(this)->Serialize(Writer);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FSkaterInputRecording::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+
+	return !Reader.IsError();
+}
@@ -0,0 +1,128 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkaterInputReplayComponent.h"
+#include "Core/SkaterCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Misc/App.h"
+#include "Movement/SkatingTricksComponent.h"
+#include "SkateboardingSim.h"
+
+USkaterInputReplayComponent::USkaterInputReplayComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void USkaterInputReplayComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerSkater = Cast<ASkaterCharacter>(GetOwner());
+	ensureMsgf(OwnerSkater, TEXT("USkaterInputReplayComponent can only be added to Skater Characters! Invalid owner: %s"), *GetOwner()->GetName());
+}
+
+void USkaterInputReplayComponent::StartRecording()
+{
+	if (!ensure(OwnerSkater && Mode == ESkaterInputReplayMode::Idle))
+	{
+		return;
+	}
+
+	Recording = FSkaterInputRecording();
+	Recording.StepSeconds = FApp::GetDeltaTime();
+	Recording.StartTransform = OwnerSkater->GetActorTransform();
+	Recording.RandomSeed = FMath::Rand();
+
+	if (USkatingTricksComponent* TricksComponent = OwnerSkater->FindComponentByClass<USkatingTricksComponent>())
+	{
+		TricksComponent->SetRandomSeed(Recording.RandomSeed);
+	}
+
+	// Capture after the frame's input was handled
+	SetTickGroup(TG_PostPhysics);
+	OwnerSkater->ConsumeCapturedInput();
+
+	Mode = ESkaterInputReplayMode::Recording;
+	SetComponentTickEnabled(true);
+}
+
+bool USkaterInputReplayComponent::StopRecording(const FString& Filename)
+{
+	if (Mode != ESkaterInputReplayMode::Recording)
+	{
+		return false;
+	}
+
+	Mode = ESkaterInputReplayMode::Idle;
+	SetComponentTickEnabled(false);
+
+	UE_LOG(LogSkateboardingSim, Log, TEXT("Saving %d recorded input frames to '%s'"), Recording.Frames.Num(), *Filename);
+	return Recording.SaveToFile(Filename);
+}
+
+void USkaterInputReplayComponent::StartPlayback(const FSkaterInputRecording& InRecording)
+{
+	if (!ensure(OwnerSkater && Mode == ESkaterInputReplayMode::Idle))
+	{
+		return;
+	}
+
+	if (!FApp::UseFixedTimeStep() || !FMath::IsNearlyEqual(FApp::GetFixedDeltaTime(), static_cast<double>(InRecording.StepSeconds)))
+	{
+		UE_LOG(LogSkateboardingSim, Warning, TEXT("Input playback isn't running with the recorded fixed time step (%f), results won't be deterministic. Run with -benchmark -fps=%d"),
+			InRecording.StepSeconds, FMath::RoundToInt32(1.f / InRecording.StepSeconds));
+	}
+
+	Recording = InRecording;
+	PlaybackFrame = 0;
+
+	if (USkatingTricksComponent* TricksComponent = OwnerSkater->FindComponentByClass<USkatingTricksComponent>())
+	{
+		TricksComponent->SetRandomSeed(Recording.RandomSeed);
+	}
+
+	// Feed input before movement is simulated
+	SetTickGroup(TG_PrePhysics);
+	if (UCharacterMovementComponent* MovementComponent = OwnerSkater->GetCharacterMovement())
+	{
+		MovementComponent->AddTickPrerequisiteComponent(this);
+	}
+
+	Mode = ESkaterInputReplayMode::Playing;
+	SetComponentTickEnabled(true);
+}
+
+void USkaterInputReplayComponent::StopPlayback()
+{
+	if (Mode != ESkaterInputReplayMode::Playing)
+	{
+		return;
+	}
+
+	Mode = ESkaterInputReplayMode::Idle;
+	SetComponentTickEnabled(false);
+
+	OnPlaybackFinished.Broadcast(this);
+}
+
+void USkaterInputReplayComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Mode == ESkaterInputReplayMode::Recording)
+	{
+		Recording.Frames.Add(OwnerSkater->ConsumeCapturedInput());
+	}
+	else if (Mode == ESkaterInputReplayMode::Playing)
+	{
+		if (!Recording.Frames.IsValidIndex(PlaybackFrame))
+		{
+			StopPlayback();
+			return;
+		}
+
+		OwnerSkater->ApplyRecordedInput(Recording.Frames[PlaybackFrame++]);
+		OwnerSkater->ConsumeCapturedInput();
+	}
+}
@@ -0,0 +1,122 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkatingBenchmarkCourse.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Obstacles/GrindRailSet.h"
+
+namespace SkatingBenchmarkCourse
+{
+	/** Engine basic shapes are 100 units wide */
+	constexpr float BlockMeshSize = 100.f;
+
+	constexpr float FloorThickness = 100.f;
+	constexpr float RampThickness = 100.f;
+
+	/** Skaters start this far into their lane, above the floor so they land on it */
+	constexpr float StartOffset = 500.f;
+	constexpr float StartHeight = 100.f;
+}
+
+ASkatingBenchmarkCourse::ASkatingBenchmarkCourse()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Blocks = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Blocks"));
+	Blocks->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Blocks->SetMobility(EComponentMobility::Static);
+	RootComponent = Blocks;
+}
+
+void ASkatingBenchmarkCourse::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	using namespace SkatingBenchmarkCourse;
+
+	Blocks->ClearInstances();
+	Blocks->SetStaticMesh(BlockMesh.LoadSynchronous());
+
+	const int32 NumLanes = LaneScenarios.Num();
+	AddBlock(FVector(LaneLength * 0.5f, (NumLanes - 1) * LaneWidth * 0.5f, -FloorThickness * 0.5f),
+		FVector(LaneLength + StartOffset * 2.f, NumLanes * LaneWidth, FloorThickness));
+
+	// Humps of an up and a down ramp meeting at their high ends, sunk into the floor at their low ends
+	const int32 SlopesLane = FindLane(TEXT("Slopes"));
+	if (SlopesLane != INDEX_NONE)
+	{
+		const float RampLength = RampSpacing * 0.5f;
+		const float RampCenterHeight = RampLength * 0.5f * FMath::Tan(FMath::DegreesToRadians(RampAngle));
+		const float RampCenterZ = RampCenterHeight - RampThickness * 0.5f / FMath::Cos(FMath::DegreesToRadians(RampAngle));
+
+		const FVector LaneStart = GetLaneStart(SlopesLane);
+		for (float HumpStart = StartOffset * 2.f; HumpStart + RampSpacing <= LaneLength; HumpStart += RampSpacing * 2.f)
+		{
+			const FVector RampSize(RampLength, LaneWidth, RampThickness);
+			AddBlock(LaneStart + FVector(HumpStart + RampLength * 0.5f, 0.f, RampCenterZ), RampSize, FRotator(RampAngle, 0.f, 0.f));
+			AddBlock(LaneStart + FVector(HumpStart + RampLength * 1.5f, 0.f, RampCenterZ), RampSize, FRotator(-RampAngle, 0.f, 0.f));
+		}
+	}
+}
+
+void ASkatingBenchmarkCourse::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const int32 GrindingLane = FindLane(TEXT("Grinding"));
+	if (GrindingLane == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The rail has no collision, skaters roll under it until they ollie and grind
+	const FVector RailStart = GetLaneStart(GrindingLane) + FVector(RailStartDistance, 0.f, RailHeight);
+	const FVector RailEnd = GetLaneStart(GrindingLane) + FVector(LaneLength, 0.f, RailHeight);
+	const FVector RailPoints[] = { GetActorTransform().TransformPosition(RailStart), GetActorTransform().TransformPosition(RailEnd) };
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = this;
+	RailSet = GetWorld()->SpawnActor<AGrindRailSet>(SpawnParameters);
+	if (ensure(RailSet))
+	{
+		RailSet->AddRail(RailPoints);
+	}
+}
+
+void ASkatingBenchmarkCourse::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (RailSet)
+	{
+		RailSet->Destroy();
+		RailSet = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ASkatingBenchmarkCourse::FindScenarioStart(const FName Scenario, FTransform& OutStart) const
+{
+	const int32 Lane = FindLane(Scenario);
+	if (Lane == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FVector LocalStart = GetLaneStart(Lane) + FVector(0.f, 0.f, SkatingBenchmarkCourse::StartHeight);
+	OutStart = FTransform(LocalStart) * GetActorTransform();
+	OutStart.SetScale3D(FVector::OneVector);
+	return true;
+}
+
+FVector ASkatingBenchmarkCourse::GetLaneStart(const int32 Lane) const
+{
+	return FVector(SkatingBenchmarkCourse::StartOffset, Lane * LaneWidth, 0.f);
+}
+
+void ASkatingBenchmarkCourse::AddBlock(const FVector& Center, const FVector& Size, const FRotator& Rotation)
+{
+	Blocks->AddInstance(FTransform(Rotation, Center, Size / SkatingBenchmarkCourse::BlockMeshSize));
+}
@@ -2,4 +2,387 @@
 
 
 #include "Core/SkatingGameMode.h"
+#include "Core/SkaterCharacter.h"
+#include "Core/SkaterInputReplayComponent.h"
+#include "Core/SkatingBenchmarkCourse.h"
+#include "Core/SkatingMemory.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Gameplay/ScoreComponent.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Movement/SkatingMovementComponent.h"
+#include "SkateboardingSim.h"
 
+namespace SkatingGameMode
+{
+	/** Checksum of skater's final state, quantized so it's stable across runs of the same build */
+	uint32 ComputeSkaterChecksum(const ASkaterCharacter& Skater)
+	{
+		const FVector Location = Skater.GetActorLocation();
+		const FRotator Rotation = Skater.GetActorRotation();
+		const UScoreComponent* ScoreComponent = Skater.FindComponentByClass<UScoreComponent>();
+
+		const int32 State[] =
+		{
+			FMath::RoundToInt32(Location.X),
+			FMath::RoundToInt32(Location.Y),
+			FMath::RoundToInt32(Location.Z),
+			FMath::RoundToInt32(Rotation.Pitch * 10.0),
+			FMath::RoundToInt32(Rotation.Yaw * 10.0),
+			FMath::RoundToInt32(Rotation.Roll * 10.0),
+			ScoreComponent ? FMath::RoundToInt32(ScoreComponent->GetTotalScore()) : 0
+		};
+
+		return FCrc::MemCrc32(State, sizeof(State));
+	}
+
+	/** Player Start tagged Tag, unlike FindPlayerStart there's no fallback to untagged ones */
+	const APlayerStart* FindTaggedPlayerStart(UWorld* World, const FName Tag)
+	{
+		for (TActorIterator<APlayerStart> It(World); It; ++It)
+		{
+			if (It->PlayerStartTag == Tag)
+			{
+				return *It;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+ASkatingGameMode::ASkatingGameMode()
+{
+	// Only ticks to measure input playback
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void ASkatingGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	FParse::Value(FCommandLine::Get(), TEXT("SkateReplay="), InputReplayFilename);
+	FParse::Value(FCommandLine::Get(), TEXT("SkateRecord="), InputRecordFilename);
+
+	// The allocation counter was installed on module startup, swapping GMalloc here would race other threads
+	bIsBenchmarking = FParse::Param(FCommandLine::Get(), TEXT("SkateBenchmark"));
+	if (bIsBenchmarking && !SkatingMemory::IsAllocationCounterInstalled())
+	{
+		UE_LOG(LogSkateboardingSim, Warning, TEXT("Benchmark allocations aren't counted, the allocation counter isn't installed"));
+	}
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("SkateBenchmarkBaseline="), BenchmarkBaselineFilename))
+	{
+		BenchmarkBaselineFilename = SkatingPerfScenarios::GetDefaultBaselineFilename();
+	}
+}
+
+void ASkatingGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	if (bIsBenchmarking)
+	{
+		StartBenchmark();
+	}
+	else if (IsReplayingInput())
+	{
+		StartInputPlayback();
+	}
+}
+
+void ASkatingGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	// Replays run without a player skater
+	if (IsReplayingInput())
+	{
+		return;
+	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+
+	if (!InputRecordFilename.IsEmpty() && !InputReplayComponent)
+	{
+		if (ASkaterCharacter* Skater = Cast<ASkaterCharacter>(NewPlayer->GetPawn()))
+		{
+			InputReplayComponent = NewObject<USkaterInputReplayComponent>(Skater);
+			InputReplayComponent->RegisterComponent();
+			InputReplayComponent->StartRecording();
+		}
+	}
+}
+
+void ASkatingGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (InputReplayComponent && InputReplayComponent->GetMode() == ESkaterInputReplayMode::Recording)
+	{
+		InputReplayComponent->StopRecording(InputRecordFilename);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASkatingGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Previous frame's game thread time, the same one "stat unit" shows
+	if (InputReplayComponent && InputReplayComponent->GetMode() == ESkaterInputReplayMode::Playing)
+	{
+		PlaybackGameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+		const uint64 NumScopedAllocations = SkatingMemory::GetNumScopedAllocations();
+		if (InputReplayComponent->GetPlaybackFrame() * InputReplayComponent->GetRecording().StepSeconds > SkatingPerfScenarios::WarmupSeconds)
+		{
+			PlaybackAllocations += NumScopedAllocations - LastNumScopedAllocations;
+		}
+		LastNumScopedAllocations = NumScopedAllocations;
+
+		const USkatingMovementComponent* MovementComponent = InputReplayComponent->GetOwner()->FindComponentByClass<USkatingMovementComponent>();
+		if (MovementComponent && MovementComponent->IsGrinding())
+		{
+			++PlaybackGrindingFrames;
+		}
+	}
+}
+
+void ASkatingGameMode::StartInputPlayback()
+{
+	FSkaterInputRecording Recording;
+	if (!Recording.LoadFromFile(InputReplayFilename))
+	{
+		UE_LOG(LogSkateboardingSim, Error, TEXT("Failed to load input recording '%s'"), *InputReplayFilename);
+	}
+	else if (StartInputPlayback(Recording, Recording.StartTransform))
+	{
+		UE_LOG(LogSkateboardingSim, Log, TEXT("Playing back %d input frames from '%s'"), Recording.Frames.Num(), *InputReplayFilename);
+		return;
+	}
+
+	// Nothing will ever finish playing back, CI runs would hang
+	if (FApp::IsUnattended())
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+}
+
+bool ASkatingGameMode::StartInputPlayback(const FSkaterInputRecording& Recording, const FTransform& StartTransform)
+{
+	if (!DefaultPawnClass || !DefaultPawnClass->IsChildOf<ASkaterCharacter>())
+	{
+		UE_LOG(LogSkateboardingSim, Error, TEXT("Input playback requires a Skater Character as Default Pawn Class"));
+		return false;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ASkaterCharacter* Skater = GetWorld()->SpawnActor<ASkaterCharacter>(DefaultPawnClass, StartTransform, SpawnParameters);
+	if (!ensure(Skater))
+	{
+		return false;
+	}
+
+	Skater->SpawnDefaultController();
+
+	InputReplayComponent = NewObject<USkaterInputReplayComponent>(Skater);
+	InputReplayComponent->RegisterComponent();
+	InputReplayComponent->OnPlaybackFinished.AddUObject(this, &ASkatingGameMode::OnInputPlaybackFinished);
+	InputReplayComponent->StartPlayback(Recording);
+
+	PlaybackStartSeconds = FPlatformTime::Seconds();
+	PlaybackStartPhysicsQueries = USkatingMovementComponent::GetNumPhysicsQueries();
+	PlaybackGameThreadMs = 0.0;
+	PlaybackAllocations = 0;
+	LastNumScopedAllocations = SkatingMemory::GetNumScopedAllocations();
+	PlaybackGrindingFrames = 0;
+	SetActorTickEnabled(true);
+
+	return true;
+}
+
+bool ASkatingGameMode::IsPlayingBackInput() const
+{
+	return InputReplayComponent && InputReplayComponent->GetMode() == ESkaterInputReplayMode::Playing;
+}
+
+void ASkatingGameMode::OnInputPlaybackFinished(USkaterInputReplayComponent* ReplayComponent)
+{
+	const int32 NumFrames = FMath::Max(1, ReplayComponent->GetPlaybackFrame());
+	const double MillisecondsPerFrame = (FPlatformTime::Seconds() - PlaybackStartSeconds) * 1000.0 / NumFrames;
+	const uint32 NumPhysicsQueries = USkatingMovementComponent::GetNumPhysicsQueries() - PlaybackStartPhysicsQueries;
+
+	const ASkaterCharacter* Skater = CastChecked<ASkaterCharacter>(ReplayComponent->GetOwner());
+	LastPlaybackChecksum = SkatingGameMode::ComputeSkaterChecksum(*Skater);
+
+	UE_LOG(LogSkateboardingSim, Display, TEXT("Input playback finished: Frames=%d, MsPerFrame=%.3f, GameThreadMs=%.3f, PhysicsQueries=%u, Checksum=0x%08X"),
+		NumFrames, MillisecondsPerFrame, PlaybackGameThreadMs / NumFrames, NumPhysicsQueries, LastPlaybackChecksum);
+
+	if (bIsBenchmarkRunning)
+	{
+		const SkatingPerfScenarios::FScenario& Scenario = BenchmarkScenarios[BenchmarkResults.Num()];
+
+		FSkatingPerfScenarioMetrics& Result = BenchmarkResults.AddDefaulted_GetRef();
+		Result.Name = Scenario.Name.ToString();
+		Result.NumFrames = NumFrames;
+		Result.GrindingFrames = PlaybackGrindingFrames;
+		Result.GameThreadMs = PlaybackGameThreadMs / NumFrames;
+		Result.PhysicsQueriesPerFrame = static_cast<float>(NumPhysicsQueries) / NumFrames;
+
+		const int32 NumWarmFrames = NumFrames - FMath::RoundToInt32(SkatingPerfScenarios::WarmupSeconds / ReplayComponent->GetRecording().StepSeconds);
+		Result.AllocationsPerFrame = NumWarmFrames > 0 ? static_cast<float>(PlaybackAllocations) / NumWarmFrames : 0.f;
+
+		// Otherwise its allocation limit and timings measure a skater rolling next to the rail
+		if (Scenario.bRequiresGrinding && !PlaybackGrindingFrames)
+		{
+			++NumBenchmarkFailures;
+			UE_LOG(LogSkateboardingSim, Error, TEXT("Benchmark scenario %s never grinded, its start needs a rail in reach"), *Result.Name);
+		}
+
+		// Scenarios don't share skaters, a bail or grind can't leak into the next one
+		InputReplayComponent = nullptr;
+		if (APawn* SkaterPawn = Cast<APawn>(ReplayComponent->GetOwner()))
+		{
+			if (AController* SkaterController = SkaterPawn->GetController())
+			{
+				SkaterController->Destroy();
+			}
+
+			SkaterPawn->Destroy();
+		}
+
+		StartNextBenchmarkScenario();
+		return;
+	}
+
+	// Playbacks started by automation tests keep the editor running
+	if (!InputReplayFilename.IsEmpty() && FApp::IsUnattended())
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void ASkatingGameMode::StartBenchmark(TConstArrayView<FName> Scenarios)
+{
+	BenchmarkScenarios = SkatingPerfScenarios::BuildScenarios(FApp::UseFixedTimeStep() ? FApp::GetFixedDeltaTime() : 1.f / 60.f);
+	if (!Scenarios.IsEmpty())
+	{
+		BenchmarkScenarios.RemoveAll([Scenarios](const SkatingPerfScenarios::FScenario& Scenario) { return !Scenarios.Contains(Scenario.Name); });
+	}
+
+	BenchmarkResults.Reset(BenchmarkScenarios.Num());
+	NumBenchmarkFailures = 0;
+	bIsBenchmarkRunning = true;
+
+	StartNextBenchmarkScenario();
+}
+
+void ASkatingGameMode::StartNextBenchmarkScenario()
+{
+	while (BenchmarkResults.Num() < BenchmarkScenarios.Num())
+	{
+		const SkatingPerfScenarios::FScenario& Scenario = BenchmarkScenarios[BenchmarkResults.Num()];
+
+		FTransform StartTransform;
+		if (FindBenchmarkScenarioStart(Scenario.Name, StartTransform))
+		{
+			UE_LOG(LogSkateboardingSim, Display, TEXT("Benchmark scenario %s: %d frames from %s"),
+				*Scenario.Name.ToString(), Scenario.Recording.Frames.Num(), *StartTransform.GetLocation().ToString());
+
+			if (StartInputPlayback(Scenario.Recording, StartTransform))
+			{
+				return;
+			}
+		}
+		else
+		{
+			UE_LOG(LogSkateboardingSim, Error, TEXT("Benchmark scenario %s has neither a Player Start tagged %s nor a benchmark course lane"),
+				*Scenario.Name.ToString(), *Scenario.Name.ToString());
+		}
+
+		// Keep results aligned with scenarios
+		BenchmarkResults.AddDefaulted_GetRef().Name = Scenario.Name.ToString();
+	}
+
+	FinishBenchmark();
+}
+
+bool ASkatingGameMode::FindBenchmarkScenarioStart(const FName Scenario, FTransform& OutStart)
+{
+	// Starting anywhere else would measure flat ground instead of the ramps or rail the scenario is about
+	if (const APlayerStart* PlayerStart = SkatingGameMode::FindTaggedPlayerStart(GetWorld(), Scenario))
+	{
+		OutStart = PlayerStart->GetActorTransform();
+		return true;
+	}
+
+	if (!BenchmarkCourse)
+	{
+		BenchmarkCourse = GetWorld()->SpawnActor<ASkatingBenchmarkCourse>(BenchmarkCourseLocation, FRotator::ZeroRotator);
+	}
+
+	return BenchmarkCourse && BenchmarkCourse->FindScenarioStart(Scenario, OutStart);
+}
+
+void ASkatingGameMode::FinishBenchmark()
+{
+	bIsBenchmarkRunning = false;
+
+	// Benchmarks started by automation tests are checked by the tests
+	if (!bIsBenchmarking)
+	{
+		return;
+	}
+
+	const bool bUpdateBaseline = FParse::Param(FCommandLine::Get(), TEXT("SkateBenchmarkUpdateBaseline"));
+
+	FSkatingPerfBaseline Baseline;
+	if (!Baseline.LoadFromFile(BenchmarkBaselineFilename))
+	{
+		UE_LOG(LogSkateboardingSim, Error, TEXT("Failed to load benchmark baseline '%s'"), *BenchmarkBaselineFilename);
+	}
+
+	UE_LOG(LogSkateboardingSim, Display, TEXT("Benchmark results against '%s' (threshold %.0f%%):"), *BenchmarkBaselineFilename, Baseline.RegressionThreshold * 100.f);
+	const int32 NumRegressions = SkatingPerfScenarios::CompareWithBaseline(Baseline, BenchmarkResults, bUpdateBaseline) + NumBenchmarkFailures;
+
+	FSkatingPerfBaseline Results;
+	Results.RegressionThreshold = Baseline.RegressionThreshold;
+	Results.Scenarios = BenchmarkResults;
+
+	// Allocation limits are hand set, keep them when updating the baseline
+	for (FSkatingPerfScenarioMetrics& Result : Results.Scenarios)
+	{
+		if (const FSkatingPerfScenarioMetrics* BaselineMetrics = Baseline.FindScenario(Result.Name))
+		{
+			Result.MaxAllocationsPerFrame = BaselineMetrics->MaxAllocationsPerFrame;
+		}
+	}
+
+	const FString ResultsFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("SkatingPerfResults.json"));
+	Results.SaveToFile(ResultsFilename);
+
+	// Scenarios that didn't run would record an empty baseline
+	const bool bAllScenariosRan = !NumBenchmarkFailures && !Results.Scenarios.ContainsByPredicate([](const FSkatingPerfScenarioMetrics& Result) { return Result.NumFrames <= 0; });
+	if (bUpdateBaseline && bAllScenariosRan)
+	{
+		UE_LOG(LogSkateboardingSim, Display, TEXT("Updating benchmark baseline '%s'"), *BenchmarkBaselineFilename);
+		Results.SaveToFile(BenchmarkBaselineFilename);
+	}
+	else if (bUpdateBaseline)
+	{
+		UE_LOG(LogSkateboardingSim, Error, TEXT("Not updating benchmark baseline '%s', some scenarios didn't run"), *BenchmarkBaselineFilename);
+	}
+
+	if (NumRegressions)
+	{
+		UE_LOG(LogSkateboardingSim, Error, TEXT("Benchmark failed: %d metrics regressed"), NumRegressions);
+	}
+
+	if (FApp::IsUnattended())
+	{
+		FPlatformMisc::RequestExitWithStatus(false, NumRegressions ? 1 : 0);
+	}
+}
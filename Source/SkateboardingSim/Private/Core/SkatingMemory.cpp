@@ -0,0 +1,123 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkatingMemory.h"
+#include "HAL/MemoryBase.h"
+#include "SkateboardingSim.h"
+#include <atomic>
+
+LLM_DEFINE_TAG(Skating);
+
+namespace SkatingMemory
+{
+	static thread_local int32 AllocationScopeDepth = 0;
+
+	static std::atomic<uint64> NumScopedAllocations = 0;
+
+	static FMalloc* AllocationCounter = nullptr;
+
+	/** Forwards everything to the allocator it wraps, counting allocations made inside allocation scopes */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInnerMalloc)
+			: InnerMalloc(InInnerMalloc)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count)
+			{
+				CountAllocation();
+			}
+
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count)
+			{
+				CountAllocation();
+			}
+
+			return InnerMalloc->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { InnerMalloc->Free(Original); }
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return InnerMalloc->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return InnerMalloc->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { InnerMalloc->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { InnerMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override { InnerMalloc->MarkTLSCachesAsUsedOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override { InnerMalloc->MarkTLSCachesAsUnusedOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { InnerMalloc->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { InnerMalloc->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { InnerMalloc->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return InnerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return InnerMalloc->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return InnerMalloc->GetDescriptiveName(); }
+
+	private:
+		FORCEINLINE void CountAllocation() const
+		{
+			if (AllocationScopeDepth > 0)
+			{
+				NumScopedAllocations.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		FMalloc* InnerMalloc;
+	};
+
+	void InstallAllocationCounter()
+	{
+		check(IsInGameThread());
+
+		if (AllocationCounter)
+		{
+			return;
+		}
+
+		// Allocations made before this are still freed by the allocator we wrap, so swapping mid run is safe
+		AllocationCounter = new FCountingMalloc(GMalloc);
+		GMalloc = AllocationCounter;
+
+		UE_LOG(LogSkateboardingSim, Log, TEXT("Counting heap allocations of skating scopes"));
+	}
+
+	bool IsAllocationCounterInstalled()
+	{
+		return AllocationCounter != nullptr;
+	}
+
+	uint64 GetNumScopedAllocations()
+	{
+		return NumScopedAllocations.load(std::memory_order_relaxed);
+	}
+
+	FAllocationScope::FAllocationScope()
+	{
+		++AllocationScopeDepth;
+	}
+
+	FAllocationScope::~FAllocationScope()
+	{
+		--AllocationScopeDepth;
+	}
+}
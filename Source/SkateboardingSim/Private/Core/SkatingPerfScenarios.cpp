@@ -0,0 +1,224 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkatingPerfScenarios.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SkateboardingSim.h"
+
+namespace SkatingPerfScenarios
+{
+	/** Appends frames to a scenario recording */
+	struct FScript
+	{
+		FScript(FSkaterInputRecording& InRecording, const float StepSeconds)
+			: Recording(InRecording)
+			, FramesPerSecond(FMath::RoundToInt32(1.f / StepSeconds))
+		{
+			Recording.StepSeconds = StepSeconds;
+		}
+
+		int32 Frames(const float Seconds) const { return FMath::Max(1, FMath::RoundToInt32(Seconds * FramesPerSecond)); }
+
+		/** Holds Move for Seconds, adding Flags to the first frame only */
+		FScript& Hold(const float Seconds, const FVector2D& Move, const ESkaterInputFlags Flags = ESkaterInputFlags::None)
+		{
+			const int32 NumFrames = Frames(Seconds);
+			for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+			{
+				FSkaterInputFrame& Frame = Recording.Frames.AddDefaulted_GetRef();
+				Frame.SetMove(Move);
+				Frame.Flags = FrameIndex ? ESkaterInputFlags::None : Flags;
+			}
+
+			return *this;
+		}
+
+		/** Adds Flags to every frame for Seconds */
+		FScript& Repeat(const float Seconds, const FVector2D& Move, const ESkaterInputFlags Flags)
+		{
+			const int32 NumFrames = Frames(Seconds);
+			for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+			{
+				FSkaterInputFrame& Frame = Recording.Frames.AddDefaulted_GetRef();
+				Frame.SetMove(Move);
+				Frame.Flags = Flags;
+			}
+
+			return *this;
+		}
+
+		FScript& PushOff()
+		{
+			return Hold(0.5f, Forward, ESkaterInputFlags::SpeedUp)
+				.Hold(0.5f, Forward, ESkaterInputFlags::SpeedUp);
+		}
+
+		/** Charges an ollie for ChargeSeconds and releases it */
+		FScript& Ollie(const float ChargeSeconds)
+		{
+			return Repeat(ChargeSeconds, Forward, ESkaterInputFlags::Ollie)
+				.Hold(1.f / FramesPerSecond, Forward, ESkaterInputFlags::OllieReleased);
+		}
+
+		static inline const FVector2D Forward = FVector2D(0.0, 1.0);
+
+		FSkaterInputRecording& Recording;
+		int32 FramesPerSecond;
+	};
+
+	FString GetDefaultBaselineFilename()
+	{
+		return FPaths::Combine(FPaths::ProjectConfigDir(), TEXT("Benchmarks"), TEXT("SkatingPerfBaseline.json"));
+	}
+
+	TArray<FScenario> BuildScenarios(const float StepSeconds)
+	{
+		TArray<FScenario> Scenarios;
+
+		{
+			FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+			Scenario.Name = TEXT("Cruising");
+			FScript(Scenario.Recording, StepSeconds)
+				.PushOff()
+				.Hold(20.f, FScript::Forward);
+		}
+
+		{
+			// Weaving across ramps keeps the slope adaptation busy
+			FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+			Scenario.Name = TEXT("Slopes");
+			FScript Script(Scenario.Recording, StepSeconds);
+			Script.PushOff();
+			for (int32 Turn = 0; Turn < 10; ++Turn)
+			{
+				Script.Hold(1.f, FVector2D(Turn % 2 ? -0.5 : 0.5, 1.0));
+			}
+		}
+
+		{
+			// Starts right before a long low rail, keeps trying to grind until it latches on then rides it
+			FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+			Scenario.Name = TEXT("Grinding");
+			Scenario.bRequiresGrinding = true;
+			FScript(Scenario.Recording, StepSeconds)
+				.PushOff()
+				.Ollie(0.5f)
+				.Repeat(0.5f, FScript::Forward, ESkaterInputFlags::Grind)
+				.Hold(20.f, FVector2D::ZeroVector);
+		}
+
+		{
+			FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+			Scenario.Name = TEXT("Flips");
+			FScript Script(Scenario.Recording, StepSeconds);
+			Script.PushOff();
+			for (int32 Flip = 0; Flip < 10; ++Flip)
+			{
+				Script.Ollie(0.3f)
+					.Hold(0.1f, FScript::Forward)
+					.Hold(1.5f, FScript::Forward, ESkaterInputFlags::Flip);
+			}
+		}
+
+		{
+			// Flipping right before landing bails, recovery takes BailingDuration
+			FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+			Scenario.Name = TEXT("Bails");
+			FScript Script(Scenario.Recording, StepSeconds);
+			for (int32 Bail = 0; Bail < 4; ++Bail)
+			{
+				Script.PushOff()
+					.Ollie(0.1f)
+					.Hold(0.35f, FScript::Forward)
+					.Hold(4.5f, FVector2D::ZeroVector, ESkaterInputFlags::Flip);
+			}
+		}
+
+		return Scenarios;
+	}
+
+	int32 CompareWithBaseline(const FSkatingPerfBaseline& Baseline, TConstArrayView<FSkatingPerfScenarioMetrics> Results, const bool bAllowMissingBaseline)
+	{
+		int32 NumRegressions = 0;
+
+		auto CompareMetric = [&Baseline, &NumRegressions](const FString& Scenario, const TCHAR* Metric, const float Value, const float BaselineValue)
+			{
+				// Metrics recorded at 0 have to stay at 0, there's no relative change to compare
+				const bool bRegressed = BaselineValue > 0.f
+					? Value / BaselineValue - 1.f > Baseline.RegressionThreshold
+					: Value > KINDA_SMALL_NUMBER;
+
+				const float Change = BaselineValue > 0.f ? Value / BaselineValue - 1.f : 0.f;
+				if (bRegressed)
+				{
+					++NumRegressions;
+					UE_LOG(LogSkateboardingSim, Error, TEXT("  %s.%s = %.3f, baseline %.3f (%+.1f%%) REGRESSED"), *Scenario, Metric, Value, BaselineValue, Change * 100.f);
+				}
+				else
+				{
+					UE_LOG(LogSkateboardingSim, Display, TEXT("  %s.%s = %.3f, baseline %.3f (%+.1f%%)"), *Scenario, Metric, Value, BaselineValue, Change * 100.f);
+				}
+			};
+
+		for (const FSkatingPerfScenarioMetrics& Result : Results)
+		{
+			if (Result.NumFrames <= 0)
+			{
+				++NumRegressions;
+				UE_LOG(LogSkateboardingSim, Error, TEXT("  %s didn't run"), *Result.Name);
+				continue;
+			}
+
+			const FSkatingPerfScenarioMetrics* BaselineMetrics = Baseline.FindScenario(Result.Name);
+			if (!BaselineMetrics || BaselineMetrics->NumFrames <= 0)
+			{
+				if (bAllowMissingBaseline)
+				{
+					UE_LOG(LogSkateboardingSim, Warning, TEXT("  %s has no recorded baseline"), *Result.Name);
+				}
+				else
+				{
+					++NumRegressions;
+					UE_LOG(LogSkateboardingSim, Error, TEXT("  %s has no recorded baseline, record one with -SkateBenchmarkUpdateBaseline"), *Result.Name);
+				}
+				continue;
+			}
+
+			CompareMetric(Result.Name, TEXT("GameThreadMs"), Result.GameThreadMs, BaselineMetrics->GameThreadMs);
+			CompareMetric(Result.Name, TEXT("PhysicsQueriesPerFrame"), Result.PhysicsQueriesPerFrame, BaselineMetrics->PhysicsQueriesPerFrame);
+
+			if (BaselineMetrics->MaxAllocationsPerFrame >= 0.f && Result.AllocationsPerFrame > BaselineMetrics->MaxAllocationsPerFrame)
+			{
+				++NumRegressions;
+				UE_LOG(LogSkateboardingSim, Error, TEXT("  %s.AllocationsPerFrame = %.3f, allowed %.3f REGRESSED"), *Result.Name, Result.AllocationsPerFrame, BaselineMetrics->MaxAllocationsPerFrame);
+			}
+			else
+			{
+				UE_LOG(LogSkateboardingSim, Display, TEXT("  %s.AllocationsPerFrame = %.3f"), *Result.Name, Result.AllocationsPerFrame);
+			}
+		}
+
+		return NumRegressions;
+	}
+}
+
+const FSkatingPerfScenarioMetrics* FSkatingPerfBaseline::FindScenario(const FString& Name) const
+{
+	return Scenarios.FindByPredicate([&Name](const FSkatingPerfScenarioMetrics& Scenario) { return Scenario.Name == Name; });
+}
+
+bool FSkatingPerfBaseline::LoadFromFile(const FString& Filename)
+{
+	FString Json;
+	return FFileHelper::LoadFileToString(Json, *Filename)
+		&& FJsonObjectConverter::JsonObjectStringToUStruct(Json, this);
+}
+
+bool FSkatingPerfBaseline::SaveToFile(const FString& Filename) const
+{
+	FString Json;
+	return FJsonObjectConverter::UStructToJsonObjectString(*this, Json)
+		&& FFileHelper::SaveStringToFile(Json, *Filename);
+}
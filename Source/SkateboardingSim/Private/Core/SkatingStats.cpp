@@ -0,0 +1,30 @@
+// Copyright Amr Hamed
+
+
+#include "Core/SkatingStats.h"
+
+DEFINE_STAT(STAT_Skating_MoveAlongFloor);
+DEFINE_STAT(STAT_Skating_AdaptToFloorSlope);
+DEFINE_STAT(STAT_Skating_Steer);
+DEFINE_STAT(STAT_Skating_FindGrindable);
+DEFINE_STAT(STAT_Skating_PhysGrinding);
+DEFINE_STAT(STAT_Skating_MoveCharacterAlongSpline);
+DEFINE_STAT(STAT_Skating_ShouldBail);
+DEFINE_STAT(STAT_Skating_CrowdStep);
+DEFINE_STAT(STAT_Skating_CrowdFloorTraces);
+DEFINE_STAT(STAT_Skating_CrowdUpdateInstances);
+DEFINE_STAT(STAT_Skating_SignificanceUpdate);
+DEFINE_STAT(STAT_Skating_EventDispatch);
+DEFINE_STAT(STAT_Skating_InstantReplayRecord);
+
+DEFINE_STAT(STAT_Skating_PhysicsQueries);
+DEFINE_STAT(STAT_Skating_GrindableQueries);
+DEFINE_STAT(STAT_Skating_GrindSnaps);
+DEFINE_STAT(STAT_Skating_Bails);
+DEFINE_STAT(STAT_Skating_TrickStarts);
+DEFINE_STAT(STAT_Skating_CrowdSkaters);
+DEFINE_STAT(STAT_Skating_MoveBits);
+DEFINE_STAT(STAT_Skating_MoveResponseBits);
+DEFINE_STAT(STAT_Skating_EventsDispatched);
+
+UE_TRACE_CHANNEL_DEFINE(SkatingChannel);
@@ -0,0 +1,122 @@
+// Copyright Amr Hamed
+
+
+#include "Debug/SkatingDebugDrawSubsystem.h"
+#include "DrawDebugHelpers.h"
+
+#if ENABLE_DRAW_DEBUG
+namespace SkatingDebugDraw
+{
+	static TAutoConsoleVariable<bool> CVarDebugSteer(TEXT("skate.Debug.Steer"), false, TEXT("Draws steering directions."));
+	static TAutoConsoleVariable<bool> CVarDebugGrind(TEXT("skate.Debug.Grind"), false, TEXT("Draws grindable queries and their results."));
+	static TAutoConsoleVariable<bool> CVarDebugSlope(TEXT("skate.Debug.Slope"), false, TEXT("Draws floor normals used for slope adaptation."));
+	static TAutoConsoleVariable<bool> CVarDebugBail(TEXT("skate.Debug.Bail"), false, TEXT("Draws skateboard axes checked when landing."));
+	static TAutoConsoleVariable<bool> CVarDebugScore(TEXT("skate.Debug.Score"), false, TEXT("Prints accumulated and total score on screen."));
+}
+#endif
+
+bool USkatingDebugDrawSubsystem::IsCategoryEnabled(const ESkatingDebugCategory Category)
+{
+#if ENABLE_DRAW_DEBUG
+	switch (Category)
+	{
+	case ESkatingDebugCategory::Steer:	return SkatingDebugDraw::CVarDebugSteer.GetValueOnGameThread();
+	case ESkatingDebugCategory::Grind:	return SkatingDebugDraw::CVarDebugGrind.GetValueOnGameThread();
+	case ESkatingDebugCategory::Slope:	return SkatingDebugDraw::CVarDebugSlope.GetValueOnGameThread();
+	case ESkatingDebugCategory::Bail:	return SkatingDebugDraw::CVarDebugBail.GetValueOnGameThread();
+	case ESkatingDebugCategory::Score:	return SkatingDebugDraw::CVarDebugScore.GetValueOnGameThread();
+	default:							break;
+	}
+#endif
+
+	return false;
+}
+
+void USkatingDebugDrawSubsystem::DrawLine(const UWorld* World, const ESkatingDebugCategory Category, const FVector& Start, const FVector& End, const FColor& Color, const float Lifetime)
+{
+	if (!IsCategoryEnabled(Category))
+	{
+		return;
+	}
+
+	if (USkatingDebugDrawSubsystem* DebugDrawSubsystem = UWorld::GetSubsystem<USkatingDebugDrawSubsystem>(World))
+	{
+		DebugDrawSubsystem->AddPrimitive({ Start, End, Color, Lifetime, false });
+	}
+}
+
+void USkatingDebugDrawSubsystem::DrawPoint(const UWorld* World, const ESkatingDebugCategory Category, const FVector& Location, const FColor& Color, const float Lifetime)
+{
+	if (!IsCategoryEnabled(Category))
+	{
+		return;
+	}
+
+	if (USkatingDebugDrawSubsystem* DebugDrawSubsystem = UWorld::GetSubsystem<USkatingDebugDrawSubsystem>(World))
+	{
+		DebugDrawSubsystem->AddPrimitive({ Location, Location, Color, Lifetime, true });
+	}
+}
+
+bool USkatingDebugDrawSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if ENABLE_DRAW_DEBUG
+	return Super::ShouldCreateSubsystem(Outer);
+#else
+	return false;
+#endif
+}
+
+void USkatingDebugDrawSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Primitives.SetNum(Capacity);
+}
+
+void USkatingDebugDrawSubsystem::AddPrimitive(const FSkatingDebugPrimitive& Primitive)
+{
+	Primitives[NextPrimitive] = Primitive;
+	NextPrimitive = (NextPrimitive + 1) % Capacity;
+	NumPrimitives = FMath::Min(NumPrimitives + 1, Capacity);
+}
+
+void USkatingDebugDrawSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+#if ENABLE_DRAW_DEBUG
+	const UWorld* World = GetWorld();
+
+	int32 NumAlivePrimitives = 0;
+	for (int32 Index = 0; Index < NumPrimitives; ++Index)
+	{
+		// Walk from newest to oldest so NumPrimitives can shrink past expired ones
+		const int32 PrimitiveIndex = (NextPrimitive - 1 - Index + Capacity) % Capacity;
+		FSkatingDebugPrimitive& Primitive = Primitives[PrimitiveIndex];
+		if (Primitive.RemainingSeconds < 0.f)
+		{
+			continue;
+		}
+
+		if (Primitive.bIsPoint)
+		{
+			DrawDebugPoint(World, Primitive.Start, 8.f, Primitive.Color);
+		}
+		else
+		{
+			DrawDebugLine(World, Primitive.Start, Primitive.End, Primitive.Color);
+		}
+
+		Primitive.RemainingSeconds -= DeltaTime;
+		NumAlivePrimitives = Index + 1;
+	}
+
+	NumPrimitives = NumAlivePrimitives;
+#endif
+}
+
+TStatId USkatingDebugDrawSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USkatingDebugDrawSubsystem, STATGROUP_Tickables);
+}
@@ -2,81 +2,146 @@
 
 
 #include "Gameplay/ScoreComponent.h"
+#include "Core/SkatingMemory.h"
+#include "Debug/SkatingDebugDrawSubsystem.h"
+#include "Engine/Engine.h"
+#include "Gameplay/SkatingEventSubsystem.h"
 #include "Movement/SkatingTricksComponent.h"
 
 UScoreComponent::UScoreComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 void UScoreComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	USkatingTricksComponent* SkatingTricksComponent = GetOwner()->FindComponentByClass<USkatingTricksComponent>();
+	SkatingTricksComponent = GetOwner()->FindComponentByClass<USkatingTricksComponent>();
 	if (ensureMsgf(SkatingTricksComponent,
 		TEXT("Owner doesn't have a valid Skating Tricks Component: %s"),
 		*GetOwner()->GetName()))
 	{
-		SkatingTricksComponent->OnSkatingTrickStarted.AddDynamic(this, &UScoreComponent::StartAccumulatingScoreForTrick);
-		SkatingTricksComponent->OnSkatingTrickEnded.AddDynamic(this, &UScoreComponent::AddTrickAccumulatedScore);
+		TrickRegistry = SkatingTricksComponent->GetTrickRegistry();
 	}
+
+	EventSubsystem = GetWorld()->GetSubsystem<USkatingEventSubsystem>();
+	if (EventSubsystem)
+	{
+		TrickStartedHandle = EventSubsystem->OnEvent<FSkatingTrickStartedEvent>(GetOwner()).AddUObject(this, &UScoreComponent::OnTrickStarted);
+		TrickEndedHandle = EventSubsystem->OnEvent<FSkatingTrickEndedEvent>(GetOwner()).AddUObject(this, &UScoreComponent::OnTrickEnded);
+	}
+	else if (SkatingTricksComponent)
+	{
+		SkatingTricksComponent->OnSkatingTrickStarted.AddDynamic(this, &UScoreComponent::OnSkatingTrickStarted);
+		SkatingTricksComponent->OnSkatingTrickEnded.AddDynamic(this, &UScoreComponent::OnSkatingTrickEnded);
+	}
+}
+
+void UScoreComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (EventSubsystem)
+	{
+		EventSubsystem->RemoveListener<FSkatingTrickStartedEvent>(GetOwner(), TrickStartedHandle);
+		EventSubsystem->RemoveListener<FSkatingTrickEndedEvent>(GetOwner(), TrickEndedHandle);
+	}
+	else if (SkatingTricksComponent)
+	{
+		SkatingTricksComponent->OnSkatingTrickStarted.RemoveDynamic(this, &UScoreComponent::OnSkatingTrickStarted);
+		SkatingTricksComponent->OnSkatingTrickEnded.RemoveDynamic(this, &UScoreComponent::OnSkatingTrickEnded);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UScoreComponent::OnTrickStarted(const FSkatingTrickStartedEvent& Event)
+{
+	StartAccumulatingScoreForTrick(Event.Trick);
+}
+
+void UScoreComponent::OnTrickEnded(const FSkatingTrickEndedEvent& Event)
+{
+	AddTrickAccumulatedScore(Event.Trick, Event.bWasSuccessful);
+}
+
+void UScoreComponent::OnSkatingTrickStarted(const FSkatingTrickHandle SkatingTrick)
+{
+	StartAccumulatingScoreForTrick(SkatingTrick);
+}
+
+void UScoreComponent::OnSkatingTrickEnded(const FSkatingTrickHandle SkatingTrick, bool bWasSuccessful)
+{
+	AddTrickAccumulatedScore(SkatingTrick, bWasSuccessful);
 }
 
 void UScoreComponent::DebugScore(FLinearColor TextColor)
 {
-	const FString DebugMessage = FString::Printf(TEXT("AccumulatedScore: %f, TotalScore: %f"), AccumulatedScore, TotalScore);
+	// Formatting allocates, only pay for it when asked to
+	if (!GEngine || !USkatingDebugDrawSubsystem::IsCategoryEnabled(ESkatingDebugCategory::Score))
+	{
+		return;
+	}
+
+	const FString DebugMessage = FString::Printf(TEXT("AccumulatedScore: %f, TotalScore: %f"), GetAccumulatedScore(), TotalScore);
 	GEngine->AddOnScreenDebugMessage(1, 2.f, TextColor.ToFColor(false), DebugMessage);
 }
 
-void UScoreComponent::StartAccumulatingScoreForTrick(const FSkatingTrick SkatingMove)
+void UScoreComponent::StartAccumulatingScoreForTrick(FSkatingTrickHandle SkatingTrick)
 {
-	ActiveSkatingTrick = SkatingMove;
-	AccumulatedScore = ActiveSkatingTrick->BaseScore;
+	SKATING_MEMORY_SCOPE();
+
+	ActiveSkatingTrick = SkatingTrick;
+	ActiveTrickStartTime = GetWorld()->GetTimeSeconds();
 
-	SetComponentTickEnabled(ActiveSkatingTrick->ScorePerFrame != 0.f);
+#if !UE_BUILD_SHIPPING
+	DebugScore(FColor::Yellow);
+#endif
 }
 
-void UScoreComponent::AddTrickAccumulatedScore(const FSkatingTrick SkatingTrick, bool bWasTrickSuccessful)
+float UScoreComponent::GetAccumulatedScore() const
 {
+	const FSkatingTrick* Trick = TrickRegistry ? TrickRegistry->GetTrick(ActiveSkatingTrick) : nullptr;
+	if (!Trick)
+	{
+		return 0.f;
+	}
+
+	const double ActiveTrickDuration = GetWorld()->GetTimeSeconds() - ActiveTrickStartTime;
+	return Trick->BaseScore + Trick->ScorePerSecond * static_cast<float>(ActiveTrickDuration);
+}
+
+void UScoreComponent::AddTrickAccumulatedScore(FSkatingTrickHandle SkatingTrick, bool bWasTrickSuccessful)
+{
+	SKATING_MEMORY_SCOPE();
+
+	float AccumulatedScore = GetAccumulatedScore();
 	if (!bWasTrickSuccessful) 
 	{
 		AccumulatedScore *= -1.f;
 	}
 
-	AddScore(AccumulatedScore);
-
-	AccumulatedScore = 0.f;
-	SetComponentTickEnabled(false);
 	ActiveSkatingTrick.Reset();
+
+	AddScore(AccumulatedScore);
 }
 
 void UScoreComponent::AddScore(const float Score)
 {
+	SKATING_MEMORY_SCOPE();
+
 	TotalScore = FMath::Max(0, TotalScore + Score);
 	
-	OnScoreAdded.Broadcast(Score, TotalScore);
-
-#if !UE_BUILD_SHIPPING
-	DebugScore(Score >= 0.f ? FColor::Green : FColor::Red);
-#endif
-}
-
-void UScoreComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	if (!ensure(ActiveSkatingTrick.IsSet())) 
+	if (EventSubsystem)
 	{
-		SetComponentTickEnabled(false);
-		return;
+		EventSubsystem->Post(FSkatingScoreAddedEvent{ GetOwner(), Score, TotalScore });
 	}
 
-	AccumulatedScore += ActiveSkatingTrick->ScorePerFrame;
+	if (OnScoreAdded.IsBound())
+	{
+		OnScoreAdded.Broadcast(Score, TotalScore);
+	}
 
 #if !UE_BUILD_SHIPPING
-	DebugScore(FColor::Yellow);
+	DebugScore(Score >= 0.f ? FColor::Green : FColor::Red);
 #endif
 }
-
@@ -0,0 +1,139 @@
+// Copyright Amr Hamed
+
+
+#include "Gameplay/SkaterCrowd.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Core/SkatingMemory.h"
+#include "Core/SkatingStats.h"
+#include "Engine/World.h"
+
+ASkaterCrowd::ASkaterCrowd()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	SkaterInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("SkaterInstances"));
+	SkaterInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SkaterInstances->SetCanEverAffectNavigation(false);
+	SkaterInstances->SetMobility(EComponentMobility::Movable);
+	RootComponent = SkaterInstances;
+}
+
+void ASkaterCrowd::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SpawnSkaters(InitialNumSkaters);
+}
+
+void ASkaterCrowd::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FloorTraces.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASkaterCrowd::SpawnSkaters(const int32 NumSkaters)
+{
+	CrowdState.Reset(NumSkaters, RandomSeed);
+
+	const FVector Center = GetActorLocation();
+	for (int32 SkaterIndex = 0; SkaterIndex < NumSkaters; ++SkaterIndex)
+	{
+		const float Angle = CrowdState.RandomStream.FRandRange(0.f, UE_TWO_PI);
+		const float Distance = SpawnRadius * FMath::Sqrt(CrowdState.RandomStream.FRand());
+		const FVector Offset = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance;
+
+		CrowdState.AddSkater(Center + Offset, CrowdState.RandomStream.FRandRange(-180.f, 180.f));
+	}
+
+	// Results of traces issued for previous skaters don't apply anymore
+	FloorTraces.Init(FTraceHandle(), NumSkaters);
+
+	InstanceTransforms.SetNum(NumSkaters);
+	SkaterInstances->ClearInstances();
+	for (int32 SkaterIndex = 0; SkaterIndex < NumSkaters; ++SkaterIndex)
+	{
+		InstanceTransforms[SkaterIndex] = FTransform(CrowdState.GetRotation(SkaterIndex), CrowdState.Positions[SkaterIndex]);
+	}
+	SkaterInstances->AddInstances(InstanceTransforms, false, true);
+}
+
+void ASkaterCrowd::Tick(float DeltaSeconds)
+{
+	SKATING_MEMORY_SCOPE();
+
+	Super::Tick(DeltaSeconds);
+
+	if (!CrowdState.Num())
+	{
+		return;
+	}
+
+	INC_DWORD_STAT_BY(STAT_Skating_CrowdSkaters, CrowdState.Num());
+
+	ConsumeFloorTraces();
+
+	{
+		SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_CrowdStep);
+		CrowdState.Step(CrowdSettings, DeltaSeconds);
+	}
+
+	RequestFloorTraces();
+	UpdateInstances();
+}
+
+void ASkaterCrowd::ConsumeFloorTraces()
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_CrowdFloorTraces);
+
+	UWorld* World = GetWorld();
+	FTraceDatum TraceDatum;
+
+	for (int32 SkaterIndex = 0; SkaterIndex < FloorTraces.Num(); ++SkaterIndex)
+	{
+		if (!FloorTraces[SkaterIndex].IsValid() || !World->QueryTraceData(FloorTraces[SkaterIndex], TraceDatum))
+		{
+			continue;
+		}
+
+		const FHitResult* FloorHit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+
+		CrowdState.HasFloor[SkaterIndex] = FloorHit != nullptr;
+		if (FloorHit)
+		{
+			CrowdState.FloorHeights[SkaterIndex] = FloorHit->ImpactPoint.Z;
+			CrowdState.FloorNormals[SkaterIndex] = FloorHit->ImpactNormal;
+		}
+	}
+}
+
+void ASkaterCrowd::RequestFloorTraces()
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_CrowdFloorTraces);
+
+	UWorld* World = GetWorld();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkaterCrowdFloor), false, this);
+
+	for (int32 SkaterIndex = 0; SkaterIndex < CrowdState.Num(); ++SkaterIndex)
+	{
+		const FVector& Location = CrowdState.Positions[SkaterIndex];
+
+		FloorTraces[SkaterIndex] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+			Location + FVector(0.f, 0.f, FloorTraceHeight),
+			Location - FVector(0.f, 0.f, FloorTraceDepth),
+			FloorTraceChannel, QueryParams);
+	}
+}
+
+void ASkaterCrowd::UpdateInstances()
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_CrowdUpdateInstances);
+
+	for (int32 SkaterIndex = 0; SkaterIndex < CrowdState.Num(); ++SkaterIndex)
+	{
+		InstanceTransforms[SkaterIndex].SetComponents(CrowdState.GetRotation(SkaterIndex).Quaternion(), CrowdState.Positions[SkaterIndex], FVector::OneVector);
+	}
+
+	SkaterInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+}
@@ -0,0 +1,289 @@
+// Copyright Amr Hamed
+
+
+#include "Gameplay/SkaterGhostComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Core/ISkaterCharacter.h"
+#include "GameFramework/Character.h"
+#include "Movement/SkatingTricksComponent.h"
+#include "SkateboardingSim.h"
+
+USkaterGhostComponent::USkaterGhostComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void USkaterGhostComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AActor* Owner = GetOwner();
+	if (const ISkaterCharacterInterface* SkaterCharacter = Cast<ISkaterCharacterInterface>(Owner))
+	{
+		SkaterMesh = CastChecked<ACharacter>(Owner)->GetMesh();
+		SkateboardMesh = SkaterCharacter->GetSkateboard();
+		TricksComponent = Owner->FindComponentByClass<USkatingTricksComponent>();
+	}
+	else
+	{
+		// Ghost boards may be poseable meshes that get the recorded root rotation instead of animating it
+		TInlineComponentArray<USkinnedMeshComponent*> SkinnedMeshes(Owner);
+		for (USkinnedMeshComponent* SkinnedMesh : SkinnedMeshes)
+		{
+			if (SkinnedMesh->ComponentHasTag(SkateboardComponentTag))
+			{
+				if (!SkateboardMesh)
+				{
+					SkateboardMesh = SkinnedMesh;
+				}
+			}
+			else if (!SkaterMesh)
+			{
+				SkaterMesh = Cast<USkeletalMeshComponent>(SkinnedMesh);
+			}
+		}
+	}
+
+	if (TrickRegistry)
+	{
+		TrickRegistry->RequestMontagesAsyncLoad();
+	}
+
+	// Allocated once, playback only ever decodes into it
+	DecodedSamples.SetNum(SkaterGhostRun::SamplesPerBlock + 1);
+}
+
+void USkaterGhostComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Writer.Reset();
+	Reader.Close();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void USkaterGhostComponent::StartRecording()
+{
+	if (!ensureMsgf(Cast<ISkaterCharacterInterface>(GetOwner()), TEXT("Ghost runs can only be recorded from skater characters: %s"), *GetOwner()->GetName())
+		|| !ensure(Mode == ESkaterGhostMode::Idle))
+	{
+		return;
+	}
+
+	const USkatingTrickRegistry* RecordedTrickRegistry = TricksComponent ? TricksComponent->GetTrickRegistry() : nullptr;
+	Writer = MakeUnique<FSkaterGhostRunWriter>(SampleInterval, RecordedTrickRegistry ? RecordedTrickRegistry->GetVersion() : 0);
+	TimeSinceLastSample = 0.f;
+	RecordedTrick.Reset();
+	RecordedTrickId = 0;
+	RecordSample();
+
+	// Sample once movement and animation are done for the frame
+	SetTickGroup(TG_PostPhysics);
+
+	Mode = ESkaterGhostMode::Recording;
+	SetComponentTickEnabled(true);
+}
+
+bool USkaterGhostComponent::StopRecording(const FString& Filename)
+{
+	if (Mode != ESkaterGhostMode::Recording)
+	{
+		return false;
+	}
+
+	Mode = ESkaterGhostMode::Idle;
+	SetComponentTickEnabled(false);
+
+	UE_LOG(LogSkateboardingSim, Log, TEXT("Saving %d ghost samples to '%s'"), Writer->GetNumSamples(), *Filename);
+	const bool bSaved = Writer->SaveToFile(Filename);
+	Writer.Reset();
+
+	return bSaved;
+}
+
+bool USkaterGhostComponent::StartPlayback(const FString& Filename)
+{
+	if (!ensure(Mode == ESkaterGhostMode::Idle) || !Reader.Open(Filename) || !Reader.GetNumSamples())
+	{
+		return false;
+	}
+
+	if (TrickRegistry && Reader.GetTrickRegistryVersion() != TrickRegistry->GetVersion())
+	{
+		UE_LOG(LogSkateboardingSim, Log, TEXT("%s: Ghost run '%s' was recorded with other tricks than %s, tricks it no longer has aren't played"),
+			*GetOwner()->GetName(), *Filename, *TrickRegistry->GetName());
+	}
+
+	PlaybackTime = 0.f;
+	DecodedBlock = INDEX_NONE;
+	PlayedTrickId = 0;
+
+	SetTickGroup(TG_PrePhysics);
+
+	Mode = ESkaterGhostMode::Playing;
+	SetComponentTickEnabled(true);
+
+	ApplyPlaybackTime();
+	return true;
+}
+
+void USkaterGhostComponent::StopPlayback()
+{
+	if (Mode != ESkaterGhostMode::Playing)
+	{
+		return;
+	}
+
+	Mode = ESkaterGhostMode::Idle;
+	SetComponentTickEnabled(false);
+
+	Reader.Close();
+	DecodedBlock = INDEX_NONE;
+}
+
+void USkaterGhostComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Mode == ESkaterGhostMode::Recording)
+	{
+		// Frames slower than the sample rate repeat the pose so samples stay evenly spaced
+		TimeSinceLastSample += DeltaTime;
+		while (TimeSinceLastSample >= SampleInterval)
+		{
+			TimeSinceLastSample -= SampleInterval;
+			RecordSample();
+		}
+	}
+	else if (Mode == ESkaterGhostMode::Playing)
+	{
+		PlaybackTime += DeltaTime;
+
+		const float Duration = Reader.GetDuration();
+		if (PlaybackTime > Duration)
+		{
+			if (!bLoopPlayback || Duration <= 0.f)
+			{
+				PlaybackTime = Duration;
+				ApplyPlaybackTime();
+				StopPlayback();
+				return;
+			}
+
+			PlaybackTime = FMath::Fmod(PlaybackTime, Duration);
+		}
+
+		ApplyPlaybackTime();
+	}
+}
+
+void USkaterGhostComponent::RecordSample()
+{
+	const AActor* Owner = GetOwner();
+
+	FSkaterGhostSample Sample;
+	Sample.Location = Owner->GetActorLocation();
+	Sample.Rotation = Owner->GetActorRotation();
+
+	if (SkateboardMesh)
+	{
+		// Component and root bone apart, like instant replays, so playback doesn't apply the root's rotation twice
+		Sample.BoardRotation = SkateboardMesh->GetComponentRotation();
+
+		// The root has no parent, its component space rotation is its local one
+		const TArray<FTransform>& ComponentSpaceTransforms = SkateboardMesh->GetComponentSpaceTransforms();
+		if (ComponentSpaceTransforms.Num())
+		{
+			Sample.BoardRootRotation = ComponentSpaceTransforms[0].Rotator();
+		}
+	}
+
+	if (TricksComponent)
+	{
+		// Ids are looked up once per trick, they're hashed from trick names
+		const FSkatingTrickHandle ActiveTrick = TricksComponent->GetActiveSkatingTrick();
+		if (ActiveTrick != RecordedTrick)
+		{
+			const USkatingTrickRegistry* RecordedTrickRegistry = TricksComponent->GetTrickRegistry();
+			RecordedTrick = ActiveTrick;
+			RecordedTrickId = RecordedTrickRegistry ? USkatingTrickRegistry::GetTrickId(RecordedTrickRegistry->GetTrickName(ActiveTrick)) : 0;
+		}
+
+		Sample.TrickId = RecordedTrickId;
+	}
+
+	Writer->AddSample(Sample);
+}
+
+void USkaterGhostComponent::ApplyPlaybackTime()
+{
+	const float StepSeconds = Reader.GetStepSeconds();
+	const float SampleTime = PlaybackTime / StepSeconds;
+	const int32 SampleIndex = FMath::Clamp(FMath::FloorToInt32(SampleTime), 0, Reader.GetNumSamples() - 1);
+	const float Alpha = FMath::Clamp(SampleTime - SampleIndex, 0.f, 1.f);
+
+	const int32 Block = SampleIndex / SkaterGhostRun::SamplesPerBlock;
+	if (Block != DecodedBlock)
+	{
+		DecodedBlock = Block;
+		NumDecodedSamples = Reader.DecodeBlock(Block, DecodedSamples);
+		if (!NumDecodedSamples)
+		{
+			UE_LOG(LogSkateboardingSim, Warning, TEXT("%s: Ghost run block %d couldn't be decoded"), *GetOwner()->GetName(), Block);
+			StopPlayback();
+			return;
+		}
+	}
+
+	const int32 BlockSampleIndex = SampleIndex - Block * SkaterGhostRun::SamplesPerBlock;
+	const FSkaterGhostSample Sample = FSkaterGhostSample::Blend(DecodedSamples[BlockSampleIndex], DecodedSamples[BlockSampleIndex + 1], Alpha);
+
+	GetOwner()->SetActorLocationAndRotation(Sample.Location, Sample.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	if (SkateboardMesh)
+	{
+		SkateboardMesh->SetWorldRotation(Sample.BoardRotation);
+
+		// Skeletal boards animate their root with the trick's montage instead
+		UPoseableMeshComponent* PoseableBoard = Cast<UPoseableMeshComponent>(SkateboardMesh);
+		if (PoseableBoard && PoseableBoard->BoneSpaceTransforms.Num())
+		{
+			PoseableBoard->BoneSpaceTransforms[0].SetRotation(Sample.BoardRootRotation.Quaternion());
+			PoseableBoard->MarkRefreshTransformDirty();
+		}
+	}
+
+	if (Sample.TrickId != PlayedTrickId)
+	{
+		PlayTrick(Sample.TrickId);
+	}
+}
+
+void USkaterGhostComponent::PlayTrick(const uint32 TrickId)
+{
+	PlayedTrickId = TrickId;
+
+	const FSkatingTrick* Trick = TrickRegistry ? TrickRegistry->GetTrick(TrickRegistry->FindTrickById(TrickId)) : nullptr;
+	if (!Trick)
+	{
+		return;
+	}
+
+	// Montages still streaming are skipped, poseable boards still show the trick through the recorded root rotation
+	UAnimInstance* SkaterAnimInstance = SkaterMesh ? SkaterMesh->GetAnimInstance() : nullptr;
+	UAnimMontage* SkaterMontage = Trick->SkaterMontage.Get();
+	if (SkaterAnimInstance && SkaterMontage)
+	{
+		SkaterAnimInstance->Montage_Play(SkaterMontage, Trick->PlayRate);
+	}
+
+	const USkeletalMeshComponent* SkeletalBoard = Cast<USkeletalMeshComponent>(SkateboardMesh);
+	UAnimInstance* SkateboardAnimInstance = SkeletalBoard ? SkeletalBoard->GetAnimInstance() : nullptr;
+	UAnimMontage* SkateboardMontage = Trick->SkateboardMontage.Get();
+	if (SkateboardAnimInstance && SkateboardMontage)
+	{
+		SkateboardAnimInstance->Montage_Play(SkateboardMontage, Trick->PlayRate);
+	}
+}
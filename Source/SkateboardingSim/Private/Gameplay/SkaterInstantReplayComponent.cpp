@@ -0,0 +1,399 @@
+// Copyright Amr Hamed
+
+
+#include "Gameplay/SkaterInstantReplayComponent.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Core/ISkaterCharacter.h"
+#include "Core/SkatingMemory.h"
+#include "Core/SkatingStats.h"
+#include "Engine/SkinnedAsset.h"
+#include "GameFramework/Character.h"
+#include "Gameplay/SkatingEventSubsystem.h"
+#include "Movement/SkatingTricksComponent.h"
+#include "SkateboardingSim.h"
+
+namespace SkaterInstantReplay
+{
+	static void ResolveTrackedBones(const USkeletalMeshComponent* Mesh, TConstArrayView<FName> BoneNames, TArray<FSkaterReplayBone>& OutBones)
+	{
+		const USkinnedAsset* SkinnedAsset = Mesh ? Mesh->GetSkinnedAsset() : nullptr;
+		if (!SkinnedAsset)
+		{
+			return;
+		}
+
+		const FReferenceSkeleton& RefSkeleton = SkinnedAsset->GetRefSkeleton();
+		auto AddBone = [&OutBones, &RefSkeleton](const int32 BoneIndex)
+			{
+				OutBones.Add({ RefSkeleton.GetBoneName(BoneIndex), BoneIndex, RefSkeleton.GetParentIndex(BoneIndex) });
+			};
+
+		if (BoneNames.IsEmpty())
+		{
+			OutBones.Reserve(RefSkeleton.GetNum());
+			for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetNum(); ++BoneIndex)
+			{
+				AddBone(BoneIndex);
+			}
+			return;
+		}
+
+		OutBones.Reserve(BoneNames.Num());
+		for (const FName BoneName : BoneNames)
+		{
+			const int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName);
+			if (BoneIndex == INDEX_NONE)
+			{
+				UE_LOG(LogSkateboardingSim, Warning, TEXT("%s: Instant replay bone '%s' not found on %s"), *GetNameSafe(Mesh->GetOwner()), *BoneName.ToString(), *SkinnedAsset->GetName());
+				continue;
+			}
+
+			AddBone(BoneIndex);
+		}
+	}
+
+	static void RecordBones(const USkeletalMeshComponent* Mesh, TConstArrayView<FSkaterReplayBone> Bones, FSkatingCompressedRotation* OutRotations)
+	{
+		const TArray<FTransform>& ComponentSpaceTransforms = Mesh->GetComponentSpaceTransforms();
+		for (int32 Index = 0; Index < Bones.Num(); ++Index)
+		{
+			const FSkaterReplayBone& Bone = Bones[Index];
+			if (!ComponentSpaceTransforms.IsValidIndex(Bone.BoneIndex))
+			{
+				continue;
+			}
+
+			const FQuat Rotation = ComponentSpaceTransforms[Bone.BoneIndex].GetRotation();
+			const FQuat LocalRotation = Bone.ParentIndex != INDEX_NONE ? ComponentSpaceTransforms[Bone.ParentIndex].GetRotation().Inverse() * Rotation : Rotation;
+			OutRotations[Index] = FSkatingCompressedRotation::Compress(LocalRotation.Rotator());
+		}
+	}
+
+	static void MapProxyBones(const UPoseableMeshComponent* Proxy, TArrayView<FSkaterReplayBone> Bones)
+	{
+		for (FSkaterReplayBone& Bone : Bones)
+		{
+			Bone.ProxyBoneIndex = Proxy ? Proxy->GetBoneIndex(Bone.Name) : INDEX_NONE;
+		}
+	}
+
+	static void ApplyFrame(USceneComponent* Proxy, const FVector3f& FromLocation, const FSkatingCompressedRotation& FromRotation,
+		const FVector3f& ToLocation, const FSkatingCompressedRotation& ToRotation, const float Alpha)
+	{
+		const FVector Location = FVector(FMath::Lerp(FromLocation, ToLocation, Alpha));
+		const FQuat Rotation = FQuat::Slerp(FromRotation.Decompress().Quaternion(), ToRotation.Decompress().Quaternion(), Alpha);
+		Proxy->SetWorldLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	static void ApplyBones(UPoseableMeshComponent& Proxy, TConstArrayView<FSkaterReplayBone> Bones,
+		const FSkatingCompressedRotation* FromRotations, const FSkatingCompressedRotation* ToRotations, const float Alpha)
+	{
+		for (int32 Index = 0; Index < Bones.Num(); ++Index)
+		{
+			const int32 ProxyBoneIndex = Bones[Index].ProxyBoneIndex;
+			if (Proxy.BoneSpaceTransforms.IsValidIndex(ProxyBoneIndex))
+			{
+				const FQuat Rotation = FQuat::Slerp(FromRotations[Index].Decompress().Quaternion(), ToRotations[Index].Decompress().Quaternion(), Alpha);
+				Proxy.BoneSpaceTransforms[ProxyBoneIndex].SetRotation(Rotation);
+			}
+		}
+
+		Proxy.MarkRefreshTransformDirty();
+	}
+}
+
+USkaterInstantReplayComponent::USkaterInstantReplayComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	// Record once movement, physics and animation are done for the frame
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+void USkaterInstantReplayComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AActor* Owner = GetOwner();
+	const ISkaterCharacterInterface* SkaterCharacter = Cast<ISkaterCharacterInterface>(Owner);
+	if (!ensureMsgf(SkaterCharacter, TEXT("Instant replays can only be recorded from skater characters: %s"), *Owner->GetName()))
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	SkaterMesh = CastChecked<ACharacter>(Owner)->GetMesh();
+	SkateboardMesh = SkaterCharacter->GetSkateboard();
+
+	// Everything recording touches is allocated here, once
+	{
+		LLM_SCOPE_BYTAG(Skating);
+
+		SkaterInstantReplay::ResolveTrackedBones(SkaterMesh, SkaterBones, SkaterTrackedBones);
+		SkaterInstantReplay::ResolveTrackedBones(SkateboardMesh, SkateboardBones, SkateboardTrackedBones);
+		NumTrackedBones = SkaterTrackedBones.Num() + SkateboardTrackedBones.Num();
+
+		const int32 NumFrames = FMath::CeilToInt32(BufferSeconds / SampleInterval) + 1;
+		Frames.SetNum(NumFrames);
+		BoneRotations.SetNum(NumFrames * NumTrackedBones);
+		Events.SetNum(MaxEvents);
+	}
+
+	UE_LOG(LogSkateboardingSim, Verbose, TEXT("%s: Instant replay buffers %d frames of %d bones, %d bytes"), *Owner->GetName(), Frames.Num(), NumTrackedBones,
+		static_cast<int32>(Frames.GetAllocatedSize() + BoneRotations.GetAllocatedSize() + Events.GetAllocatedSize()));
+
+	EventSubsystem = GetWorld()->GetSubsystem<USkatingEventSubsystem>();
+	SkatingTricksComponent = Owner->FindComponentByClass<USkatingTricksComponent>();
+	if (EventSubsystem)
+	{
+		TrickStartedHandle = EventSubsystem->OnEvent<FSkatingTrickStartedEvent>(Owner).AddUObject(this, &USkaterInstantReplayComponent::OnTrickStarted);
+		TrickEndedHandle = EventSubsystem->OnEvent<FSkatingTrickEndedEvent>(Owner).AddUObject(this, &USkaterInstantReplayComponent::OnTrickEnded);
+		BailedHandle = EventSubsystem->OnEvent<FSkatingBailedEvent>(Owner).AddUObject(this, &USkaterInstantReplayComponent::OnBailed);
+	}
+	else if (SkatingTricksComponent)
+	{
+		SkatingTricksComponent->OnSkatingTrickStarted.AddDynamic(this, &USkaterInstantReplayComponent::OnSkatingTrickStarted);
+		SkatingTricksComponent->OnSkatingTrickEnded.AddDynamic(this, &USkaterInstantReplayComponent::OnSkatingTrickEnded);
+	}
+}
+
+void USkaterInstantReplayComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (EventSubsystem)
+	{
+		EventSubsystem->RemoveListener<FSkatingTrickStartedEvent>(GetOwner(), TrickStartedHandle);
+		EventSubsystem->RemoveListener<FSkatingTrickEndedEvent>(GetOwner(), TrickEndedHandle);
+		EventSubsystem->RemoveListener<FSkatingBailedEvent>(GetOwner(), BailedHandle);
+	}
+	else if (SkatingTricksComponent)
+	{
+		SkatingTricksComponent->OnSkatingTrickStarted.RemoveDynamic(this, &USkaterInstantReplayComponent::OnSkatingTrickStarted);
+		SkatingTricksComponent->OnSkatingTrickEnded.RemoveDynamic(this, &USkaterInstantReplayComponent::OnSkatingTrickEnded);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void USkaterInstantReplayComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SKATING_MEMORY_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Mode == ESkaterInstantReplayMode::Recording)
+	{
+		if (!EventSubsystem)
+		{
+			const ISkaterCharacterInterface* SkaterCharacter = Cast<ISkaterCharacterInterface>(GetOwner());
+			const bool bIsBailing = SkaterCharacter && SkaterCharacter->IsBailingOrShouldBail();
+			if (bIsBailing && !bWasBailing)
+			{
+				RecordEvent(ESkaterReplayEventType::Bailed, FSkatingTrickHandle(), false);
+			}
+			bWasBailing = bIsBailing;
+		}
+
+		// Frames slower than the sample rate repeat the pose so frames stay evenly spaced
+		TimeSinceLastSample += DeltaTime;
+		while (TimeSinceLastSample >= SampleInterval)
+		{
+			TimeSinceLastSample -= SampleInterval;
+			RecordFrame();
+		}
+	}
+	else
+	{
+		ReplayTime += DeltaTime;
+
+		const float Duration = GetReplayDuration();
+		if (ReplayTime >= Duration)
+		{
+			ReplayTime = Duration;
+			ApplyReplayTime();
+			StopReplay();
+			OnReplayFinished.Broadcast();
+			return;
+		}
+
+		ApplyReplayTime();
+	}
+}
+
+void USkaterInstantReplayComponent::RecordFrame()
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_InstantReplayRecord);
+
+	const int32 Slot = GetFrameSlot(NumRecordedFrames);
+	FSkaterReplayFrame& Frame = Frames[Slot];
+
+	const AActor* Owner = GetOwner();
+	Frame.ActorLocation = FVector3f(Owner->GetActorLocation());
+	Frame.ActorRotation = FSkatingCompressedRotation::Compress(Owner->GetActorRotation());
+
+	FSkatingCompressedRotation* SlotBoneRotations = BoneRotations.GetData() + Slot * NumTrackedBones;
+	if (SkaterMesh)
+	{
+		Frame.SkaterMeshLocation = FVector3f(SkaterMesh->GetComponentLocation());
+		Frame.SkaterMeshRotation = FSkatingCompressedRotation::Compress(SkaterMesh->GetComponentRotation());
+		SkaterInstantReplay::RecordBones(SkaterMesh, SkaterTrackedBones, SlotBoneRotations);
+	}
+
+	if (SkateboardMesh)
+	{
+		Frame.SkateboardLocation = FVector3f(SkateboardMesh->GetComponentLocation());
+		Frame.SkateboardRotation = FSkatingCompressedRotation::Compress(SkateboardMesh->GetComponentRotation());
+		SkaterInstantReplay::RecordBones(SkateboardMesh, SkateboardTrackedBones, SlotBoneRotations + SkaterTrackedBones.Num());
+	}
+
+	++NumRecordedFrames;
+}
+
+void USkaterInstantReplayComponent::RecordEvent(const ESkaterReplayEventType Type, const FSkatingTrickHandle Trick, const bool bWasSuccessful)
+{
+	if (Mode != ESkaterInstantReplayMode::Recording || Events.IsEmpty())
+	{
+		return;
+	}
+
+	// Events are dispatched after this component ticked, so they belong to the last recorded frame
+	FSkaterReplayEvent& Event = Events[NumRecordedEvents % static_cast<uint32>(Events.Num())];
+	Event.Frame = NumRecordedFrames > RecordingStartFrame ? NumRecordedFrames - 1 : RecordingStartFrame;
+	Event.Type = Type;
+	Event.bWasSuccessful = bWasSuccessful;
+	Event.Trick = Trick;
+
+	++NumRecordedEvents;
+}
+
+uint32 USkaterInstantReplayComponent::GetFirstBufferedFrame() const
+{
+	const uint32 NumFrames = static_cast<uint32>(Frames.Num());
+	return FMath::Max(RecordingStartFrame, NumRecordedFrames > NumFrames ? NumRecordedFrames - NumFrames : 0u);
+}
+
+float USkaterInstantReplayComponent::GetReplayDuration() const
+{
+	return ReplayNumFrames > 1 ? (ReplayNumFrames - 1) * SampleInterval : 0.f;
+}
+
+float USkaterInstantReplayComponent::GetBufferedSeconds() const
+{
+	const uint32 NumBufferedFrames = NumRecordedFrames - GetFirstBufferedFrame();
+	return NumBufferedFrames > 1 ? (NumBufferedFrames - 1) * SampleInterval : 0.f;
+}
+
+bool USkaterInstantReplayComponent::StartReplay(UPoseableMeshComponent* InSkaterProxy, UPoseableMeshComponent* InSkateboardProxy, const float Seconds)
+{
+	const uint32 FirstBufferedFrame = GetFirstBufferedFrame();
+	const uint32 NumBufferedFrames = NumRecordedFrames - FirstBufferedFrame;
+	if (Mode != ESkaterInstantReplayMode::Recording || NumBufferedFrames < 2)
+	{
+		return false;
+	}
+
+	ReplayNumFrames = Seconds > 0.f ? FMath::Clamp(static_cast<uint32>(FMath::CeilToInt32(Seconds / SampleInterval)) + 1, 2u, NumBufferedFrames) : NumBufferedFrames;
+	ReplayFirstFrame = NumRecordedFrames - ReplayNumFrames;
+	ReplayTime = 0.f;
+
+	SkaterProxy = InSkaterProxy;
+	SkateboardProxy = InSkateboardProxy;
+	SkaterInstantReplay::MapProxyBones(SkaterProxy, SkaterTrackedBones);
+	SkaterInstantReplay::MapProxyBones(SkateboardProxy, SkateboardTrackedBones);
+
+	// Skip events overwritten or older than the replayed frames
+	const uint32 NumEvents = static_cast<uint32>(Events.Num());
+	NextReplayEvent = NumRecordedEvents > NumEvents ? NumRecordedEvents - NumEvents : 0u;
+	while (NextReplayEvent < NumRecordedEvents && Events[NextReplayEvent % NumEvents].Frame < ReplayFirstFrame)
+	{
+		++NextReplayEvent;
+	}
+
+	Mode = ESkaterInstantReplayMode::Replaying;
+	ApplyReplayTime();
+
+	return true;
+}
+
+void USkaterInstantReplayComponent::StopReplay()
+{
+	if (Mode != ESkaterInstantReplayMode::Replaying)
+	{
+		return;
+	}
+
+	Mode = ESkaterInstantReplayMode::Recording;
+	TimeSinceLastSample = 0.f;
+
+	// Owner moved on while replaying, interpolating across the gap would make later replays jump
+	RecordingStartFrame = NumRecordedFrames;
+
+	SkaterProxy = nullptr;
+	SkateboardProxy = nullptr;
+}
+
+void USkaterInstantReplayComponent::ApplyReplayTime()
+{
+	const float FrameTime = ReplayTime / SampleInterval;
+	const uint32 FrameOffset = FMath::Min(static_cast<uint32>(FMath::Max(FMath::FloorToInt32(FrameTime), 0)), ReplayNumFrames - 2);
+	const float Alpha = FMath::Clamp(FrameTime - FrameOffset, 0.f, 1.f);
+
+	const uint32 FromFrame = ReplayFirstFrame + FrameOffset;
+	const int32 FromSlot = GetFrameSlot(FromFrame);
+	const int32 ToSlot = GetFrameSlot(FromFrame + 1);
+	const FSkaterReplayFrame& From = Frames[FromSlot];
+	const FSkaterReplayFrame& To = Frames[ToSlot];
+	const FSkatingCompressedRotation* FromBoneRotations = BoneRotations.GetData() + FromSlot * NumTrackedBones;
+	const FSkatingCompressedRotation* ToBoneRotations = BoneRotations.GetData() + ToSlot * NumTrackedBones;
+
+	if (SkaterProxy)
+	{
+		SkaterInstantReplay::ApplyFrame(SkaterProxy, From.SkaterMeshLocation, From.SkaterMeshRotation, To.SkaterMeshLocation, To.SkaterMeshRotation, Alpha);
+		SkaterInstantReplay::ApplyBones(*SkaterProxy, SkaterTrackedBones, FromBoneRotations, ToBoneRotations, Alpha);
+	}
+
+	if (SkateboardProxy)
+	{
+		const int32 NumSkaterBones = SkaterTrackedBones.Num();
+		SkaterInstantReplay::ApplyFrame(SkateboardProxy, From.SkateboardLocation, From.SkateboardRotation, To.SkateboardLocation, To.SkateboardRotation, Alpha);
+		SkaterInstantReplay::ApplyBones(*SkateboardProxy, SkateboardTrackedBones, FromBoneRotations + NumSkaterBones, ToBoneRotations + NumSkaterBones, Alpha);
+	}
+
+	const uint32 NumEvents = static_cast<uint32>(Events.Num());
+	while (NextReplayEvent < NumRecordedEvents)
+	{
+		const FSkaterReplayEvent& Event = Events[NextReplayEvent % NumEvents];
+		if (Event.Frame > FromFrame)
+		{
+			break;
+		}
+
+		++NextReplayEvent;
+		OnReplayEvent.Broadcast(Event.Type, Event.Trick, Event.bWasSuccessful);
+	}
+}
+
+void USkaterInstantReplayComponent::OnTrickStarted(const FSkatingTrickStartedEvent& Event)
+{
+	RecordEvent(ESkaterReplayEventType::TrickStarted, Event.Trick, false);
+}
+
+void USkaterInstantReplayComponent::OnTrickEnded(const FSkatingTrickEndedEvent& Event)
+{
+	RecordEvent(ESkaterReplayEventType::TrickEnded, Event.Trick, Event.bWasSuccessful);
+}
+
+void USkaterInstantReplayComponent::OnBailed(const FSkatingBailedEvent& Event)
+{
+	RecordEvent(ESkaterReplayEventType::Bailed, FSkatingTrickHandle(), false);
+}
+
+void USkaterInstantReplayComponent::OnSkatingTrickStarted(const FSkatingTrickHandle SkatingTrick)
+{
+	RecordEvent(ESkaterReplayEventType::TrickStarted, SkatingTrick, false);
+}
+
+void USkaterInstantReplayComponent::OnSkatingTrickEnded(const FSkatingTrickHandle SkatingTrick, bool bWasSuccessful)
+{
+	RecordEvent(ESkaterReplayEventType::TrickEnded, SkatingTrick, bWasSuccessful);
+}
@@ -0,0 +1,162 @@
+// Copyright Amr Hamed
+
+
+#include "Gameplay/SkaterSignificanceSubsystem.h"
+#include "Core/SkaterCharacter.h"
+#include "Core/SkatingStats.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "SignificanceManager.h"
+
+static TAutoConsoleVariable<bool> CVarSignificanceEnable(
+	TEXT("skate.Significance.Enable"),
+	true,
+	TEXT("Scale skater update rates by their significance to local players, all skaters are fully updated when disabled."));
+
+namespace SkaterSignificance
+{
+	static const FName SkaterTag = TEXT("Skater");
+}
+
+USkaterSignificanceSubsystem::USkaterSignificanceSubsystem()
+{
+	FullTierSettings.MinSignificance = 0.05f;
+
+	ReducedTierSettings.MinSignificance = 0.0125f;
+	ReducedTierSettings.TickInterval = 1.f / 30.f;
+	ReducedTierSettings.bEnableAnimationURO = true;
+	ReducedTierSettings.SlopeAdaptionStepInterval = 2;
+
+	MinimalTierSettings.TickInterval = 1.f / 15.f;
+	MinimalTierSettings.bEnableAnimationURO = true;
+	MinimalTierSettings.bOnlyTickPoseWhenRendered = true;
+	MinimalTierSettings.SlopeAdaptionStepInterval = 4;
+	MinimalTierSettings.FloorQueryInterval = 2;
+	MinimalTierSettings.bUseBakedBail = true;
+}
+
+bool USkaterSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USkaterSignificanceSubsystem::RegisterSkater(ASkaterCharacter* Skater)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (!SignificanceManager || !ensure(Skater))
+	{
+		return;
+	}
+
+	SignificanceManager->RegisterObject(Skater, SkaterSignificance::SkaterTag,
+		[](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+		{
+			return CalculateSignificance(CastChecked<ASkaterCharacter>(ObjectInfo->GetObject()), Viewpoint);
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			ASkaterCharacter* Skater = CastChecked<ASkaterCharacter>(ObjectInfo->GetObject());
+
+			const ESkaterSignificanceTier Tier = GetTierForSignificance(Significance);
+			if (Tier != Skater->GetSignificanceTier())
+			{
+				Skater->ApplySignificanceTier(Tier, GetTierSettings(Tier));
+			}
+		});
+
+	++NumRegisteredSkaters;
+}
+
+void USkaterSignificanceSubsystem::UnregisterSkater(ASkaterCharacter* Skater)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (!SignificanceManager || !Skater)
+	{
+		return;
+	}
+
+	if (SignificanceManager->GetManagedObject(Skater))
+	{
+		SignificanceManager->UnregisterObject(Skater);
+		--NumRegisteredSkaters;
+	}
+}
+
+const FSkaterSignificanceTierSettings& USkaterSignificanceSubsystem::GetTierSettings(const ESkaterSignificanceTier Tier) const
+{
+	switch (Tier)
+	{
+	case ESkaterSignificanceTier::Reduced:
+		return ReducedTierSettings;
+	case ESkaterSignificanceTier::Minimal:
+		return MinimalTierSettings;
+	default:
+		return FullTierSettings;
+	}
+}
+
+ESkaterSignificanceTier USkaterSignificanceSubsystem::GetTierForSignificance(const float Significance) const
+{
+	if (Significance >= FullTierSettings.MinSignificance)
+	{
+		return ESkaterSignificanceTier::Full;
+	}
+
+	if (Significance >= ReducedTierSettings.MinSignificance)
+	{
+		return ESkaterSignificanceTier::Reduced;
+	}
+
+	return ESkaterSignificanceTier::Minimal;
+}
+
+float USkaterSignificanceSubsystem::CalculateSignificance(const ASkaterCharacter* Skater, const FTransform& Viewpoint)
+{
+	if (!CVarSignificanceEnable.GetValueOnGameThread() || Skater->IsLocallyControlled())
+	{
+		return TNumericLimits<float>::Max();
+	}
+
+	// Bounds radius over distance is proportional to screen size regardless of FOV
+	const float BoundsRadius = Skater->GetMesh()->Bounds.SphereRadius;
+	const float Distance = FMath::Max(1.f, FVector::Dist(Viewpoint.GetLocation(), Skater->GetActorLocation()));
+
+	return BoundsRadius / Distance;
+}
+
+void USkaterSignificanceSubsystem::Tick(float DeltaTime)
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_SignificanceUpdate);
+
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (!SignificanceManager)
+	{
+		return;
+	}
+
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			Viewpoints.Emplace(ViewRotation, ViewLocation);
+		}
+	}
+
+	// Without a viewer skaters keep their current tier
+	if (Viewpoints.Num())
+	{
+		SignificanceManager->Update(Viewpoints);
+	}
+}
+
+TStatId USkaterSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USkaterSignificanceSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,27 @@
+// Copyright Amr Hamed
+
+
+#include "Gameplay/SkatingEventSubsystem.h"
+#include "Core/SkatingMemory.h"
+#include "Core/SkatingStats.h"
+
+bool USkatingEventSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USkatingEventSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_EventDispatch);
+	SKATING_MEMORY_SCOPE();
+
+	const int32 NumDispatchedEvents = EventQueue.Dispatch();
+	INC_DWORD_STAT_BY(STAT_Skating_EventsDispatched, NumDispatchedEvents);
+}
+
+TStatId USkatingEventSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USkatingEventSubsystem, STATGROUP_Tickables);
+}
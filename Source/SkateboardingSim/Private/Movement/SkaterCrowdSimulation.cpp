@@ -0,0 +1,212 @@
+// Copyright Amr Hamed
+
+
+#include "Movement/SkaterCrowdSimulation.h"
+#include "Movement/SkatingMovementRules.h"
+
+FSkaterCrowdSettings::FSkaterCrowdSettings()
+{
+	OllyingGroundSpeedRange = FFloatRange(600.f, 900.f);
+	OllyingJumpSpeedRange = FFloatRange(500.f, 750.f);
+	DecisionInterval = FFloatRange(1.f, 3.f);
+}
+
+void FSkaterCrowdState::Reset(const int32 NumSkaters, const int32 Seed)
+{
+	Positions.Reset(NumSkaters);
+	Yaws.Reset(NumSkaters);
+	Pitches.Reset(NumSkaters);
+	Rolls.Reset(NumSkaters);
+	SpeedScales.Reset(NumSkaters);
+	OllyingAlphas.Reset(NumSkaters);
+	VerticalSpeeds.Reset(NumSkaters);
+	Modes.Reset(NumSkaters);
+	SteerInputs.Reset(NumSkaters);
+	DecisionTimers.Reset(NumSkaters);
+	FloorNormals.Reset(NumSkaters);
+	FloorHeights.Reset(NumSkaters);
+	HasFloor.Reset(NumSkaters);
+
+	RandomStream.Initialize(Seed);
+}
+
+void FSkaterCrowdState::AddSkater(const FVector& Location, const float Yaw)
+{
+	Positions.Add(Location);
+	Yaws.Add(Yaw);
+	Pitches.Add(0.f);
+	Rolls.Add(0.f);
+	SpeedScales.Add(0.f);
+	OllyingAlphas.Add(0.f);
+	VerticalSpeeds.Add(0.f);
+	Modes.Add(ESkaterCrowdMode::Rolling);
+	SteerInputs.Add(0.f);
+	// Spread first decisions so skaters don't all push on the same frame
+	DecisionTimers.Add(RandomStream.FRand());
+	FloorNormals.Add(FVector::UpVector);
+	FloorHeights.Add(Location.Z);
+	HasFloor.Add(true);
+}
+
+void FSkaterCrowdState::Step(const FSkaterCrowdSettings& Settings, const float DeltaSeconds)
+{
+	StepDecisions(Settings, DeltaSeconds);
+	StepOllies(Settings, DeltaSeconds);
+	StepGroundMovement(Settings, DeltaSeconds);
+	StepVerticalMovement(Settings, DeltaSeconds);
+}
+
+void FSkaterCrowdState::StepDecisions(const FSkaterCrowdSettings& Settings, const float DeltaSeconds)
+{
+	for (int32 SkaterIndex = 0; SkaterIndex < Num(); ++SkaterIndex)
+	{
+		DecisionTimers[SkaterIndex] -= DeltaSeconds;
+	}
+
+	for (int32 SkaterIndex = 0; SkaterIndex < Num(); ++SkaterIndex)
+	{
+		if (DecisionTimers[SkaterIndex] > 0.f || Modes[SkaterIndex] != ESkaterCrowdMode::Rolling)
+		{
+			continue;
+		}
+
+		DecisionTimers[SkaterIndex] = RandomStream.FRandRange(Settings.DecisionInterval.GetLowerBoundValue(), Settings.DecisionInterval.GetUpperBoundValue());
+		SteerInputs[SkaterIndex] = RandomStream.FRandRange(-1.f, 1.f);
+
+		const float SpeedDelta = SpeedScales[SkaterIndex] < Settings.CruiseSpeedScale ? Settings.SpeedUpDelta : Settings.SlowDownDelta;
+		SpeedScales[SkaterIndex] = SkatingMovementRules::ChangeSpeedScale(SpeedScales[SkaterIndex], SpeedDelta, Settings.MaxSpeedScale);
+
+		if (RandomStream.FRand() < Settings.OllieChance)
+		{
+			Modes[SkaterIndex] = ESkaterCrowdMode::ChargingOllie;
+		}
+	}
+}
+
+void FSkaterCrowdState::StepOllies(const FSkaterCrowdSettings& Settings, const float DeltaSeconds)
+{
+	for (int32 SkaterIndex = 0; SkaterIndex < Num(); ++SkaterIndex)
+	{
+		if (Modes[SkaterIndex] != ESkaterCrowdMode::ChargingOllie)
+		{
+			continue;
+		}
+
+		OllyingAlphas[SkaterIndex] = SkatingMovementRules::ChargeOllyingAlpha(OllyingAlphas[SkaterIndex], Settings.OllyingInterpSpeed, DeltaSeconds);
+
+		if (OllyingAlphas[SkaterIndex] >= 1.f)
+		{
+			Modes[SkaterIndex] = ESkaterCrowdMode::Airborne;
+			VerticalSpeeds[SkaterIndex] = SkatingMovementRules::GetOllyingSpeed(Settings.OllyingJumpSpeedRange, OllyingAlphas[SkaterIndex]);
+		}
+	}
+}
+
+void FSkaterCrowdState::StepGroundMovement(const FSkaterCrowdSettings& Settings, const float DeltaSeconds)
+{
+	const int32 NumSkaters = Num();
+	MoveInputsX.SetNumUninitialized(NumSkaters, EAllowShrinking::No);
+	MoveInputsY.SetNumUninitialized(NumSkaters, EAllowShrinking::No);
+
+	ComputeYawSinCos();
+
+	// Same inputs MoveForward and Steer add to a character, clamped like consumed movement input.
+	// Steer is ComputeSteerDirection for forward input expanded: the right axis of (0, Yaw, Roll) scaled by the steer input,
+	// plus the true Normalize() returns, which adds 1 to every axis. Skaters that don't move end up with no input
+	for (int32 SkaterIndex = 0; SkaterIndex < NumSkaters; ++SkaterIndex)
+	{
+		const float SpeedScale = SpeedScales[SkaterIndex];
+		const float SteerInput = SteerInputs[SkaterIndex];
+		const float SteerScale = SkatingMovementRules::ComputeSteerScale(SpeedScale, SteerInput);
+		const float CosRoll = FMath::Cos(FMath::DegreesToRadians(Rolls[SkaterIndex]));
+
+		const float InputX = YawCosines[SkaterIndex] * SpeedScale + (1.f - CosRoll * YawSines[SkaterIndex] * SteerInput) * SteerScale;
+		const float InputY = YawSines[SkaterIndex] * SpeedScale + (1.f + CosRoll * YawCosines[SkaterIndex] * SteerInput) * SteerScale;
+
+		// GetClampedToMaxSize2D(1) as a scale, inputs within the unit circle keep theirs
+		const float ClampScale = FMath::Min(1.f, FMath::InvSqrt(FMath::Max(InputX * InputX + InputY * InputY, UE_SMALL_NUMBER)));
+		MoveInputsX[SkaterIndex] = InputX * ClampScale;
+		MoveInputsY[SkaterIndex] = InputY * ClampScale;
+	}
+
+	const float MinGroundSpeed = Settings.OllyingGroundSpeedRange.GetLowerBoundValue();
+	const float MaxGroundSpeed = Settings.OllyingGroundSpeedRange.GetUpperBoundValue();
+	for (int32 SkaterIndex = 0; SkaterIndex < NumSkaters; ++SkaterIndex)
+	{
+		const float StepDistance = FMath::Lerp(MinGroundSpeed, MaxGroundSpeed, OllyingAlphas[SkaterIndex]) * DeltaSeconds;
+		Positions[SkaterIndex].X += MoveInputsX[SkaterIndex] * StepDistance;
+		Positions[SkaterIndex].Y += MoveInputsY[SkaterIndex] * StepDistance;
+	}
+
+	// Orient rotation to movement, FMath::FixedTurn with a zero turn for skaters without input instead of skipping them
+	const float MaxTurnDelta = Settings.TurnRate * DeltaSeconds;
+	for (int32 SkaterIndex = 0; SkaterIndex < NumSkaters; ++SkaterIndex)
+	{
+		const float InputX = MoveInputsX[SkaterIndex];
+		const float InputY = MoveInputsY[SkaterIndex];
+		const float TurnDelta = InputX * InputX + InputY * InputY > FMath::Square(UE_KINDA_SMALL_NUMBER) ? MaxTurnDelta : 0.f;
+
+		Yaws[SkaterIndex] = SkatingMovementRules::StepAngleTowards(Yaws[SkaterIndex], FMath::RadiansToDegrees(FMath::Atan2(InputY, InputX)), TurnDelta);
+	}
+
+	ComputeYawSinCos();
+
+	// AdaptRotationToSlope per axis on the turned yaws, airborne skaters and ones without floor adapt by zero
+	const float MaxSlopeDelta = Settings.SlopeAdaptionSpeed > 0.f ? Settings.SlopeAdaptionSpeed * DeltaSeconds : 180.f;
+	for (int32 SkaterIndex = 0; SkaterIndex < NumSkaters; ++SkaterIndex)
+	{
+		float TargetPitch, TargetRoll;
+		SkatingMovementRules::ComputeSlopePitchRoll(YawSines[SkaterIndex], YawCosines[SkaterIndex], FloorNormals[SkaterIndex], TargetPitch, TargetRoll);
+
+		const bool bCanAdapt = (Modes[SkaterIndex] != ESkaterCrowdMode::Airborne) & (HasFloor[SkaterIndex] != 0);
+		const float SlopeDelta = bCanAdapt ? MaxSlopeDelta : 0.f;
+
+		Pitches[SkaterIndex] = SkatingMovementRules::StepAngleTowards(Pitches[SkaterIndex], TargetPitch, SlopeDelta);
+		Rolls[SkaterIndex] = SkatingMovementRules::StepAngleTowards(Rolls[SkaterIndex], TargetRoll, SlopeDelta);
+	}
+}
+
+void FSkaterCrowdState::ComputeYawSinCos()
+{
+	YawSines.SetNumUninitialized(Num(), EAllowShrinking::No);
+	YawCosines.SetNumUninitialized(Num(), EAllowShrinking::No);
+
+	for (int32 SkaterIndex = 0; SkaterIndex < Num(); ++SkaterIndex)
+	{
+		FMath::SinCos(&YawSines[SkaterIndex], &YawCosines[SkaterIndex], FMath::DegreesToRadians(Yaws[SkaterIndex]));
+	}
+}
+
+void FSkaterCrowdState::StepVerticalMovement(const FSkaterCrowdSettings& Settings, const float DeltaSeconds)
+{
+	for (int32 SkaterIndex = 0; SkaterIndex < Num(); ++SkaterIndex)
+	{
+		const bool bIsAirborne = Modes[SkaterIndex] == ESkaterCrowdMode::Airborne;
+		const bool bHasFloor = HasFloor[SkaterIndex] != 0;
+		FVector::FReal& Height = Positions[SkaterIndex].Z;
+
+		if (!bIsAirborne)
+		{
+			if (bHasFloor)
+			{
+				Height = FloorHeights[SkaterIndex];
+				continue;
+			}
+
+			// Rolled off a ledge
+			Modes[SkaterIndex] = ESkaterCrowdMode::Airborne;
+			VerticalSpeeds[SkaterIndex] = 0.f;
+		}
+
+		VerticalSpeeds[SkaterIndex] += Settings.GravityZ * DeltaSeconds;
+		Height += VerticalSpeeds[SkaterIndex] * DeltaSeconds;
+
+		if (bHasFloor && VerticalSpeeds[SkaterIndex] <= 0.f && Height <= FloorHeights[SkaterIndex])
+		{
+			Height = FloorHeights[SkaterIndex];
+			VerticalSpeeds[SkaterIndex] = 0.f;
+			OllyingAlphas[SkaterIndex] = 0.f;
+			Modes[SkaterIndex] = ESkaterCrowdMode::Rolling;
+		}
+	}
+}
@@ -0,0 +1,151 @@
+// Copyright Amr Hamed
+
+
+#include "Movement/SkatingComboTable.h"
+#include "Movement/SkatingTrickRegistry.h"
+#include "SkateboardingSim.h"
+
+void FSkatingComboState::Reset()
+{
+	TableState = 0;
+	NextInput = 0;
+	NumInputs = 0;
+}
+
+void FSkatingComboState::AddInput(const FSkatingComboInput& ComboInput)
+{
+	Inputs[NextInput] = ComboInput;
+	NextInput = (NextInput + 1) % MaxInputs;
+	NumInputs = FMath::Min(NumInputs + 1, MaxInputs);
+}
+
+void FSkatingComboTable::Reset()
+{
+	Transitions.Reset();
+	MatchStarts.Reset();
+	Matches.Reset();
+	NumStates = 0;
+}
+
+void FSkatingComboTable::Compile(TConstArrayView<FSkatingTrick> Tricks)
+{
+	Reset();
+
+	// Build a trie of all input sequences
+	TArray<int32> TrieTransitions;
+	TArray<TArray<int32>> TrieMatches;
+
+	auto AddTrieState = [&TrieTransitions, &TrieMatches]()
+		{
+			TrieTransitions.AddUninitialized(NumInputSymbols);
+			FMemory::Memset(&TrieTransitions[TrieTransitions.Num() - NumInputSymbols], 0xFF, NumInputSymbols * sizeof(int32));
+			TrieMatches.AddDefaulted();
+			return TrieMatches.Num() - 1;
+		};
+
+	AddTrieState();
+
+	for (int32 TrickIndex = 0; TrickIndex < Tricks.Num(); ++TrickIndex)
+	{
+		const TArray<ESkatingTrickInput>& InputSequence = Tricks[TrickIndex].InputSequence;
+		if (InputSequence.IsEmpty())
+		{
+			continue;
+		}
+
+		if (InputSequence.Num() > FSkatingComboState::MaxInputs)
+		{
+			UE_LOG(LogSkateboardingSim, Warning, TEXT("Trick %s has %d inputs, combos are limited to %d inputs"),
+				*Tricks[TrickIndex].Name.ToString(), InputSequence.Num(), FSkatingComboState::MaxInputs);
+			continue;
+		}
+
+		int32 State = 0;
+		for (const ESkatingTrickInput Input : InputSequence)
+		{
+			const int32 TransitionIndex = State * NumInputSymbols + static_cast<int32>(Input);
+			if (TrieTransitions[TransitionIndex] == INDEX_NONE)
+			{
+				const int32 NewState = AddTrieState();
+				TrieTransitions[TransitionIndex] = NewState;
+			}
+
+			State = TrieTransitions[TransitionIndex];
+		}
+
+		TrieMatches[State].Add(TrickIndex);
+	}
+
+	NumStates = TrieMatches.Num();
+	if (!ensureMsgf(NumStates <= MAX_uint16, TEXT("Too many combo states (%d)"), NumStates))
+	{
+		Reset();
+		return;
+	}
+
+	// Turn the trie into a DFA, missing transitions follow failure links (longest suffix that is also a prefix)
+	TArray<int32> FailureStates;
+	FailureStates.SetNumZeroed(NumStates);
+
+	TArray<int32> StateQueue;
+	StateQueue.Reserve(NumStates);
+
+	for (int32 Symbol = 0; Symbol < NumInputSymbols; ++Symbol)
+	{
+		int32& Transition = TrieTransitions[Symbol];
+		if (Transition == INDEX_NONE)
+		{
+			Transition = 0;
+		}
+		else
+		{
+			StateQueue.Add(Transition);
+		}
+	}
+
+	for (int32 QueueIndex = 0; QueueIndex < StateQueue.Num(); ++QueueIndex)
+	{
+		const int32 State = StateQueue[QueueIndex];
+		const int32 FailureState = FailureStates[State];
+
+		// Tricks ending on our suffix end here too
+		TrieMatches[State].Append(TrieMatches[FailureState]);
+
+		for (int32 Symbol = 0; Symbol < NumInputSymbols; ++Symbol)
+		{
+			int32& Transition = TrieTransitions[State * NumInputSymbols + Symbol];
+			const int32 FailureTransition = TrieTransitions[FailureState * NumInputSymbols + Symbol];
+
+			if (Transition == INDEX_NONE)
+			{
+				Transition = FailureTransition;
+			}
+			else
+			{
+				FailureStates[Transition] = FailureTransition;
+				StateQueue.Add(Transition);
+			}
+		}
+	}
+
+	// Flatten
+	Transitions.SetNumUninitialized(TrieTransitions.Num());
+	for (int32 TransitionIndex = 0; TransitionIndex < TrieTransitions.Num(); ++TransitionIndex)
+	{
+		Transitions[TransitionIndex] = static_cast<uint16>(TrieTransitions[TransitionIndex]);
+	}
+
+	MatchStarts.SetNumUninitialized(NumStates + 1);
+	for (int32 State = 0; State < NumStates; ++State)
+	{
+		TArray<int32>& StateMatches = TrieMatches[State];
+		StateMatches.StableSort([Tricks](const int32 A, const int32 B)
+			{
+				return Tricks[A].InputSequence.Num() > Tricks[B].InputSequence.Num();
+			});
+
+		MatchStarts[State] = Matches.Num();
+		Matches.Append(StateMatches);
+	}
+	MatchStarts[NumStates] = Matches.Num();
+}
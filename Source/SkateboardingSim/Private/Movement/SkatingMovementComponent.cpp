@@ -4,7 +4,28 @@
 #include "Movement/SkatingMovementComponent.h"
 #include "GameFramework/Character.h"
 #include "Core/ISkaterCharacter.h"
+#include "Core/SkatingMemory.h"
+#include "Core/SkatingQuantization.h"
+#include "Core/SkatingStats.h"
+#include "Debug/SkatingDebugDrawSubsystem.h"
+#include "Gameplay/SkaterSignificanceSubsystem.h"
+#include "Gameplay/SkatingEventSubsystem.h"
+#include "Movement/SkatingMovementRules.h"
+#include "Obstacles/GrindableSubsystem.h"
 #include "Obstacles/GrindingSplineComponent.h"
+#include "SkateboardingSim.h"
+
+static TAutoConsoleVariable<bool> CVarGrindUseSpatialIndex(
+	TEXT("skate.Grind.UseSpatialIndex"),
+	true,
+	TEXT("Find grindables through the grindable subsystem grid instead of sweeping the physics scene."));
+
+static TAutoConsoleVariable<bool> CVarGrindAsyncQueries(
+	TEXT("skate.Grind.AsyncQueries"),
+	true,
+	TEXT("Sweep for grindables asynchronously, batched across skaters and consumed a frame later. Only used without the spatial index."));
+
+uint32 USkatingMovementComponent::NumPhysicsQueries = 0;
 
 USkatingMovementComponent::USkatingMovementComponent()
 {
@@ -23,6 +44,10 @@ USkatingMovementComponent::USkatingMovementComponent()
 	OllyingJumpSpeedRange.SetLowerBound(JumpZVelocity);
 	OllyingJumpSpeedRange.SetUpperBound(JumpZVelocity * 1.5f);
 
+	SetNetworkMoveDataContainer(SkatingNetworkMoveDataContainer);
+	SetMoveResponseDataContainer(SkatingMoveResponseDataContainer);
+
+	AsyncGrindSweepDelegate.BindUObject(this, &USkatingMovementComponent::OnAsyncGrindSweepCompleted);
 }
 
 void USkatingMovementComponent::OnRegister()
@@ -40,7 +65,215 @@ void USkatingMovementComponent::BeginPlay()
 
 	InitInitialValues();
 
-	CharacterOwner->LandedDelegate.AddDynamic(this, &USkatingMovementComponent::OnLanded);
+	EventSubsystem = GetWorld()->GetSubsystem<USkatingEventSubsystem>();
+}
+
+void USkatingMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SKATING_MEMORY_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (BailPhase == ESkatingBailPhase::BlendingIn || BailPhase == ESkatingBailPhase::BlendingOut)
+	{
+		TickBailBlend(DeltaTime);
+	}
+
+	if (NetBitsInWindow)
+	{
+		NetWindowSeconds += DeltaTime;
+		if (NetWindowSeconds >= 1.f)
+		{
+			NetBitsPerSecond = FMath::RoundToInt32(NetBitsInWindow / NetWindowSeconds);
+			UE_LOG(LogSkateboardingSim, Verbose, TEXT("%s: %d movement bits per second"), *GetNameSafe(CharacterOwner), NetBitsPerSecond);
+
+			NetBitsInWindow = 0;
+			NetWindowSeconds = 0.f;
+		}
+	}
+}
+
+void USkatingMovementComponent::PerformMovement(float DeltaTime)
+{
+	Super::PerformMovement(DeltaTime);
+
+	if (bUseFixedStep)
+	{
+		TickFixedSteps(DeltaTime);
+	}
+}
+
+FNetworkPredictionData_Client* USkatingMovementComponent::GetPredictionData_Client() const
+{
+	if (!ClientPredictionData)
+	{
+		USkatingMovementComponent* MutableThis = const_cast<USkatingMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Skating(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void USkatingMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bIsChargingOllie = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+void USkatingMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	if (const FSkatingNetworkMoveData* MoveData = static_cast<const FSkatingNetworkMoveData*>(GetCurrentNetworkMoveData()))
+	{
+		// Speed scale is driven by client input, only keep it within our own limits
+		SpeedScale = FMath::Min(SkatingQuantization::DequantizeUnitFloat8(MoveData->QuantizedSpeedScale), MaxSpeedScale);
+
+		// Grinding starts from client input, follow it if we agree the grindable can be grinded on
+		if (MoveData->Grindable && !IsGrinding() && CanGrind())
+		{
+			const IGrindable* Grindable = Cast<IGrindable>(MoveData->Grindable);
+			if (Grindable && Grindable->IsGrindable(CharacterOwner))
+			{
+				StartGrinding(MoveData->Grindable);
+			}
+		}
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+bool USkatingMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	if (Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode))
+	{
+		return true;
+	}
+
+	const FSkatingNetworkMoveData* MoveData = static_cast<const FSkatingNetworkMoveData*>(GetCurrentNetworkMoveData());
+	if (!MoveData)
+	{
+		return false;
+	}
+
+	if (FMath::Abs(SkatingQuantization::DequantizeUnitFloat8(MoveData->QuantizedOllyingAlpha) - OllyingAlpha) > OllyingAlphaNetTolerance)
+	{
+		return true;
+	}
+
+	if (MoveData->Grindable != GetCurrentGrindable())
+	{
+		return true;
+	}
+
+	const float ClientGrindingDistance = SkatingQuantization::DequantizeDistance16(MoveData->QuantizedGrindingDistance, SkatingNetworkMoveData::GrindingDistancePrecision);
+	return MoveData->Grindable && FMath::Abs(ClientGrindingDistance - GetGrindingDistance()) > GrindingDistanceNetTolerance;
+}
+
+void USkatingMovementComponent::OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode, FVector ServerGravityDirection)
+{
+	++NumClientCorrections;
+
+	const FSkatingMoveResponseDataContainer& ResponseData = static_cast<const FSkatingMoveResponseDataContainer&>(GetMoveResponseDataContainer());
+
+	SpeedScale = SkatingQuantization::DequantizeUnitFloat8(ResponseData.QuantizedSpeedScale);
+	OllyingAlpha = SkatingQuantization::DequantizeUnitFloat8(ResponseData.QuantizedOllyingAlpha);
+	SyncMovementSpeedWithOllyingAlpha();
+
+	TEnumAsByte<EMovementMode> NetMovementMode;
+	TEnumAsByte<EMovementMode> NetGroundMode;
+	uint8 NetCustomMode;
+	UnpackNetworkMovementMode(ServerMovementMode, NetMovementMode, NetCustomMode, NetGroundMode);
+
+	// Movement mode is applied after this, so start grinding the server's grindable now and let the mode change end it otherwise
+	if (WasGrinding(NetMovementMode, NetCustomMode) && ResponseData.Grindable)
+	{
+		if (GetCurrentGrindable() != ResponseData.Grindable)
+		{
+			if (IsGrinding())
+			{
+				StopGrinding();
+			}
+
+			StartGrinding(ResponseData.Grindable);
+		}
+
+		PendingGrindingDistance = SkatingQuantization::DequantizeDistance16(ResponseData.QuantizedGrindingDistance, SkatingNetworkMoveData::GrindingDistancePrecision);
+	}
+
+	Super::OnClientCorrectionReceived(ClientData, TimeStamp, NewLocation, NewVelocity, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode, ServerGravityDirection);
+}
+
+bool USkatingMovementComponent::ClientUpdatePositionAfterServerUpdate()
+{
+	if (PendingGrindingDistance.IsSet())
+	{
+		if (IGrindable* Grindable = Cast<IGrindable>(GetCurrentGrindable()))
+		{
+			Grindable->SetGrindingDistance(CharacterOwner, *PendingGrindingDistance);
+		}
+
+		PendingGrindingDistance.Reset();
+	}
+
+	return Super::ClientUpdatePositionAfterServerUpdate();
+}
+
+void USkatingMovementComponent::ServerMovePacked_ServerReceive(const FCharacterServerMovePackedBits& PackedBits)
+{
+	INC_DWORD_STAT_BY(STAT_Skating_MoveBits, PackedBits.DataBits.Num());
+	CountNetBits(PackedBits.DataBits.Num());
+
+	Super::ServerMovePacked_ServerReceive(PackedBits);
+}
+
+void USkatingMovementComponent::MoveResponsePacked_ClientReceive(const FCharacterMoveResponsePackedBits& PackedBits)
+{
+	INC_DWORD_STAT_BY(STAT_Skating_MoveResponseBits, PackedBits.DataBits.Num());
+	CountNetBits(PackedBits.DataBits.Num());
+
+	Super::MoveResponsePacked_ClientReceive(PackedBits);
+}
+
+void USkatingMovementComponent::CountNetBits(const int32 NumBits)
+{
+	NetBitsInWindow += NumBits;
+}
+
+void USkatingMovementComponent::TickFixedSteps(const float DeltaSeconds)
+{
+	const float StepSeconds = GetFixedStepSeconds();
+	FixedStepAccumulator += DeltaSeconds;
+
+	int32 NumSteps = 0;
+	while (FixedStepAccumulator >= StepSeconds && NumSteps < MaxFixedStepsPerFrame)
+	{
+		SimulateSkatingStep(StepSeconds);
+		FixedStepAccumulator -= StepSeconds;
+		++NumSteps;
+	}
+
+	// Drop whole steps we had no budget for so a hitch doesn't snowball into the next frames
+	FixedStepAccumulator = FMath::Fmod(FixedStepAccumulator, StepSeconds);
+
+	if (NumSteps)
+	{
+		bIsChargingOllie = false;
+	}
+}
+
+void USkatingMovementComponent::SimulateSkatingStep(const float StepSeconds)
+{
+	if (IsWalking() && ++StepsSinceSlopeAdaption >= SlopeAdaptionStepInterval)
+	{
+		// Catch up on skipped steps so reduced skaters end up at the same rotation
+		AdaptToFloorSlope(StepSeconds * StepsSinceSlopeAdaption);
+		StepsSinceSlopeAdaption = 0;
+	}
+
+	if (bIsChargingOllie)
+	{
+		ChargeOllie(StepSeconds);
+	}
 }
 
 void USkatingMovementComponent::OnLanded(const FHitResult& Hit)
@@ -51,7 +284,6 @@ void USkatingMovementComponent::OnLanded(const FHitResult& Hit)
 	if (ShouldBail()) 
 	{
 		StartBailing();
-		FTimerHandle StopBailingTimerHandle;
 		GetWorld()->GetTimerManager().SetTimer(StopBailingTimerHandle, this, &USkatingMovementComponent::StopBailing, BailingDuration);
 	}
 	else 
@@ -60,6 +292,11 @@ void USkatingMovementComponent::OnLanded(const FHitResult& Hit)
 		ResetMeshRelativeTransform();
 		SpeedUp();
 	}
+
+	if (EventSubsystem)
+	{
+		EventSubsystem->Post(FSkatingLandedEvent{ CharacterOwner, Hit.ImpactPoint, Hit.ImpactNormal });
+	}
 }
 
 void USkatingMovementComponent::InitInitialValues()
@@ -80,13 +317,7 @@ void USkatingMovementComponent::InitInitialValues()
 		{
 			InitialSkateboardRelativeTransform = SkateboardMesh->GetRelativeTransform();
 
-			TArray<FName> BoneNames;
-			SkateboardMesh->GetBoneNames(BoneNames);
-
-			if (BoneNames.Num()) 
-			{
-				SkateboardRootBoneName = BoneNames[0];
-			}
+			SkateboardRootBoneIndex = SkateboardMesh->GetNumBones() ? 0 : INDEX_NONE;
 		}
 	}
 
@@ -105,28 +336,100 @@ void USkatingMovementComponent::ResetMeshRelativeTransform()
 
 void USkatingMovementComponent::MoveAlongFloor(const FVector& InVelocity, float DeltaSeconds, FStepDownResult* OutStepDownResult)
 {
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_MoveAlongFloor);
+
 	Super::MoveAlongFloor(InVelocity, DeltaSeconds, OutStepDownResult);
 
-	AdaptToFloorSlope(DeltaSeconds);
+	if (!bUseFixedStep)
+	{
+		AdaptToFloorSlope(DeltaSeconds);
+	}
+
 	MoveForward();
 }
 
+void USkatingMovementComponent::ApplySignificanceTier(const FSkaterSignificanceTierSettings& TierSettings)
+{
+	SetComponentTickInterval(TierSettings.TickInterval);
+
+	SlopeAdaptionStepInterval = FMath::Max(1, TierSettings.SlopeAdaptionStepInterval);
+	FloorQueryInterval = FMath::Max(1, TierSettings.FloorQueryInterval);
+	bUseBakedBail = TierSettings.bUseBakedBail && BakedBailMontage;
+}
+
+void USkatingMovementComponent::FindFloor(const FVector& CapsuleLocation, FFindFloorResult& OutFloorResult, bool bCanUseCachedLocation, const FHitResult* DownwardSweepResult) const
+{
+	// Only amortize while rolling on a known floor, anything else (landing, teleports) always queries
+	if (FloorQueryInterval > 1 && IsMovingOnGround() && CurrentFloor.IsWalkableFloor() && !bJustTeleported
+		&& ++FloorQueriesSinceTrace < FloorQueryInterval)
+	{
+		// Slide the cached floor plane under the capsule, the gap changes by the move along the plane's normal
+		const FVector CapsuleDelta = CapsuleLocation - CurrentFloor.HitResult.TraceStart;
+		const FVector& FloorNormal = CurrentFloor.HitResult.ImpactNormal;
+		const float FloorDistDelta = FloorNormal.Z > UE_KINDA_SMALL_NUMBER ? (FloorNormal | CapsuleDelta) / FloorNormal.Z : UE_BIG_NUMBER;
+		const float FloorDist = CurrentFloor.FloorDist + FloorDistDelta;
+
+		// Drifting off the floor or into it needs a real query to resolve
+		if (FloorDist >= MIN_FLOOR_DIST && FloorDist <= MAX_FLOOR_DIST)
+		{
+			const FVector FloorDelta = CapsuleDelta - FVector::UpVector * FloorDistDelta;
+
+			OutFloorResult = CurrentFloor;
+			OutFloorResult.FloorDist = FloorDist;
+			OutFloorResult.LineDist = CurrentFloor.bLineTrace ? CurrentFloor.LineDist + FloorDistDelta : CurrentFloor.LineDist;
+			OutFloorResult.HitResult.TraceStart += CapsuleDelta;
+			OutFloorResult.HitResult.TraceEnd += CapsuleDelta;
+			OutFloorResult.HitResult.Location += FloorDelta;
+			OutFloorResult.HitResult.ImpactPoint += FloorDelta;
+			return;
+		}
+	}
+
+	FloorQueriesSinceTrace = 0;
+
+	Super::FindFloor(CapsuleLocation, OutFloorResult, bCanUseCachedLocation, DownwardSweepResult);
+}
+
+void USkatingMovementComponent::ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult) const
+{
+	++NumPhysicsQueries;
+	INC_DWORD_STAT(STAT_Skating_PhysicsQueries);
+
+	Super::ComputeFloorDist(CapsuleLocation, LineDistance, SweepDistance, OutFloorResult, SweepRadius, DownwardSweepResult);
+}
+
 void USkatingMovementComponent::AdaptToFloorSlope(const float DeltaSeconds)
 {
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_AdaptToFloorSlope);
+
 	if (!CurrentFloor.bWalkableFloor) 
 	{
 		return;
 	}
 
+	const FVector& FloorNormal = CurrentFloor.HitResult.ImpactNormal;
 	const FRotator CurrentRotation = CharacterOwner->GetActorRotation();
-	
-	const float TargetYaw = CurrentRotation.Yaw;
-	const float TargetPitch = FRotationMatrix::MakeFromYZ(CharacterOwner->GetActorRightVector(), CurrentFloor.HitResult.ImpactNormal).Rotator().Pitch;
-	const float TargetRoll = FRotationMatrix::MakeFromXZ(CharacterOwner->GetActorForwardVector(), CurrentFloor.HitResult.ImpactNormal).Rotator().Roll;
-	const FRotator TargetRotation = FRotator(TargetPitch, TargetYaw, TargetRoll);
 
-	const FRotator NewRotation = FMath::RInterpConstantTo(CurrentRotation, TargetRotation, DeltaSeconds, SlopeAdaptionSpeed);
-	CharacterOwner->SetActorRotation(NewRotation);
+	SKATING_DEBUG_LINE(GetWorld(), Slope, CurrentFloor.HitResult.ImpactPoint, CurrentFloor.HitResult.ImpactPoint + FloorNormal * 100.f, FColor::Green, 0.f);
+
+	// Same floor and heading as last time means the same target, flat ground always targets no pitch nor roll
+	const bool bIsFlatFloor = FloorNormal.Equals(FVector::UpVector, UE_KINDA_SMALL_NUMBER);
+	if (!FloorNormal.Equals(CachedSlopeFloorNormal, UE_KINDA_SMALL_NUMBER)
+		|| (!bIsFlatFloor && FMath::Abs(FRotator::NormalizeAxis(CurrentRotation.Yaw - CachedSlopeRotation.Yaw)) > SlopeAdaptionTolerance))
+	{
+		CachedSlopeFloorNormal = FloorNormal;
+		CachedSlopeRotation = SkatingMovementRules::ComputeSlopeRotation(CurrentRotation, FloorNormal);
+	}
+
+	// Already aligned, skip propagating a transform update through the capsule and everything attached to it
+	if (FMath::Abs(FRotator::NormalizeAxis(CachedSlopeRotation.Pitch - CurrentRotation.Pitch)) <= SlopeAdaptionTolerance
+		&& FMath::Abs(FRotator::NormalizeAxis(CachedSlopeRotation.Roll - CurrentRotation.Roll)) <= SlopeAdaptionTolerance)
+	{
+		return;
+	}
+
+	const FRotator TargetRotation = FRotator(CachedSlopeRotation.Pitch, CurrentRotation.Yaw, CachedSlopeRotation.Roll);
+	CharacterOwner->SetActorRotation(FMath::RInterpConstantTo(CurrentRotation, TargetRotation, DeltaSeconds, SlopeAdaptionSpeed));
 }
 
 void USkatingMovementComponent::MoveForward()
@@ -159,7 +462,7 @@ void USkatingMovementComponent::SlowDown()
 bool USkatingMovementComponent::ChangeSpeed(const float Delta)
 {
 	const float OldSpeedScale = SpeedScale;
-	SpeedScale = FMath::Clamp(SpeedScale + Delta, 0.f, MaxSpeedScale);
+	SpeedScale = SkatingMovementRules::ChangeSpeedScale(SpeedScale, Delta, MaxSpeedScale);
 	
 	return SpeedScale != OldSpeedScale;
 }
@@ -182,12 +485,14 @@ void USkatingMovementComponent::HandleMoveInput(const float XValue, const float
 
 void USkatingMovementComponent::Steer(const float XValue, const float YValue)
 {
-	const FRotator RotationWithoutPitch = FRotator(0.f, CharacterOwner->GetActorRotation().Yaw, CharacterOwner->GetActorRotation().Roll);
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_Steer);
 
-	const FVector Direction = (FRotationMatrix(RotationWithoutPitch).GetScaledAxis(EAxis::Y) * XValue) + (RotationWithoutPitch.Vector() * (YValue < 0 ? -BackwardSteeringStrength : 1.f)).Normalize();
-	const float ScaleValue = SpeedScale * FMath::Abs(XValue);
+	const FRotator CurrentRotation = CharacterOwner->GetActorRotation();
+
+	const FVector Direction = SkatingMovementRules::ComputeSteerDirection(CurrentRotation.Yaw, CurrentRotation.Roll, XValue, YValue, BackwardSteeringStrength);
+	const float ScaleValue = SkatingMovementRules::ComputeSteerScale(SpeedScale, XValue);
 
-	DrawDebugLine(GetWorld(), CharacterOwner->GetActorLocation(), CharacterOwner->GetActorLocation() + Direction * 200.f, FColor::Cyan, true);
+	SKATING_DEBUG_LINE(GetWorld(), Steer, CharacterOwner->GetActorLocation(), CharacterOwner->GetActorLocation() + Direction * 200.f, FColor::Cyan, 1.f);
 	CharacterOwner->AddMovementInput(Direction, ScaleValue);
 }
 
@@ -203,15 +508,26 @@ void USkatingMovementComponent::Balance(float Value)
 
 void USkatingMovementComponent::IncreaseOllyingAlpha()
 {
-	OllyingAlpha = FMath::Min(1.f, OllyingAlpha + (OllyingInterpSpeed * GetWorld()->GetDeltaSeconds()));
+	if (bUseFixedStep)
+	{
+		bIsChargingOllie = true;
+		return;
+	}
+
+	ChargeOllie(GetWorld()->GetDeltaSeconds());
+}
+
+void USkatingMovementComponent::ChargeOllie(const float DeltaSeconds)
+{
+	OllyingAlpha = SkatingMovementRules::ChargeOllyingAlpha(OllyingAlpha, OllyingInterpSpeed, DeltaSeconds);
 
 	SyncMovementSpeedWithOllyingAlpha();
 }
 
 void USkatingMovementComponent::SyncMovementSpeedWithOllyingAlpha()
 {
-	MaxWalkSpeed = FMath::Lerp(OllyingGroundSpeedRange.GetLowerBoundValue(), OllyingGroundSpeedRange.GetUpperBoundValue(), OllyingAlpha);
-	JumpZVelocity = FMath::Lerp(OllyingJumpSpeedRange.GetLowerBoundValue(), OllyingJumpSpeedRange.GetUpperBoundValue(), OllyingAlpha);
+	MaxWalkSpeed = SkatingMovementRules::GetOllyingSpeed(OllyingGroundSpeedRange, OllyingAlpha);
+	JumpZVelocity = SkatingMovementRules::GetOllyingSpeed(OllyingJumpSpeedRange, OllyingAlpha);
 }
 
 bool USkatingMovementComponent::CanAttemptJump() const
@@ -233,10 +549,9 @@ bool USkatingMovementComponent::TryGrinding()
 {
 	if (CanGrind()) 
 	{
-		FHitResult grindableHitResult;
-		if (TOptional<UObject*> grindableObstacle = TraceGrindableObstacles(grindableHitResult))
+		if (UObject* GrindableObstacle = FindGrindableObstacle())
 		{
-			StartGrinding(*grindableObstacle);
+			StartGrinding(GrindableObstacle);
 			return true;
 		}
 	}
@@ -244,6 +559,43 @@ bool USkatingMovementComponent::TryGrinding()
 	return false;
 }
 
+UObject* USkatingMovementComponent::FindGrindableObstacle()
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_FindGrindable);
+	INC_DWORD_STAT(STAT_Skating_GrindableQueries);
+
+	UObject* GrindableObstacle = nullptr;
+
+	const UGrindableSubsystem* GrindableSubsystem = UWorld::GetSubsystem<UGrindableSubsystem>(GetWorld());
+	if (GrindableSubsystem && CVarGrindUseSpatialIndex.GetValueOnGameThread())
+	{
+		const FVector QueryStart = CharacterOwner->GetActorLocation();
+		const FVector QueryEnd = QueryStart + CharacterOwner->GetActorUpVector() * -GrindingTraceRange;
+		const float QueryRadius = FMath::Max(GrindingTraceExtent.X, GrindingTraceExtent.Y);
+
+		GrindableObstacle = GrindableSubsystem->FindClosestGrindable(QueryStart, QueryEnd, QueryRadius);
+
+		SKATING_DEBUG_LINE(GetWorld(), Grind, QueryStart, QueryEnd, GrindableObstacle ? FColor::Green : FColor::Red, 0.f);
+	}
+	else if (CVarGrindAsyncQueries.GetValueOnGameThread())
+	{
+		// Grind input is held over several frames, so acting on last frame's sweep only delays the first attempt
+		GrindableObstacle = ConsumeAsyncGrindCandidate();
+		QueueAsyncGrindSweep();
+	}
+	else
+	{
+		FHitResult GrindableHitResult;
+		if (TOptional<UObject*> TracedGrindable = TraceGrindableObstacles(GrindableHitResult))
+		{
+			GrindableObstacle = *TracedGrindable;
+		}
+	}
+
+	const IGrindable* Grindable = Cast<IGrindable>(GrindableObstacle);
+	return Grindable && Grindable->IsGrindable(CharacterOwner) ? GrindableObstacle : nullptr;
+}
+
 bool USkatingMovementComponent::CanGrind() const
 {
 	return IsFalling();
@@ -254,6 +606,12 @@ bool USkatingMovementComponent::IsGrinding() const
 	return MovementMode == MOVE_Custom && CustomMovementMode == GrindingMovementMode;
 }
 
+float USkatingMovementComponent::GetGrindingDistance() const
+{
+	const IGrindable* Grindable = Cast<IGrindable>(GetCurrentGrindable());
+	return Grindable ? Grindable->GetGrindingDistance(CharacterOwner) : 0.f;
+}
+
 bool USkatingMovementComponent::WasGrinding(TEnumAsByte<EMovementMode> PrevMovementMode, uint8 PrevCustomMode) const
 {
 	return PrevMovementMode == MOVE_Custom && PrevCustomMode == GrindingMovementMode;
@@ -267,21 +625,88 @@ TOptional<UObject*> USkatingMovementComponent::TraceGrindableObstacles(FHitResul
 		return TOptional<UObject*>();
 	}
 
-	const FVector TraceStart = CharacterOwner->GetActorLocation();
-	const FVector TraceEnd = TraceStart + CharacterOwner->GetActorUpVector() * -GrindingTraceRange;
-	const FQuat TraceOrientation = CharacterOwner->GetActorRotation().Quaternion();
+	FVector TraceStart, TraceEnd;
+	FQuat TraceOrientation;
+	GetGrindSweep(TraceStart, TraceEnd, TraceOrientation);
+
 	const FCollisionShape TraceBox = FCollisionShape::MakeBox(GrindingTraceExtent);
 	const FCollisionObjectQueryParams ObjectQueryParams(GrindingObjectTypes);
 	const FCollisionQueryParams QueryParams("GrindableObstacleTrace", false, CharacterOwner);
 
-	if (World->SweepSingleByObjectType(OutHit, TraceStart, TraceEnd, TraceOrientation, ObjectQueryParams, TraceBox, QueryParams)) 
+	++NumPhysicsQueries;
+	INC_DWORD_STAT(STAT_Skating_PhysicsQueries);
+
+	const bool bHit = World->SweepSingleByObjectType(OutHit, TraceStart, TraceEnd, TraceOrientation, ObjectQueryParams, TraceBox, QueryParams);
+
+	SKATING_DEBUG_LINE(World, Grind, TraceStart, bHit ? OutHit.Location : TraceEnd, bHit ? FColor::Green : FColor::Red, 0.f);
+
+	if (bHit) 
 	{
-		//OutHit.GetActor()->FindComponentByInterface<>()
+		if (UObject* GrindableComponent = GetGrindableFromHit(OutHit))
+		{
+			return TOptional<UObject*>(GrindableComponent);
+		}
 	}
 
 	return TOptional<UObject*>();
 }
 
+void USkatingMovementComponent::QueueAsyncGrindSweep()
+{
+	UWorld* World = GetWorld();
+	if (bIsAsyncGrindSweepPending || !ensure(World))
+	{
+		return;
+	}
+
+	FVector TraceStart, TraceEnd;
+	FQuat TraceOrientation;
+	GetGrindSweep(TraceStart, TraceEnd, TraceOrientation);
+
+	const FCollisionShape TraceBox = FCollisionShape::MakeBox(GrindingTraceExtent);
+	const FCollisionObjectQueryParams ObjectQueryParams(GrindingObjectTypes);
+	const FCollisionQueryParams QueryParams("GrindableObstacleTrace", false, CharacterOwner);
+
+	++NumPhysicsQueries;
+	INC_DWORD_STAT(STAT_Skating_PhysicsQueries);
+
+	World->AsyncSweepByObjectType(EAsyncTraceType::Single, TraceStart, TraceEnd, TraceOrientation, ObjectQueryParams, TraceBox, QueryParams, &AsyncGrindSweepDelegate);
+
+	bIsAsyncGrindSweepPending = true;
+	AsyncGrindSweepFrame = GFrameCounter;
+}
+
+UObject* USkatingMovementComponent::ConsumeAsyncGrindCandidate()
+{
+	UObject* Candidate = AsyncGrindCandidate.Get();
+	AsyncGrindCandidate.Reset();
+
+	return GFrameCounter - AsyncGrindSweepFrame <= static_cast<uint64>(AsyncGrindCandidateMaxAge) ? Candidate : nullptr;
+}
+
+void USkatingMovementComponent::OnAsyncGrindSweepCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceData)
+{
+	bIsAsyncGrindSweepPending = false;
+
+	const FHitResult* Hit = TraceData.OutHits.FindByPredicate([](const FHitResult& OutHit) { return OutHit.bBlockingHit; });
+	AsyncGrindCandidate = Hit ? GetGrindableFromHit(*Hit) : nullptr;
+
+	SKATING_DEBUG_LINE(GetWorld(), Grind, TraceData.Start, Hit ? Hit->Location : TraceData.End, Hit ? FColor::Green : FColor::Red, 0.f);
+}
+
+void USkatingMovementComponent::GetGrindSweep(FVector& OutStart, FVector& OutEnd, FQuat& OutOrientation) const
+{
+	OutStart = CharacterOwner->GetActorLocation();
+	OutEnd = OutStart + CharacterOwner->GetActorUpVector() * -GrindingTraceRange;
+	OutOrientation = CharacterOwner->GetActorQuat();
+}
+
+UObject* USkatingMovementComponent::GetGrindableFromHit(const FHitResult& Hit)
+{
+	const AActor* HitActor = Hit.GetActor();
+	return HitActor ? HitActor->FindComponentByInterface(UGrindable::StaticClass()) : nullptr;
+}
+
 void USkatingMovementComponent::StartGrinding(UObject* Grindable)
 {
 	if (!ensure(Grindable)) 
@@ -290,12 +715,71 @@ void USkatingMovementComponent::StartGrinding(UObject* Grindable)
 	}
 
 	CurrentGrindable = Grindable;
-	if (IGrindable* GrindableObstacle = Cast<IGrindable>(*CurrentGrindable)) 
+	SetMovementMode(MOVE_Custom, GrindingMovementMode);
+
+	if (EventSubsystem)
+	{
+		EventSubsystem->Post(FSkatingGrindStartedEvent{ CharacterOwner, Grindable });
+	}
+
+	// Notify after entering grinding mode so a failed snap can end grinding through the usual mode change
+	if (IGrindable* GrindableObstacle = Cast<IGrindable>(Grindable)) 
 	{
 		GrindableObstacle->OnGrindingStarted(CharacterOwner);
 	}
+}
 
-	SetMovementMode(MOVE_Custom, GrindingMovementMode);
+void USkatingMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == GrindingMovementMode)
+	{
+		PhysGrinding(deltaTime, Iterations);
+		return;
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void USkatingMovementComponent::PhysGrinding(float deltaTime, int32 Iterations)
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_PhysGrinding);
+
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	IGrindable* GrindableObstacle = CurrentGrindable.IsSet() ? Cast<IGrindable>(*CurrentGrindable) : nullptr;
+	if (!GrindableObstacle)
+	{
+		SetMovementMode(MOVE_Falling, 0);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	float RemainingTime = deltaTime;
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < MaxSimulationIterations)
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+		GrindableObstacle->UpdateGrinding(CharacterOwner, TimeTick);
+
+		// Keep grinding velocity so we carry momentum when jumping or falling off the grindable
+		const FVector Delta = UpdatedComponent->GetComponentLocation() - OldLocation;
+		if (!Delta.IsNearlyZero())
+		{
+			Velocity = Delta / TimeTick;
+		}
+
+		if (!IsGrinding())
+		{
+			StartNewPhysics(RemainingTime, Iterations);
+			return;
+		}
+	}
 }
 
 void USkatingMovementComponent::StopGrinding()
@@ -307,6 +791,11 @@ void USkatingMovementComponent::StopGrinding()
 			GrindableObstacle->OnGrindingEnded(CharacterOwner);
 		}
 
+		if (EventSubsystem)
+		{
+			EventSubsystem->Post(FSkatingGrindEndedEvent{ CharacterOwner, CurrentGrindable->Get() });
+		}
+
 		CurrentGrindable.Reset();
 	}
 
@@ -323,38 +812,81 @@ bool USkatingMovementComponent::IsBailing() const
 
 bool USkatingMovementComponent::ShouldBail() const
 {
-	if (!IsFalling()) 
+	return GetLandingSnapshot().bShouldBail;
+}
+
+const FSkatingLandingSnapshot& USkatingMovementComponent::GetLandingSnapshot() const
+{
+	if (LandingSnapshot.Frame == GFrameCounter)
 	{
-		return false;
+		return LandingSnapshot;
 	}
 
-	const FRotator SkateboardRootBoneRotation = SkateboardMesh->GetSocketRotation(SkateboardRootBoneName);
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_ShouldBail);
 
-	const float ForwardDotProduct = SkateboardRootBoneRotation.Vector().Dot(CharacterOwner->GetActorRotation().Vector());
-	if (FMath::Abs(ForwardDotProduct) < BailingDotProductThreshold) 
+	LandingSnapshot.Frame = GFrameCounter;
+	LandingSnapshot.CharacterRotation = CharacterOwner->GetActorQuat();
+	LandingSnapshot.SkateboardRotation = SkateboardRootBoneIndex != INDEX_NONE
+		? SkateboardMesh->GetBoneTransform(SkateboardRootBoneIndex).GetRotation()
+		: SkateboardMesh->GetComponentQuat();
+
+	// Only landings from the air can bail, the verdict sticks for the rest of the frame even once landed
+	if (!IsFalling())
 	{
-		return true;
+		LandingSnapshot.bShouldBail = false;
+		return LandingSnapshot;
 	}
 
-	const float UpDotPorduct = FVector::UpVector.Dot(FRotationMatrix(SkateboardRootBoneRotation).GetScaledAxis(EAxis::Z));
-	return UpDotPorduct < BailingDotProductThreshold;
+	const FVector SkateboardForward = LandingSnapshot.SkateboardRotation.GetForwardVector();
+	const FVector SkateboardUp = LandingSnapshot.SkateboardRotation.GetUpVector();
+
+	SKATING_DEBUG_LINE(GetWorld(), Bail, SkateboardMesh->GetComponentLocation(), SkateboardMesh->GetComponentLocation() + SkateboardForward * 100.f, FColor::Red, 2.f);
+	SKATING_DEBUG_LINE(GetWorld(), Bail, SkateboardMesh->GetComponentLocation(), SkateboardMesh->GetComponentLocation() + SkateboardUp * 100.f, FColor::Blue, 2.f);
+
+	const float ForwardDotProduct = SkateboardForward.Dot(LandingSnapshot.CharacterRotation.GetForwardVector());
+	const float UpDotProduct = FVector::UpVector.Dot(SkateboardUp);
+
+	LandingSnapshot.bShouldBail = FMath::Abs(ForwardDotProduct) < BailingDotProductThreshold || UpDotProduct < BailingDotProductThreshold;
+
+	return LandingSnapshot;
 }
 
 void USkatingMovementComponent::StartBailing()
 {
+	INC_DWORD_STAT(STAT_Skating_Bails);
+
 	StopMovementImmediately();
 	SetMovementMode(MOVE_Custom, BailingMovementMode);
+
+	if (EventSubsystem)
+	{
+		EventSubsystem->Post(FSkatingBailedEvent{ CharacterOwner });
+	}
 	
 	if (APlayerController* PlayerController = Cast<APlayerController>(CharacterOwner->GetController()))
 	{
 		PlayerController->SetIgnoreMoveInput(true);
 	}
 
+	// Bailing again while the last ragdoll blends out continues from its current weight instead of popping back to the animated pose
+	const bool bIsBlendingOut = BailPhase == ESkatingBailPhase::BlendingOut;
+
+	if (bUseBakedBail && !bIsBlendingOut)
+	{
+		// Cheap path for skaters far away, no physics involved at all
+		BailPhase = ESkatingBailPhase::Baked;
+		CharacterOwner->PlayAnimMontage(BakedBailMontage);
+		return;
+	}
+
 	CharacterMesh->SetCollisionProfileName(BailingCollisionProfileName.Name);
 	SkateboardMesh->SetCollisionProfileName(BailingCollisionProfileName.Name);
 	SkateboardMesh->DetachFromComponent(FDetachmentTransformRules(FAttachmentTransformRules(EAttachmentRule::KeepWorld, true), true));
-	CharacterMesh->SetSimulatePhysics(true);
-	SkateboardMesh->SetSimulatePhysics(true);
+
+	SetRagdollSimulation(true);
+	BailBlendWeight = BailBlendInDuration > 0.f ? (bIsBlendingOut ? BailBlendWeight : 0.f) : 1.f;
+	BailPhase = BailBlendWeight < 1.f ? ESkatingBailPhase::BlendingIn : ESkatingBailPhase::Simulating;
+	CharacterMesh->SetAllBodiesPhysicsBlendWeight(BailBlendWeight);
 }
 
 void USkatingMovementComponent::StopBailing()
@@ -366,9 +898,59 @@ void USkatingMovementComponent::StopBailing()
 		PlayerController->ResetIgnoreMoveInput();
 	}
 
-	CharacterMesh->SetSimulatePhysics(false);
+	if (BailPhase == ESkatingBailPhase::Baked)
+	{
+		CharacterOwner->StopAnimMontage(BakedBailMontage);
+		BailPhase = ESkatingBailPhase::None;
+		return;
+	}
+
+	// Skateboard snaps back right away, the character blends its ragdoll out while already skating
 	SkateboardMesh->SetSimulatePhysics(false);
-	CharacterMesh->SetCollisionProfileName(InitialCollisionProfileName);
 	SkateboardMesh->SetCollisionProfileName(InitialCollisionProfileName);
 	ResetMeshRelativeTransform();
+
+	BailPhase = ESkatingBailPhase::BlendingOut;
+	if (BailBlendOutDuration <= 0.f)
+	{
+		TickBailBlend(0.f);
+	}
+}
+
+void USkatingMovementComponent::TickBailBlend(const float DeltaSeconds)
+{
+	if (BailPhase == ESkatingBailPhase::BlendingIn)
+	{
+		BailBlendWeight = FMath::Min(1.f, BailBlendWeight + DeltaSeconds / BailBlendInDuration);
+		if (BailBlendWeight >= 1.f)
+		{
+			BailPhase = ESkatingBailPhase::Simulating;
+		}
+	}
+	else if (BailPhase == ESkatingBailPhase::BlendingOut)
+	{
+		BailBlendWeight = BailBlendOutDuration > 0.f ? FMath::Max(0.f, BailBlendWeight - DeltaSeconds / BailBlendOutDuration) : 0.f;
+		if (BailBlendWeight <= 0.f)
+		{
+			SetRagdollSimulation(false);
+			CharacterMesh->SetCollisionProfileName(InitialCollisionProfileName);
+			BailPhase = ESkatingBailPhase::None;
+		}
+	}
+
+	CharacterMesh->SetAllBodiesPhysicsBlendWeight(BailBlendWeight);
+}
+
+void USkatingMovementComponent::SetRagdollSimulation(const bool bSimulate)
+{
+	// Bodies always exist (see ASkaterCharacter), simulating only toggles them so bails don't create or destroy physics state.
+	// The character mesh stays attached to the capsule and is driven by the blend weight instead of being detached.
+	CharacterMesh->SetAllBodiesSimulatePhysics(bSimulate);
+	SkateboardMesh->SetSimulatePhysics(bSimulate);
+
+	if (bSimulate)
+	{
+		CharacterMesh->WakeAllRigidBodies();
+		SkateboardMesh->WakeAllRigidBodies();
+	}
 }
@@ -0,0 +1,187 @@
+// Copyright Amr Hamed
+
+
+#include "Movement/SkatingNetworkMoveData.h"
+#include "GameFramework/Character.h"
+#include "Core/SkatingQuantization.h"
+#include "Movement/SkatingMovementComponent.h"
+
+void FSavedMove_Skating::Clear()
+{
+	Super::Clear();
+
+	SpeedScale = 0.f;
+	FixedStepAccumulator = 0.f;
+	bIsChargingOllie = false;
+
+	OllyingAlpha = 0.f;
+	Grindable.Reset();
+	GrindingDistance = 0.f;
+}
+
+void FSavedMove_Skating::SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+	if (const USkatingMovementComponent* MovementComponent = Cast<USkatingMovementComponent>(Character->GetCharacterMovement()))
+	{
+		SpeedScale = MovementComponent->SpeedScale;
+		FixedStepAccumulator = MovementComponent->FixedStepAccumulator;
+		bIsChargingOllie = MovementComponent->bIsChargingOllie;
+	}
+}
+
+void FSavedMove_Skating::PrepMoveFor(ACharacter* Character)
+{
+	Super::PrepMoveFor(Character);
+
+	// Only inputs are restored, simulated state comes from the server correction we're replaying from
+	if (USkatingMovementComponent* MovementComponent = Cast<USkatingMovementComponent>(Character->GetCharacterMovement()))
+	{
+		MovementComponent->SpeedScale = SpeedScale;
+		MovementComponent->FixedStepAccumulator = FixedStepAccumulator;
+		MovementComponent->bIsChargingOllie = bIsChargingOllie;
+	}
+}
+
+void FSavedMove_Skating::PostUpdate(ACharacter* Character, EPostUpdateMode PostUpdateMode)
+{
+	Super::PostUpdate(Character, PostUpdateMode);
+
+	if (const USkatingMovementComponent* MovementComponent = Cast<USkatingMovementComponent>(Character->GetCharacterMovement()))
+	{
+		OllyingAlpha = MovementComponent->OllyingAlpha;
+		Grindable = MovementComponent->GetCurrentGrindable();
+		GrindingDistance = MovementComponent->GetGrindingDistance();
+	}
+}
+
+uint8 FSavedMove_Skating::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bIsChargingOllie)
+	{
+		Result |= FLAG_Custom_0;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_Skating::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_Skating* NewSkatingMove = static_cast<const FSavedMove_Skating*>(NewMove.Get());
+
+	if (SpeedScale != NewSkatingMove->SpeedScale
+		|| bIsChargingOllie != NewSkatingMove->bIsChargingOllie
+		|| Grindable != NewSkatingMove->Grindable)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+FNetworkPredictionData_Client_Skating::FNetworkPredictionData_Client_Skating(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Skating::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Skating());
+}
+
+void FSkatingNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	const FSavedMove_Skating& SkatingMove = static_cast<const FSavedMove_Skating&>(ClientMove);
+
+	QuantizedSpeedScale = SkatingQuantization::QuantizeUnitFloat8(SkatingMove.SpeedScale);
+	QuantizedOllyingAlpha = SkatingQuantization::QuantizeUnitFloat8(SkatingMove.OllyingAlpha);
+	Grindable = SkatingMove.Grindable.Get();
+	QuantizedGrindingDistance = SkatingQuantization::QuantizeDistance16(SkatingMove.GrindingDistance, SkatingNetworkMoveData::GrindingDistancePrecision);
+}
+
+bool FSkatingNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	if (!Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType))
+	{
+		return false;
+	}
+
+	Ar << QuantizedSpeedScale;
+	Ar << QuantizedOllyingAlpha;
+
+	if (!SkatingNetworkMoveData::SerializeGrindable(Ar, PackageMap, Grindable, QuantizedGrindingDistance))
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	return !Ar.IsError();
+}
+
+FSkatingNetworkMoveDataContainer::FSkatingNetworkMoveDataContainer()
+{
+	NewMoveData = &SkatingMoveData[0];
+	PendingMoveData = &SkatingMoveData[1];
+	OldMoveData = &SkatingMoveData[2];
+}
+
+void FSkatingMoveResponseDataContainer::ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment)
+{
+	Super::ServerFillResponseData(CharacterMovement, PendingAdjustment);
+
+	const USkatingMovementComponent& SkatingMovement = static_cast<const USkatingMovementComponent&>(CharacterMovement);
+
+	QuantizedSpeedScale = SkatingQuantization::QuantizeUnitFloat8(SkatingMovement.SpeedScale);
+	QuantizedOllyingAlpha = SkatingQuantization::QuantizeUnitFloat8(SkatingMovement.OllyingAlpha);
+	Grindable = SkatingMovement.GetCurrentGrindable();
+	QuantizedGrindingDistance = SkatingQuantization::QuantizeDistance16(SkatingMovement.GetGrindingDistance(), SkatingNetworkMoveData::GrindingDistancePrecision);
+}
+
+bool FSkatingMoveResponseDataContainer::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap)
+{
+	if (!Super::Serialize(CharacterMovement, Ar, PackageMap))
+	{
+		return false;
+	}
+
+	// Acks only need to confirm the move, skating state is only sent along corrections
+	if (IsCorrection())
+	{
+		Ar << QuantizedSpeedScale;
+		Ar << QuantizedOllyingAlpha;
+
+		if (!SkatingNetworkMoveData::SerializeGrindable(Ar, PackageMap, Grindable, QuantizedGrindingDistance))
+		{
+			Ar.SetError();
+			return false;
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+bool SkatingNetworkMoveData::SerializeGrindable(FArchive& Ar, UPackageMap* PackageMap, TObjectPtr<UObject>& Grindable, uint16& QuantizedGrindingDistance)
+{
+	uint8 bIsGrinding = Grindable != nullptr;
+	Ar.SerializeBits(&bIsGrinding, 1);
+
+	if (!bIsGrinding)
+	{
+		Grindable = nullptr;
+		QuantizedGrindingDistance = 0;
+		return true;
+	}
+
+	UObject* GrindableObject = Grindable;
+	const bool bSerializedObject = PackageMap && PackageMap->SerializeObject(Ar, UObject::StaticClass(), GrindableObject);
+	Grindable = GrindableObject;
+
+	Ar << QuantizedGrindingDistance;
+
+	return bSerializedObject;
+}
@@ -0,0 +1,168 @@
+// Copyright Amr Hamed
+
+
+#include "Movement/SkatingTrickRegistry.h"
+#include "Animation/AnimMontage.h"
+#include "Engine/AssetManager.h"
+#include "SkateboardingSim.h"
+
+void FSkatingTrick::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading() && ScorePerFrame_DEPRECATED != 0.f)
+	{
+		ScorePerSecond = ScorePerFrame_DEPRECATED * 60.f;
+		ScorePerFrame_DEPRECATED = 0.f;
+	}
+}
+
+void USkatingTrickRegistry::RequestMontagesAsyncLoad()
+{
+	if (MontagesHandle.IsValid())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> MontagePaths;
+	MontagePaths.Reserve(Tricks.Num() * 2);
+
+	for (const FSkatingTrick& Trick : Tricks)
+	{
+		if (!Trick.SkaterMontage.IsNull())
+		{
+			MontagePaths.Add(Trick.SkaterMontage.ToSoftObjectPath());
+		}
+
+		if (!Trick.SkateboardMontage.IsNull())
+		{
+			MontagePaths.Add(Trick.SkateboardMontage.ToSoftObjectPath());
+		}
+	}
+
+	if (MontagePaths.IsEmpty())
+	{
+		return;
+	}
+
+	UE_LOG(LogSkateboardingSim, Verbose, TEXT("%s: Streaming %d trick montages"), *GetName(), MontagePaths.Num());
+
+	MontagesHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(MontagePaths), FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void USkatingTrickRegistry::SetTricks(TArray<FSkatingTrick>&& InTricks)
+{
+	Tricks = MoveTemp(InTricks);
+	OnTricksChanged();
+}
+
+void USkatingTrickRegistry::PostLoad()
+{
+	Super::PostLoad();
+
+	OnTricksChanged();
+}
+
+#if WITH_EDITOR
+void USkatingTrickRegistry::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	OnTricksChanged();
+}
+#endif
+
+void USkatingTrickRegistry::OnTricksChanged()
+{
+	ComboTable.Compile(Tricks);
+
+	TrickIds.Reset(Tricks.Num());
+	Version = 0;
+	for (const FSkatingTrick& Trick : Tricks)
+	{
+		TrickIds.Add(GetTrickId(Trick.Name));
+		Version = HashCombineFast(Version, TrickIds.Last());
+	}
+}
+
+uint32 USkatingTrickRegistry::GetTrickId(const FName Name)
+{
+	// FName compares case insensitively, so ids do too
+	return Name.IsNone() ? 0 : FCrc::StrCrc32(*Name.ToString().ToLower());
+}
+
+FSkatingTrickHandle USkatingTrickRegistry::FindTrickById(const uint32 TrickId) const
+{
+	return FSkatingTrickHandle(TrickId ? TrickIds.IndexOfByKey(TrickId) : INDEX_NONE);
+}
+
+FSkatingTrickHandle USkatingTrickRegistry::AdvanceCombo(FSkatingComboState& ComboState, const ESkatingTrickInput Input, const double Time, const ESkatingTrickMovementState MovementState) const
+{
+	if (ComboTable.IsEmpty())
+	{
+		return FSkatingTrickHandle();
+	}
+
+	if (ComboState.GetNumInputs() && Time - ComboState.GetInput(0).Time > ComboInputWindow)
+	{
+		ComboState.Reset();
+	}
+
+	ComboState.AddInput({ Input, Time });
+	ComboState.TableState = ComboTable.Advance(ComboState.TableState, Input);
+
+	for (const int32 TrickIndex : ComboTable.GetMatches(ComboState.TableState))
+	{
+		const FSkatingTrick& Trick = Tricks[TrickIndex];
+		if (!Trick.CanStartFrom(MovementState))
+		{
+			continue;
+		}
+
+		const int32 SequenceLength = Trick.InputSequence.Num();
+		if (SequenceLength > ComboState.GetNumInputs())
+		{
+			continue;
+		}
+
+		const bool bIsInTime = Trick.MaxSequenceDuration <= 0.f
+			|| Time - ComboState.GetInput(SequenceLength - 1).Time <= Trick.MaxSequenceDuration;
+
+		if (bIsInTime)
+		{
+			return FSkatingTrickHandle(TrickIndex);
+		}
+	}
+
+	return FSkatingTrickHandle();
+}
+
+FSkatingTrickHandle USkatingTrickRegistry::FindTrick(const FName Name) const
+{
+	return FSkatingTrickHandle(Tricks.IndexOfByPredicate([Name](const FSkatingTrick& Trick) { return Trick.Name == Name; }));
+}
+
+bool USkatingTrickRegistry::GetTrickData(const FSkatingTrickHandle Handle, FSkatingTrick& OutTrick) const
+{
+	const FSkatingTrick* Trick = GetTrick(Handle);
+	if (!Trick)
+	{
+		return false;
+	}
+
+	OutTrick = *Trick;
+	return true;
+}
+
+FName USkatingTrickRegistry::GetTrickName(const FSkatingTrickHandle Handle) const
+{
+	const FSkatingTrick* Trick = GetTrick(Handle);
+	return Trick ? Trick->Name : NAME_None;
+}
+
+bool USkatingTrickRegistry::AreTrickMontagesLoaded(const FSkatingTrickHandle Handle) const
+{
+	const FSkatingTrick* Trick = GetTrick(Handle);
+
+	return Trick
+		&& Trick->SkaterMontage.Get()
+		&& (Trick->SkateboardMontage.IsNull() || Trick->SkateboardMontage.Get());
+}
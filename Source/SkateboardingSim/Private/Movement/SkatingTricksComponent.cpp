@@ -5,10 +5,71 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Core/ISkaterCharacter.h"
+#include "Core/SkatingMemory.h"
+#include "Core/SkatingStats.h"
+#include "Gameplay/SkatingEventSubsystem.h"
+#include "Movement/SkatingMovementComponent.h"
+#include "SkateboardingSim.h"
 
 USkatingTricksComponent::USkatingTricksComponent()
 {
 	PrimaryComponentTick.bCanEverTick = false;
+
+	RandomStream.GenerateNewSeed();
+}
+
+void USkatingTricksComponent::PostLoad()
+{
+	Super::PostLoad();
+
+	const bool bHasDeprecatedGrindingTrick = !GrindingTrick_DEPRECATED.Name.IsNone() || !GrindingTrick_DEPRECATED.SkaterMontage.IsNull();
+	const bool bHasDeprecatedTricks = !FlipTricks_DEPRECATED.IsEmpty() || bHasDeprecatedGrindingTrick;
+	if (!bHasDeprecatedTricks)
+	{
+		return;
+	}
+
+	if (TrickRegistry)
+	{
+		UE_LOG(LogSkateboardingSim, Warning, TEXT("%s: Ignoring tricks configured on the component, %s is used instead"), *GetPathName(), *TrickRegistry->GetName());
+	}
+	else
+	{
+		// Tricks are referenced by name, give unnamed ones a unique name
+		auto MigrateTrick = [](FSkatingTrick Trick, const FString& FallbackName, TArray<FSkatingTrick>& OutTricks)
+			{
+				if (Trick.Name.IsNone())
+				{
+					Trick.Name = FName(FallbackName);
+				}
+
+				OutTricks.Add(MoveTemp(Trick));
+				return OutTricks.Last().Name;
+			};
+
+		TArray<FSkatingTrick> MigratedTricks;
+		MigratedTricks.Reserve(FlipTricks_DEPRECATED.Num() + 1);
+
+		FlipTrickNames.Reset(FlipTricks_DEPRECATED.Num());
+		for (int32 Index = 0; Index < FlipTricks_DEPRECATED.Num(); ++Index)
+		{
+			FlipTrickNames.Add(MigrateTrick(FlipTricks_DEPRECATED[Index], FString::Printf(TEXT("FlipTrick_%d"), Index), MigratedTricks));
+		}
+
+		if (bHasDeprecatedGrindingTrick)
+		{
+			GrindingTrickName = MigrateTrick(GrindingTrick_DEPRECATED, TEXT("GrindingTrick"), MigratedTricks);
+		}
+
+		// Saved with the owner until the tricks are moved into a shared registry asset
+		TrickRegistry = NewObject<USkatingTrickRegistry>(this, TEXT("MigratedTrickRegistry"), GetMaskedFlags(RF_PropagateToSubObjects));
+		TrickRegistry->SetTricks(MoveTemp(MigratedTricks));
+
+		UE_LOG(LogSkateboardingSim, Log, TEXT("%s: Migrated %d tricks into a component owned registry, resave to keep them"), *GetPathName(), TrickRegistry->Num());
+	}
+
+	FlipTricks_DEPRECATED.Empty();
+	GrindingTrick_DEPRECATED = FSkatingTrick();
 }
 
 void USkatingTricksComponent::OnRegister()
@@ -40,38 +101,115 @@ void USkatingTricksComponent::BeginPlay()
 	OwnerCharacter = Cast<ACharacter>(GetOwner());
 	check(OwnerCharacter);
 
-	OwnerCharacter->LandedDelegate.AddDynamic(this, &USkatingTricksComponent::OnOwnerLanded);
+	EventSubsystem = GetWorld()->GetSubsystem<USkatingEventSubsystem>();
+	if (EventSubsystem)
+	{
+		LandedHandle = EventSubsystem->OnEvent<FSkatingLandedEvent>(OwnerCharacter).AddUObject(this, &USkatingTricksComponent::OnSkaterLanded);
+	}
+	else
+	{
+		OwnerCharacter->LandedDelegate.AddDynamic(this, &USkatingTricksComponent::OnOwnerLanded);
+	}
+
+	ResolveTricks();
+}
+
+void USkatingTricksComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (EventSubsystem)
+	{
+		EventSubsystem->RemoveListener<FSkatingLandedEvent>(OwnerCharacter, LandedHandle);
+	}
+	else if (OwnerCharacter)
+	{
+		OwnerCharacter->LandedDelegate.RemoveDynamic(this, &USkatingTricksComponent::OnOwnerLanded);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void USkatingTricksComponent::ResolveTricks()
+{
+	if (!ensureMsgf(TrickRegistry, TEXT("%s has no Trick Registry, no tricks can be performed"), *GetOwner()->GetName()))
+	{
+		return;
+	}
+
+	TrickRegistry->RequestMontagesAsyncLoad();
+
+	FlipTricks.Reset(FlipTrickNames.Num());
+	for (const FName FlipTrickName : FlipTrickNames)
+	{
+		const FSkatingTrickHandle FlipTrick = TrickRegistry->FindTrick(FlipTrickName);
+		if (FlipTrick.IsValid())
+		{
+			FlipTricks.Add(FlipTrick);
+		}
+		else
+		{
+			UE_LOG(LogSkateboardingSim, Warning, TEXT("%s: Flip trick %s isn't in %s"), *GetOwner()->GetName(), *FlipTrickName.ToString(), *TrickRegistry->GetName());
+		}
+	}
+
+	GrindingTrick = TrickRegistry->FindTrick(GrindingTrickName);
+}
+
+void USkatingTricksComponent::OnSkaterLanded(const FSkatingLandedEvent& Event)
+{
+	EndActiveTrick();
 }
 
 void USkatingTricksComponent::OnOwnerLanded(const FHitResult& Hit)
 {
-	if (!ActiveTrick.IsSet()) 
+	EndActiveTrick();
+}
+
+void USkatingTricksComponent::EndActiveTrick()
+{
+	if (!ActiveTrick.IsValid()) 
 	{
 		return;
 	}
 
-	check(OwnerCharacter);
+	SKATING_MEMORY_SCOPE();
+
 	if (const ISkaterCharacterInterface* SkaterCharacter = Cast<ISkaterCharacterInterface>(OwnerCharacter))
 	{
-		OnSkatingTrickEnded.Broadcast(*ActiveTrick, SkaterCharacter->IsBailingOrShouldBail());
+		// Landing the trick is a success unless we bail, both movement and tricks read the same landing snapshot
+		const FSkatingTrickEndedEvent TrickEndedEvent{ OwnerCharacter, ActiveTrick, !SkaterCharacter->IsBailingOrShouldBail() };
 		ActiveTrick.Reset();
+
+		if (EventSubsystem)
+		{
+			EventSubsystem->Post(TrickEndedEvent);
+		}
+
+		if (OnSkatingTrickEnded.IsBound())
+		{
+			OnSkatingTrickEnded.Broadcast(TrickEndedEvent.Trick, TrickEndedEvent.bWasSuccessful);
+		}
 	}
 }
 
-bool USkatingTricksComponent::PerformTrick(const FSkatingTrick& SkatingTrick)
+bool USkatingTricksComponent::PerformTrick(const FSkatingTrickHandle SkatingTrick)
 {
 	if (!CanPerformSkatingTrick(SkatingTrick)) 
 	{
 		return false;
 	}
 
+	SKATING_MEMORY_SCOPE();
+	INC_DWORD_STAT(STAT_Skating_TrickStarts);
+
 	ActiveTrick = SkatingTrick;
 
-	const float PlayRate = ActiveTrick->PlayRate;
-	OwnerCharacter->PlayAnimMontage(ActiveTrick->SkaterMontage, PlayRate);
+	const FSkatingTrick& Trick = *TrickRegistry->GetTrick(ActiveTrick);
+
+	const float PlayRate = Trick.PlayRate;
+	OwnerCharacter->PlayAnimMontage(Trick.SkaterMontage.Get(), PlayRate);
 
 	const ISkaterCharacterInterface* SkaterCharacter = Cast<ISkaterCharacterInterface>(OwnerCharacter);
-	if (ensure(SkaterCharacter) && ActiveTrick->SkateboardMontage)
+	if (ensure(SkaterCharacter) && Trick.SkateboardMontage.Get())
 	{
 		USkeletalMeshComponent* Skateboard = SkaterCharacter->GetSkateboard();
 		if (ensure(Skateboard)) 
@@ -79,19 +217,101 @@ bool USkatingTricksComponent::PerformTrick(const FSkatingTrick& SkatingTrick)
 			UAnimInstance* SkateboardAnimInstance = Skateboard->GetAnimInstance();
 			if (ensure(SkateboardAnimInstance))
 			{
-				SkateboardAnimInstance->Montage_Play(ActiveTrick->SkateboardMontage, PlayRate);
+				SkateboardAnimInstance->Montage_Play(Trick.SkateboardMontage.Get(), PlayRate);
 			}
 		}
 	}
 
-	OnSkatingTrickStarted.Broadcast(*ActiveTrick);
+	if (EventSubsystem)
+	{
+		EventSubsystem->Post(FSkatingTrickStartedEvent{ OwnerCharacter, ActiveTrick });
+	}
+
+	if (OnSkatingTrickStarted.IsBound())
+	{
+		OnSkatingTrickStarted.Broadcast(ActiveTrick);
+	}
 
 	return true;
 }
 
+bool USkatingTricksComponent::HandleTrickInput(const ESkatingTrickInput Input)
+{
+	if (!TrickRegistry)
+	{
+		return false;
+	}
+
+	const FSkatingTrickHandle ComboTrick = TrickRegistry->AdvanceCombo(ComboState, Input, GetWorld()->GetTimeSeconds(), GetTrickMovementState());
+	if (ComboTrick.IsValid() && PerformTrick(ComboTrick))
+	{
+		ComboState.Reset();
+		return true;
+	}
+
+	return false;
+}
+
+void USkatingTricksComponent::HandleTrickDirection(const FVector2D& MoveInput)
+{
+	constexpr float DirectionThreshold = 0.5f;
+
+	ESkatingTrickInput DirectionInput = ESkatingTrickInput::Num;
+	if (MoveInput.GetAbsMax() >= DirectionThreshold)
+	{
+		if (FMath::Abs(MoveInput.X) > FMath::Abs(MoveInput.Y))
+		{
+			DirectionInput = MoveInput.X > 0.f ? ESkatingTrickInput::Right : ESkatingTrickInput::Left;
+		}
+		else
+		{
+			DirectionInput = MoveInput.Y > 0.f ? ESkatingTrickInput::Up : ESkatingTrickInput::Down;
+		}
+	}
+
+	if (DirectionInput == LastDirectionInput)
+	{
+		return;
+	}
+
+	LastDirectionInput = DirectionInput;
+
+	if (DirectionInput != ESkatingTrickInput::Num)
+	{
+		HandleTrickInput(DirectionInput);
+	}
+}
+
+ESkatingTrickMovementState USkatingTricksComponent::GetTrickMovementState() const
+{
+	const UCharacterMovementComponent* MovementComponent = OwnerCharacter->GetCharacterMovement();
+	if (!MovementComponent)
+	{
+		return ESkatingTrickMovementState::None;
+	}
+
+	const USkatingMovementComponent* SkatingMovementComponent = Cast<USkatingMovementComponent>(MovementComponent);
+	if (SkatingMovementComponent && SkatingMovementComponent->IsGrinding())
+	{
+		return ESkatingTrickMovementState::Grinding;
+	}
+
+	if (MovementComponent->IsFalling())
+	{
+		return ESkatingTrickMovementState::InAir;
+	}
+
+	return MovementComponent->IsMovingOnGround() ? ESkatingTrickMovementState::OnGround : ESkatingTrickMovementState::None;
+}
+
 bool USkatingTricksComponent::PerformRandomFlipTrick()
 {
-	const int32 RandomIndex = FMath::RandRange(0, FlipTricks.Num() - 1);
+	if (FlipTricks.IsEmpty())
+	{
+		return false;
+	}
+
+	const int32 RandomIndex = RandomStream.RandRange(0, FlipTricks.Num() - 1);
 	return PerformTrick(FlipTricks[RandomIndex]);
 }
 
@@ -100,11 +320,14 @@ bool USkatingTricksComponent::PerformGrindingTrick()
 	return PerformTrick(GrindingTrick);
 }
 
-bool USkatingTricksComponent::CanPerformSkatingTrick(const FSkatingTrick& SkatingMove) const
+bool USkatingTricksComponent::CanPerformSkatingTrick(const FSkatingTrickHandle SkatingTrick) const
 {
+	// Tricks whose montages are still streaming are skipped rather than loaded synchronously
+	const FSkatingTrick* Trick = TrickRegistry ? TrickRegistry->GetTrick(SkatingTrick) : nullptr;
+
 	return
-		OwnerCharacter->GetCharacterMovement()
-		&& OwnerCharacter->GetCharacterMovement()->IsFalling()
-		&& !ActiveTrick.IsSet() 
-		&& SkatingMove.SkaterMontage;
+		Trick
+		&& Trick->CanStartFrom(GetTrickMovementState())
+		&& !ActiveTrick.IsValid() 
+		&& TrickRegistry->AreTrickMontagesLoaded(SkatingTrick);
 }
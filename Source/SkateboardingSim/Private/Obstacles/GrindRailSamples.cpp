@@ -0,0 +1,228 @@
+// Copyright Amr Hamed
+
+
+#include "Obstacles/GrindRailSamples.h"
+#include "Algo/BinarySearch.h"
+#include "Components/SplineComponent.h"
+#include "Serialization/CustomVersion.h"
+
+/** Versions of bulk serialized rail samples, bump when their layout changes */
+struct FGrindRailSamplesCustomVersion
+{
+	enum Type
+	{
+		// Positions, tangents and distances bulk serialized
+		BeforeCustomVersionWasAdded = 0,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+const FGuid FGrindRailSamplesCustomVersion::GUID(0xE18F9F04, 0x7C93403C, 0x9239F91D, 0x1511A90B);
+static FCustomVersionRegistration GRegisterGrindRailSamplesCustomVersion(FGrindRailSamplesCustomVersion::GUID, FGrindRailSamplesCustomVersion::LatestVersion, TEXT("GrindRailSamplesVer"));
+
+void FGrindRailSamples::BakeFromSpline(const USplineComponent& Spline, const float SampleSpacing)
+{
+	Reset();
+
+	const float SplineLength = Spline.GetSplineLength();
+	const int32 NumSegments = FMath::Max(1, FMath::CeilToInt32(SplineLength / FMath::Max(SampleSpacing, UE_KINDA_SMALL_NUMBER)));
+
+	Positions.Reserve(NumSegments + 1);
+	Tangents.Reserve(NumSegments + 1);
+	Distances.Reserve(NumSegments + 1);
+
+	for (int32 SampleIndex = 0; SampleIndex <= NumSegments; ++SampleIndex)
+	{
+		const float Distance = SplineLength * SampleIndex / NumSegments;
+
+		Positions.Add(Spline.GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::Local));
+		Tangents.Add(Spline.GetDirectionAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::Local));
+		Distances.Add(Distance);
+	}
+
+	BuildChunkBounds();
+}
+
+void FGrindRailSamples::BakeFromPolyline(TConstArrayView<FVector> Points, const float SampleSpacing)
+{
+	Reset();
+
+	if (Points.Num() < 2)
+	{
+		return;
+	}
+
+	for (int32 PointIndex = 1; PointIndex < Points.Num(); ++PointIndex)
+	{
+		const FVector& SegmentStart = Points[PointIndex - 1];
+		const FVector Segment = Points[PointIndex] - SegmentStart;
+		const float SegmentLength = static_cast<float>(Segment.Size());
+		const FVector Direction = Segment.GetSafeNormal();
+		const float StartDistance = Distances.Num() ? Distances.Last() : 0.f;
+
+		// Corners share a sample, its tangent is averaged so the hermite curve stays close to both segments
+		if (Tangents.Num())
+		{
+			Tangents.Last() = (Tangents.Last() + Direction).GetSafeNormal();
+		}
+		else
+		{
+			Positions.Add(SegmentStart);
+			Tangents.Add(Direction);
+			Distances.Add(0.f);
+		}
+
+		const int32 NumSegments = FMath::Max(1, FMath::CeilToInt32(SegmentLength / FMath::Max(SampleSpacing, UE_KINDA_SMALL_NUMBER)));
+		for (int32 SampleIndex = 1; SampleIndex <= NumSegments; ++SampleIndex)
+		{
+			const float Alpha = static_cast<float>(SampleIndex) / NumSegments;
+			Positions.Add(SegmentStart + Segment * Alpha);
+			Tangents.Add(Direction);
+			Distances.Add(StartDistance + SegmentLength * Alpha);
+		}
+	}
+
+	BuildChunkBounds();
+}
+
+void FGrindRailSamples::Reset()
+{
+	Positions.Reset();
+	Tangents.Reset();
+	Distances.Reset();
+	ChunkBounds.Reset();
+	Bounds = FBox(ForceInit);
+}
+
+void FGrindRailSamples::BuildChunkBounds()
+{
+	const int32 NumSegments = Positions.Num() - 1;
+	for (int32 ChunkStart = 0; ChunkStart < NumSegments; ChunkStart += ChunkSize)
+	{
+		const int32 ChunkEnd = FMath::Min(ChunkStart + ChunkSize, NumSegments);
+		ChunkBounds.Add(FSphere(&Positions[ChunkStart], ChunkEnd - ChunkStart + 1));
+	}
+
+	Bounds = FBox(Positions);
+}
+
+bool FGrindRailSamples::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FGrindRailSamplesCustomVersion::GUID);
+
+	Positions.BulkSerialize(Ar);
+	Tangents.BulkSerialize(Ar);
+	Distances.BulkSerialize(Ar);
+
+	if (Ar.IsLoading())
+	{
+		ChunkBounds.Reset();
+		BuildChunkBounds();
+	}
+
+	return true;
+}
+
+bool FGrindRailSamples::FindClosestPoint(const FVector& Location, FGrindRailPoint& OutPoint) const
+{
+	if (IsEmpty())
+	{
+		return false;
+	}
+
+	// Find closest chord, skipping chunks that can't beat the best one so far
+	const int32 NumSegments = Positions.Num() - 1;
+	int32 ClosestSegment = 0;
+	float ClosestAlpha = 0.f;
+	double ClosestDistanceSquared = TNumericLimits<double>::Max();
+
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunkBounds.Num(); ++ChunkIndex)
+	{
+		const FSphere& Bounds = ChunkBounds[ChunkIndex];
+		const double MinChunkDistance = FMath::Max(0.0, FVector::Dist(Location, Bounds.Center) - Bounds.W);
+		if (FMath::Square(MinChunkDistance) > ClosestDistanceSquared)
+		{
+			continue;
+		}
+
+		const int32 ChunkStart = ChunkIndex * ChunkSize;
+		const int32 ChunkEnd = FMath::Min(ChunkStart + ChunkSize, NumSegments);
+		for (int32 SegmentIndex = ChunkStart; SegmentIndex < ChunkEnd; ++SegmentIndex)
+		{
+			const FVector Chord = Positions[SegmentIndex + 1] - Positions[SegmentIndex];
+			const double ChordLengthSquared = Chord.SizeSquared();
+			const float Alpha = ChordLengthSquared > UE_SMALL_NUMBER
+				? static_cast<float>(FMath::Clamp((Location - Positions[SegmentIndex]).Dot(Chord) / ChordLengthSquared, 0.0, 1.0))
+				: 0.f;
+
+			const double DistanceSquared = FVector::DistSquared(Location, Positions[SegmentIndex] + Chord * Alpha);
+			if (DistanceSquared < ClosestDistanceSquared)
+			{
+				ClosestDistanceSquared = DistanceSquared;
+				ClosestSegment = SegmentIndex;
+				ClosestAlpha = Alpha;
+			}
+		}
+	}
+
+	// Refine on the segment curve, a couple newton steps are enough since the chord is already close
+	for (int32 Iteration = 0; Iteration < 2; ++Iteration)
+	{
+		const FVector Offset = EvaluateSegment(ClosestSegment, ClosestAlpha) - Location;
+		const FVector Derivative = EvaluateSegmentDerivative(ClosestSegment, ClosestAlpha);
+		const double DerivativeSizeSquared = Derivative.SizeSquared();
+		if (DerivativeSizeSquared <= UE_SMALL_NUMBER)
+		{
+			break;
+		}
+
+		ClosestAlpha = static_cast<float>(FMath::Clamp(ClosestAlpha - Offset.Dot(Derivative) / DerivativeSizeSquared, 0.0, 1.0));
+	}
+
+	OutPoint.Location = EvaluateSegment(ClosestSegment, ClosestAlpha);
+	OutPoint.Direction = FMath::Lerp(Tangents[ClosestSegment], Tangents[ClosestSegment + 1], ClosestAlpha).GetSafeNormal();
+	OutPoint.Distance = FMath::Lerp(Distances[ClosestSegment], Distances[ClosestSegment + 1], ClosestAlpha);
+	return true;
+}
+
+FGrindRailPoint FGrindRailSamples::GetPointAtDistance(const float Distance) const
+{
+	FGrindRailPoint Point;
+	if (IsEmpty())
+	{
+		return Point;
+	}
+
+	Point.Distance = FMath::Clamp(Distance, 0.f, GetLength());
+
+	const int32 SegmentIndex = FMath::Clamp(Algo::UpperBound(Distances, Point.Distance) - 1, 0, Positions.Num() - 2);
+	const float SegmentLength = Distances[SegmentIndex + 1] - Distances[SegmentIndex];
+	const float Alpha = SegmentLength > UE_SMALL_NUMBER ? (Point.Distance - Distances[SegmentIndex]) / SegmentLength : 0.f;
+
+	Point.Location = EvaluateSegment(SegmentIndex, Alpha);
+	Point.Direction = FMath::Lerp(Tangents[SegmentIndex], Tangents[SegmentIndex + 1], Alpha).GetSafeNormal();
+	return Point;
+}
+
+FVector FGrindRailSamples::EvaluateSegment(const int32 SegmentIndex, const float Alpha) const
+{
+	const float SegmentLength = Distances[SegmentIndex + 1] - Distances[SegmentIndex];
+	return FMath::CubicInterp(
+		Positions[SegmentIndex], Tangents[SegmentIndex] * SegmentLength,
+		Positions[SegmentIndex + 1], Tangents[SegmentIndex + 1] * SegmentLength,
+		Alpha);
+}
+
+FVector FGrindRailSamples::EvaluateSegmentDerivative(const int32 SegmentIndex, const float Alpha) const
+{
+	const float SegmentLength = Distances[SegmentIndex + 1] - Distances[SegmentIndex];
+	return FMath::CubicInterpDerivative(
+		Positions[SegmentIndex], Tangents[SegmentIndex] * SegmentLength,
+		Positions[SegmentIndex + 1], Tangents[SegmentIndex + 1] * SegmentLength,
+		Alpha);
+}
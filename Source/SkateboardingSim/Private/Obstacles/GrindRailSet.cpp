@@ -0,0 +1,455 @@
+// Copyright Amr Hamed
+
+
+#include "Obstacles/GrindRailSet.h"
+#include "Components/CapsuleComponent.h"
+#include "Core/SkatingStats.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Obstacles/GrindableSubsystem.h"
+#include "SkateboardingSim.h"
+
+#if WITH_EDITOR
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "EngineUtils.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+#if WITH_EDITOR
+namespace GrindRailBaking
+{
+	struct FEdge
+	{
+		FVector Start;
+		FVector End;
+	};
+
+	/** Edges of the box face pointing the most up */
+	static void AddBoxEdges(const FKBoxElem& Box, const FTransform& ComponentTransform, TArray<FEdge>& OutEdges)
+	{
+		const FTransform BoxTransform = Box.GetTransform() * ComponentTransform;
+		const FVector Extent = FVector(Box.X, Box.Y, Box.Z) * 0.5;
+
+		int32 UpAxis = 0;
+		double UpAxisSign = 1.0;
+		double MaxUpDot = -1.0;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const double UpDot = BoxTransform.GetUnitAxis(static_cast<EAxis::Type>(EAxis::X + Axis)).Z;
+			if (FMath::Abs(UpDot) > MaxUpDot)
+			{
+				MaxUpDot = FMath::Abs(UpDot);
+				UpAxis = Axis;
+				UpAxisSign = UpDot >= 0.0 ? 1.0 : -1.0;
+			}
+		}
+
+		const int32 AxisA = (UpAxis + 1) % 3;
+		const int32 AxisB = (UpAxis + 2) % 3;
+		constexpr double CornerSigns[4][2] = { { 1.0, 1.0 }, { 1.0, -1.0 }, { -1.0, -1.0 }, { -1.0, 1.0 } };
+
+		FVector Corners[4];
+		for (int32 CornerIndex = 0; CornerIndex < 4; ++CornerIndex)
+		{
+			FVector LocalCorner;
+			LocalCorner[UpAxis] = Extent[UpAxis] * UpAxisSign;
+			LocalCorner[AxisA] = Extent[AxisA] * CornerSigns[CornerIndex][0];
+			LocalCorner[AxisB] = Extent[AxisB] * CornerSigns[CornerIndex][1];
+			Corners[CornerIndex] = BoxTransform.TransformPosition(LocalCorner);
+		}
+
+		for (int32 CornerIndex = 0; CornerIndex < 4; ++CornerIndex)
+		{
+			OutEdges.Add({ Corners[CornerIndex], Corners[(CornerIndex + 1) % 4] });
+		}
+	}
+
+	/** Top line of a capsule, slope filtering drops upright ones */
+	static void AddSphylEdges(const FKSphylElem& Sphyl, const FTransform& ComponentTransform, TArray<FEdge>& OutEdges)
+	{
+		const FTransform SphylTransform = Sphyl.GetTransform() * ComponentTransform;
+		const FVector Axis = SphylTransform.GetUnitAxis(EAxis::Z);
+		const FVector Center = SphylTransform.GetLocation() + FVector::UpVector * Sphyl.Radius * SphylTransform.GetMaximumAxisScale();
+		const FVector HalfLength = Axis * Sphyl.Length * 0.5 * SphylTransform.GetScale3D().Z;
+
+		OutEdges.Add({ Center - HalfLength, Center + HalfLength });
+	}
+
+	/** Hull edges whose faces meet at MinSharpnessCos or sharper, with at least one face looking up */
+	static void AddConvexEdges(const FKConvexElem& Convex, const FTransform& ComponentTransform, const double MinSharpnessCos, TArray<FEdge>& OutEdges)
+	{
+		const FTransform ConvexTransform = Convex.GetTransform() * ComponentTransform;
+		const TArray<int32>& Indices = Convex.IndexData;
+
+		TArray<FVector> Vertices;
+		Vertices.Reserve(Convex.VertexData.Num());
+		for (const FVector& Vertex : Convex.VertexData)
+		{
+			Vertices.Add(ConvexTransform.TransformPosition(Vertex));
+		}
+
+		// Normals of the faces sharing each edge, keyed by sorted vertex indices
+		TMap<TTuple<int32, int32>, TArray<FVector, TInlineAllocator<2>>> EdgeFaces;
+		for (int32 Index = 0; Index + 2 < Indices.Num(); Index += 3)
+		{
+			const int32 Triangle[3] = { Indices[Index], Indices[Index + 1], Indices[Index + 2] };
+			const FVector Normal = ((Vertices[Triangle[1]] - Vertices[Triangle[0]]) ^ (Vertices[Triangle[2]] - Vertices[Triangle[0]])).GetSafeNormal();
+
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				const int32 A = Triangle[Corner];
+				const int32 B = Triangle[(Corner + 1) % 3];
+				EdgeFaces.FindOrAdd(MakeTuple(FMath::Min(A, B), FMath::Max(A, B))).Add(Normal);
+			}
+		}
+
+		for (const TPair<TTuple<int32, int32>, TArray<FVector, TInlineAllocator<2>>>& EdgeFace : EdgeFaces)
+		{
+			const TArray<FVector, TInlineAllocator<2>>& Normals = EdgeFace.Value;
+			if (Normals.Num() != 2 || Normals[0].Dot(Normals[1]) > MinSharpnessCos || FMath::Max(Normals[0].Z, Normals[1].Z) < 0.5)
+			{
+				continue;
+			}
+
+			OutEdges.Add({ Vertices[EdgeFace.Key.Get<0>()], Vertices[EdgeFace.Key.Get<1>()] });
+		}
+	}
+
+	/** Chains connected edges going the same way into polylines */
+	static TArray<TArray<FVector>> ChainEdges(TConstArrayView<FEdge> Edges, const double MaxChainAngleCos)
+	{
+		constexpr double ConnectTolerance = 1.0;
+
+		TArray<TArray<FVector>> Polylines;
+		TBitArray<> UsedEdges(false, Edges.Num());
+
+		// Finds an unused edge continuing from Point along Direction, returns its far end
+		auto FindContinuation = [&Edges, &UsedEdges, MaxChainAngleCos](const FVector& Point, const FVector& Direction, FVector& OutNextPoint)
+			{
+				for (int32 EdgeIndex = 0; EdgeIndex < Edges.Num(); ++EdgeIndex)
+				{
+					if (UsedEdges[EdgeIndex])
+					{
+						continue;
+					}
+
+					const FEdge& Edge = Edges[EdgeIndex];
+					const bool bFromStart = FVector::DistSquared(Edge.Start, Point) <= FMath::Square(ConnectTolerance);
+					const bool bFromEnd = !bFromStart && FVector::DistSquared(Edge.End, Point) <= FMath::Square(ConnectTolerance);
+					if (!bFromStart && !bFromEnd)
+					{
+						continue;
+					}
+
+					const FVector NextPoint = bFromStart ? Edge.End : Edge.Start;
+					if ((NextPoint - Point).GetSafeNormal().Dot(Direction) >= MaxChainAngleCos)
+					{
+						UsedEdges[EdgeIndex] = true;
+						OutNextPoint = NextPoint;
+						return true;
+					}
+				}
+
+				return false;
+			};
+
+		for (int32 EdgeIndex = 0; EdgeIndex < Edges.Num(); ++EdgeIndex)
+		{
+			if (UsedEdges[EdgeIndex])
+			{
+				continue;
+			}
+
+			UsedEdges[EdgeIndex] = true;
+			TArray<FVector>& Polyline = Polylines.AddDefaulted_GetRef();
+			Polyline = { Edges[EdgeIndex].Start, Edges[EdgeIndex].End };
+
+			FVector NextPoint;
+			while (FindContinuation(Polyline.Last(), (Polyline.Last() - Polyline.Last(1)).GetSafeNormal(), NextPoint))
+			{
+				Polyline.Add(NextPoint);
+			}
+
+			while (FindContinuation(Polyline[0], (Polyline[0] - Polyline[1]).GetSafeNormal(), NextPoint))
+			{
+				Polyline.Insert(NextPoint, 0);
+			}
+		}
+
+		return Polylines;
+	}
+
+	static double GetPolylineLength(TConstArrayView<FVector> Polyline)
+	{
+		double Length = 0.0;
+		for (int32 PointIndex = 1; PointIndex < Polyline.Num(); ++PointIndex)
+		{
+			Length += FVector::Dist(Polyline[PointIndex - 1], Polyline[PointIndex]);
+		}
+
+		return Length;
+	}
+}
+#endif
+
+AGrindRailSet::AGrindRailSet()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AGrindRailSet::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UGrindableSubsystem* GrindableSubsystem = UWorld::GetSubsystem<UGrindableSubsystem>(GetWorld()))
+	{
+		GrindableSubsystem->RegisterGrindableRails(this, Rails);
+	}
+}
+
+void AGrindRailSet::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGrindableSubsystem* GrindableSubsystem = UWorld::GetSubsystem<UGrindableSubsystem>(GetWorld()))
+	{
+		GrindableSubsystem->UnregisterGrindable(this);
+	}
+
+	GrindingCharacters.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if WITH_EDITOR
+void AGrindRailSet::BakeRails()
+{
+	using namespace GrindRailBaking;
+
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	TSet<FSoftObjectPath> GrindableMeshPaths;
+	for (const TSoftObjectPtr<UStaticMesh>& GrindableMesh : GrindableMeshes)
+	{
+		GrindableMeshPaths.Add(GrindableMesh.ToSoftObjectPath());
+	}
+
+	const double MinSharpnessCos = FMath::Cos(FMath::DegreesToRadians(MinEdgeSharpness));
+	const double MaxSlopeSin = FMath::Sin(FMath::DegreesToRadians(MaxRailSlope));
+
+	// Meshes are gathered from actors loaded in the set's world
+	TArray<FEdge> Edges;
+	for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+	{
+		TInlineComponentArray<UStaticMeshComponent*> MeshComponents(*ActorIt);
+		for (const UStaticMeshComponent* MeshComponent : MeshComponents)
+		{
+			const UStaticMesh* Mesh = MeshComponent->GetStaticMesh();
+			const UBodySetup* BodySetup = Mesh ? Mesh->GetBodySetup() : nullptr;
+			if (!BodySetup || !GrindableMeshPaths.Contains(FSoftObjectPath(Mesh)))
+			{
+				continue;
+			}
+
+			const FTransform& ComponentTransform = MeshComponent->GetComponentTransform();
+			for (const FKBoxElem& Box : BodySetup->AggGeom.BoxElems)
+			{
+				AddBoxEdges(Box, ComponentTransform, Edges);
+			}
+
+			for (const FKSphylElem& Sphyl : BodySetup->AggGeom.SphylElems)
+			{
+				AddSphylEdges(Sphyl, ComponentTransform, Edges);
+			}
+
+			for (const FKConvexElem& Convex : BodySetup->AggGeom.ConvexElems)
+			{
+				AddConvexEdges(Convex, ComponentTransform, MinSharpnessCos, Edges);
+			}
+		}
+	}
+
+	Edges.RemoveAll([MaxSlopeSin](const FEdge& Edge)
+		{
+			return FMath::Abs((Edge.End - Edge.Start).GetSafeNormal().Z) > MaxSlopeSin;
+		});
+
+	TArray<FGrindRailSamples> BakedRails;
+	const double MaxChainAngleCos = FMath::Cos(FMath::DegreesToRadians(MaxChainAngle));
+	for (const TArray<FVector>& Polyline : ChainEdges(Edges, MaxChainAngleCos))
+	{
+		if (GetPolylineLength(Polyline) >= MinRailLength)
+		{
+			BakedRails.AddDefaulted_GetRef().BakeFromPolyline(Polyline, RailSampleSpacing);
+		}
+	}
+
+	// Unloaded actors bake nothing, clear Rails by hand if the meshes are really gone
+	if (BakedRails.IsEmpty() && !Rails.IsEmpty())
+	{
+		UE_LOG(LogSkateboardingSim, Warning, TEXT("%s: Baked no grind rails from %d collision edges, keeping the %d baked before"), *GetName(), Edges.Num(), Rails.Num());
+		return;
+	}
+
+	Modify();
+	Rails = MoveTemp(BakedRails);
+
+	UE_LOG(LogSkateboardingSim, Log, TEXT("%s: Baked %d grind rails from %d collision edges"), *GetName(), Rails.Num(), Edges.Num());
+}
+
+void AGrindRailSet::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	// Only rebake on editor saves of fully loaded levels, cooks and partitioned worlds may not have every grindable loaded
+	const UWorld* World = GetWorld();
+	if (!ObjectSaveContext.IsCooking() && !ObjectSaveContext.IsProceduralSave() && World && !World->IsPartitionedWorld())
+	{
+		BakeRails();
+	}
+}
+#endif
+
+void AGrindRailSet::AddRail(TConstArrayView<FVector> Points)
+{
+	FGrindRailSamples& Rail = Rails.AddDefaulted_GetRef();
+	Rail.BakeFromPolyline(Points, RailSampleSpacing);
+
+	// Rails added before BeginPlay are registered with the baked ones
+	if (HasActorBegunPlay())
+	{
+		if (UGrindableSubsystem* GrindableSubsystem = UWorld::GetSubsystem<UGrindableSubsystem>(GetWorld()))
+		{
+			GrindableSubsystem->RegisterGrindableRails(this, MakeArrayView(&Rail, 1));
+		}
+	}
+}
+
+int32 AGrindRailSet::FindClosestRailPoint(const FVector& Location, const float MaxDistance, FGrindRailPoint& OutPoint) const
+{
+	int32 ClosestRail = INDEX_NONE;
+	double ClosestDistanceSquared = FMath::Square(MaxDistance);
+
+	for (int32 RailIndex = 0; RailIndex < Rails.Num(); ++RailIndex)
+	{
+		const FGrindRailSamples& Rail = Rails[RailIndex];
+		if (Rail.GetBounds().ComputeSquaredDistanceToPoint(Location) > ClosestDistanceSquared)
+		{
+			continue;
+		}
+
+		FGrindRailPoint RailPoint;
+		if (Rail.FindClosestPoint(Location, RailPoint))
+		{
+			const double DistanceSquared = FVector::DistSquared(Location, RailPoint.Location);
+			if (DistanceSquared < ClosestDistanceSquared)
+			{
+				ClosestDistanceSquared = DistanceSquared;
+				ClosestRail = RailIndex;
+				OutPoint = RailPoint;
+			}
+		}
+	}
+
+	return ClosestRail;
+}
+
+bool AGrindRailSet::IsGrindable(ACharacter* Character) const
+{
+	FGrindRailPoint ClosestPoint;
+	// Same location OnGrindingStarted snaps from, so passing this check means the snap succeeds
+	return Character && FindClosestRailPoint(Character->GetMesh()->GetComponentLocation(), MaxAllowedDistanceToGrind, ClosestPoint) != INDEX_NONE;
+}
+
+void AGrindRailSet::OnGrindingStarted(ACharacter* Character)
+{
+	if (!ensure(Character))
+	{
+		return;
+	}
+
+	FGrindRailPoint ClosestPoint;
+	const int32 RailIndex = FindClosestRailPoint(Character->GetMesh()->GetComponentLocation(), MaxAllowedDistanceToGrind, ClosestPoint);
+	if (RailIndex == INDEX_NONE)
+	{
+		EndGrinding(Character);
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_Skating_GrindSnaps);
+
+	FGrindRailState& RailState = GrindingCharacters.Add(Character);
+	RailState.RailIndex = RailIndex;
+	RailState.Distance = ClosestPoint.Distance;
+	RailState.bYawInversed = ClosestPoint.Direction.Dot(Character->GetActorForwardVector()) < 0.f;
+	RailState.TargetDistance = RailState.bYawInversed ? 0.f : Rails[RailIndex].GetLength();
+
+	MoveCharacterToRail(Character, RailState);
+}
+
+void AGrindRailSet::OnGrindingEnded(ACharacter* Character)
+{
+	GrindingCharacters.Remove(Character);
+}
+
+void AGrindRailSet::UpdateGrinding(ACharacter* Character, const float DeltaSeconds)
+{
+	FGrindRailState* RailState = GrindingCharacters.Find(Character);
+	if (!ensure(RailState))
+	{
+		return;
+	}
+
+	RailState->Distance = FMath::FInterpConstantTo(RailState->Distance, RailState->TargetDistance, DeltaSeconds, GrindingSpeed);
+	if (RailState->Distance != RailState->TargetDistance)
+	{
+		MoveCharacterToRail(Character, *RailState);
+	}
+	else
+	{
+		EndGrinding(Character);
+	}
+}
+
+float AGrindRailSet::GetGrindingDistance(const ACharacter* Character) const
+{
+	const FGrindRailState* RailState = GrindingCharacters.Find(Character);
+	return RailState ? RailState->Distance : 0.f;
+}
+
+void AGrindRailSet::SetGrindingDistance(ACharacter* Character, const float Distance)
+{
+	if (FGrindRailState* RailState = GrindingCharacters.Find(Character))
+	{
+		RailState->Distance = FMath::Clamp(Distance, 0.f, Rails[RailState->RailIndex].GetLength());
+	}
+}
+
+void AGrindRailSet::MoveCharacterToRail(ACharacter* Character, const FGrindRailState& RailState) const
+{
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_MoveCharacterAlongSpline);
+
+	const FGrindRailPoint RailPoint = Rails[RailState.RailIndex].GetPointAtDistance(RailState.Distance);
+
+	const float CapsuleScaledHalfHeight = Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	const FVector TargetLocation = RailPoint.Location + FVector(0.f, 0.f, CapsuleScaledHalfHeight);
+
+	FRotator TargetRotation = RailPoint.Direction.Rotation();
+	if (RailState.bYawInversed)
+	{
+		TargetRotation.Yaw += 180.f;
+	}
+
+	Character->SetActorLocationAndRotation(TargetLocation, TargetRotation);
+}
+
+void AGrindRailSet::EndGrinding(ACharacter* Character) const
+{
+	Character->GetCharacterMovement()->SetMovementMode(MOVE_Falling, 0);
+}
@@ -0,0 +1,178 @@
+// Copyright Amr Hamed
+
+
+#include "Obstacles/GrindableSubsystem.h"
+#include "Obstacles/GrindingSplineComponent.h"
+
+bool UGrindableSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGrindableSubsystem::RegisterGrindableSpline(UGrindingSplineComponent* Spline)
+{
+	if (!ensure(Spline))
+	{
+		return;
+	}
+
+	const FGrindRailSamples& RailSamples = Spline->GetRailSamples();
+	const FTransform& SplineTransform = Spline->GetComponentTransform();
+
+	for (int32 SampleIndex = 1; SampleIndex < RailSamples.Num(); ++SampleIndex)
+	{
+		AddSegment(Spline,
+			SplineTransform.TransformPosition(RailSamples.Positions[SampleIndex - 1]),
+			SplineTransform.TransformPosition(RailSamples.Positions[SampleIndex]));
+	}
+}
+
+void UGrindableSubsystem::RegisterGrindableRails(UObject* Grindable, TConstArrayView<FGrindRailSamples> Rails)
+{
+	if (!ensure(Grindable))
+	{
+		return;
+	}
+
+	for (const FGrindRailSamples& Rail : Rails)
+	{
+		for (int32 SampleIndex = 1; SampleIndex < Rail.Num(); ++SampleIndex)
+		{
+			AddSegment(Grindable, Rail.Positions[SampleIndex - 1], Rail.Positions[SampleIndex]);
+		}
+	}
+}
+
+void UGrindableSubsystem::UnregisterGrindable(UObject* Grindable)
+{
+	TArray<int32> SegmentIndices;
+	if (!GrindableSegments.RemoveAndCopyValue(Grindable, SegmentIndices))
+	{
+		return;
+	}
+
+	for (const int32 SegmentIndex : SegmentIndices)
+	{
+		RemoveSegmentFromGrid(SegmentIndex);
+		Segments.RemoveAt(SegmentIndex);
+	}
+}
+
+UObject* UGrindableSubsystem::FindClosestGrindable(const FVector& Start, const FVector& End, const float Radius) const
+{
+	const FBox QueryBounds = FBox(Start.ComponentMin(End), Start.ComponentMax(End)).ExpandBy(Radius);
+	const FIntVector MinCell = GetCellCoordinates(QueryBounds.Min);
+	const FIntVector MaxCell = GetCellCoordinates(QueryBounds.Max);
+
+	++CurrentQueryStamp;
+
+	UObject* ClosestGrindable = nullptr;
+	float ClosestDistanceSquared = FMath::Square(Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<int32>* CellSegments = Cells.Find(FIntVector(X, Y, Z));
+				if (!CellSegments)
+				{
+					continue;
+				}
+
+				for (const int32 SegmentIndex : *CellSegments)
+				{
+					const FGrindableSegment& Segment = Segments[SegmentIndex];
+					if (Segment.QueryStamp == CurrentQueryStamp)
+					{
+						continue;
+					}
+
+					Segment.QueryStamp = CurrentQueryStamp;
+
+					FVector ClosestOnQuery;
+					FVector ClosestOnSegment;
+					FMath::SegmentDistToSegmentSafe(Start, End, Segment.Start, Segment.End, ClosestOnQuery, ClosestOnSegment);
+
+					const float DistanceSquared = FVector::DistSquared(ClosestOnQuery, ClosestOnSegment);
+					if (DistanceSquared <= ClosestDistanceSquared && Segment.Grindable.IsValid())
+					{
+						ClosestDistanceSquared = DistanceSquared;
+						ClosestGrindable = Segment.Grindable.Get();
+					}
+				}
+			}
+		}
+	}
+
+	return ClosestGrindable;
+}
+
+void UGrindableSubsystem::AddSegment(UObject* Grindable, const FVector& Start, const FVector& End)
+{
+	FGrindableSegment Segment;
+	Segment.Grindable = Grindable;
+	Segment.Start = Start;
+	Segment.End = End;
+
+	const int32 SegmentIndex = Segments.Add(MoveTemp(Segment));
+	GrindableSegments.FindOrAdd(Grindable).Add(SegmentIndex);
+
+	AddSegmentToGrid(SegmentIndex);
+}
+
+void UGrindableSubsystem::AddSegmentToGrid(const int32 SegmentIndex)
+{
+	const FGrindableSegment& Segment = Segments[SegmentIndex];
+	const FIntVector MinCell = GetCellCoordinates(Segment.Start.ComponentMin(Segment.End));
+	const FIntVector MaxCell = GetCellCoordinates(Segment.Start.ComponentMax(Segment.End));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(SegmentIndex);
+			}
+		}
+	}
+}
+
+void UGrindableSubsystem::RemoveSegmentFromGrid(const int32 SegmentIndex)
+{
+	const FGrindableSegment& Segment = Segments[SegmentIndex];
+	const FIntVector MinCell = GetCellCoordinates(Segment.Start.ComponentMin(Segment.End));
+	const FIntVector MaxCell = GetCellCoordinates(Segment.Start.ComponentMax(Segment.End));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const FIntVector Cell(X, Y, Z);
+				TArray<int32>* CellSegments = Cells.Find(Cell);
+				if (!CellSegments)
+				{
+					continue;
+				}
+
+				CellSegments->RemoveSingleSwap(SegmentIndex, EAllowShrinking::No);
+				if (CellSegments->IsEmpty())
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+}
+
+FIntVector UGrindableSubsystem::GetCellCoordinates(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / GridCellSize),
+		FMath::FloorToInt32(Location.Y / GridCellSize),
+		FMath::FloorToInt32(Location.Z / GridCellSize));
+}
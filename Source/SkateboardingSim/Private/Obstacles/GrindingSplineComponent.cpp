@@ -5,12 +5,48 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Core/SkatingStats.h"
+#include "Obstacles/GrindableSubsystem.h"
 
 UGrindingSplineComponent::UGrindingSplineComponent()
 {
 	PrimaryComponentTick.bCanEverTick = false;
 }
 
+void UGrindingSplineComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	RailSamples.BakeFromSpline(*this, RailSampleSpacing);
+}
+
+void UGrindingSplineComponent::UpdateSpline()
+{
+	Super::UpdateSpline();
+
+	RailSamples.BakeFromSpline(*this, RailSampleSpacing);
+}
+
+void UGrindingSplineComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UGrindableSubsystem* GrindableSubsystem = UWorld::GetSubsystem<UGrindableSubsystem>(GetWorld()))
+	{
+		GrindableSubsystem->RegisterGrindableSpline(this);
+	}
+}
+
+void UGrindingSplineComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGrindableSubsystem* GrindableSubsystem = UWorld::GetSubsystem<UGrindableSubsystem>(GetWorld()))
+	{
+		GrindableSubsystem->UnregisterGrindable(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void UGrindingSplineComponent::OnGrindingStarted(ACharacter* Character)
 {
 	if (!ensure(Character)) 
@@ -46,15 +82,18 @@ bool UGrindingSplineComponent::IsGrindable(ACharacter* Character) const
 	if (Character && GetSplineLength() > MinGrindablePathLength) 
 	{
 		const FVector CharacterLocation = Character->GetActorLocation();
-		return FVector::Dist(CharacterLocation, FindClosestSplineTransform(CharacterLocation).GetLocation()) < MaxAllowedDistanceToGrind;
+
+		FGrindRailPoint ClosestPoint;
+		return FindClosestRailPoint(CharacterLocation, ClosestPoint)
+			&& FVector::Dist(CharacterLocation, ClosestPoint.Location) < MaxAllowedDistanceToGrind;
 	}
 	
 	return false;
 }
 
-void UGrindingSplineComponent::UpdateGrinding(const float DeltaSeconds)
+void UGrindingSplineComponent::UpdateGrinding(ACharacter* Character, const float DeltaSeconds)
 {
-	if (!ensure(GrindingCharacter.IsSet())) 
+	if (!ensure(GrindingCharacter.IsSet() && GrindingCharacter.GetValue() == Character)) 
 	{
 		return;
 	}
@@ -77,8 +116,23 @@ void UGrindingSplineComponent::UpdateGrinding(const float DeltaSeconds)
 	}
 }
 
+float UGrindingSplineComponent::GetGrindingDistance(const ACharacter* Character) const
+{
+	return GrindingCharacter.IsSet() && GrindingCharacter.GetValue() == Character ? CurrentDistanceAlongSpline : 0.f;
+}
+
+void UGrindingSplineComponent::SetGrindingDistance(ACharacter* Character, const float Distance)
+{
+	if (GrindingCharacter.IsSet() && GrindingCharacter.GetValue() == Character)
+	{
+		CurrentDistanceAlongSpline = FMath::Clamp(Distance, 0.f, GetSplineLength());
+	}
+}
+
 void UGrindingSplineComponent::MoveCharacterToTransformAtCurrentDistance()
 {
+	SKATING_SCOPE_CYCLE_COUNTER(STAT_Skating_MoveCharacterAlongSpline);
+
 	if (!ensure(GrindingCharacter.IsSet())) 
 	{
 		return;
@@ -100,7 +154,10 @@ void UGrindingSplineComponent::MoveCharacterToTransformAtCurrentDistance()
 
 void UGrindingSplineComponent::DetermineGrindingDirection(const FVector& Location, const FVector& Direction)
 {
-	bYawInversed = FindDirectionClosestToWorldLocation(Location, ESplineCoordinateSpace::World).Dot(Direction) < 0.f;
+	FGrindRailPoint ClosestPoint;
+	FindClosestRailPoint(Location, ClosestPoint);
+
+	bYawInversed = ClosestPoint.Direction.Dot(Direction) < 0.f;
 	TargetDistanceAlongSpline = bYawInversed ? 0.f : GetSplineLength();
 }
 
@@ -112,19 +169,40 @@ bool UGrindingSplineComponent::TrySnapCharacterToClosestSplineLocation()
 	}
 
 	const FVector MeshLocation = GrindingCharacter.GetValue()->GetMesh()->GetComponentLocation();
-	const FVector ClosestSplineLocation = FindClosestSplineTransform(MeshLocation).GetLocation();
-	
-	if (FVector::Dist(MeshLocation, ClosestSplineLocation) > MaxAllowedDistanceToGrind) 
+
+	FGrindRailPoint ClosestPoint;
+	if (!FindClosestRailPoint(MeshLocation, ClosestPoint) || FVector::Dist(MeshLocation, ClosestPoint.Location) > MaxAllowedDistanceToGrind) 
 	{
 		return false;
 	}
 
-	CurrentDistanceAlongSpline = GetDistanceAlongSplineAtLocation(ClosestSplineLocation, ESplineCoordinateSpace::World);
+	INC_DWORD_STAT(STAT_Skating_GrindSnaps);
+
+	CurrentDistanceAlongSpline = ClosestPoint.Distance;
 	MoveCharacterToTransformAtCurrentDistance();
 	return true;
 }
 
 FTransform UGrindingSplineComponent::FindClosestSplineTransform(const FVector& WorldLocation) const
 {
+	FGrindRailPoint ClosestPoint;
+	if (FindClosestRailPoint(WorldLocation, ClosestPoint))
+	{
+		return FTransform(ClosestPoint.Direction.Rotation(), ClosestPoint.Location);
+	}
+
 	return FindTransformClosestToWorldLocation(WorldLocation, ESplineCoordinateSpace::World);
+}
+
+bool UGrindingSplineComponent::FindClosestRailPoint(const FVector& WorldLocation, FGrindRailPoint& OutPoint) const
+{
+	const FTransform& ComponentTransform = GetComponentTransform();
+	if (!RailSamples.FindClosestPoint(ComponentTransform.InverseTransformPosition(WorldLocation), OutPoint))
+	{
+		return false;
+	}
+
+	OutPoint.Location = ComponentTransform.TransformPosition(OutPoint.Location);
+	OutPoint.Direction = ComponentTransform.TransformVectorNoScale(OutPoint.Direction);
+	return true;
 }
\ No newline at end of file
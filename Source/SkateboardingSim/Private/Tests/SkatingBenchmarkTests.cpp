@@ -0,0 +1,178 @@
+// Copyright Amr Hamed
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Core/SkatingGameMode.h"
+#include "Core/SkatingMemory.h"
+#include "Core/SkatingPerfScenarios.h"
+#include "Misc/App.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+#include "Tests/SkatingTestHelpers.h"
+
+/**
+ * Perf scenarios played in PIE, headless with e.g.
+ * UnrealEditor-Cmd SkateboardingSim.uproject -ExecCmds="Automation RunTests SkateboardingSim.Benchmark; Quit" -nullrhi -unattended -SkateCountAllocations
+ * Maps without tagged Player Starts get the benchmark course, so any map using the skating game mode works.
+ * Scenarios with an allocation limit in the baseline need -SkateCountAllocations, allocations aren't counted without it.
+ */
+namespace SkatingBenchmarkTests
+{
+	const TCHAR* MapName = TEXT("/Game/SkateboardingSim/Maps/ThirdPersonMap");
+
+	/** Scenarios step at a fixed 60 Hz, like the -SkateBenchmark runs the baseline is recorded from */
+	constexpr float StepSeconds = 1.f / 60.f;
+
+	/** Time the PIE world gets to start its game mode */
+	constexpr double StartTimeoutSeconds = 20.0;
+
+	/** Editors slower than the fixed step play scenarios slower than real time */
+	constexpr double PlaybackTimeoutScale = 4.0;
+}
+
+/** Plays a single perf scenario through the game mode and checks it did what it measures */
+class FSkatingRunBenchmarkScenarioCommand : public IAutomationLatentCommand
+{
+public:
+	FSkatingRunBenchmarkScenarioCommand(FAutomationTestBase* InTest, const SkatingPerfScenarios::FScenario& InScenario)
+		: Test(InTest)
+		, Scenario(InScenario)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		using namespace SkatingBenchmarkTests;
+
+		ASkatingGameMode* GameMode = SkatingTestHelpers::FindPIEGameMode();
+		if (!GameMode)
+		{
+			if (!bStarted && GetCurrentRunTime() < StartTimeoutSeconds)
+			{
+				return false;
+			}
+
+			Test->AddError(TEXT("PIE world has no Skating Game Mode"));
+			return true;
+		}
+
+		if (!bStarted)
+		{
+			bStarted = true;
+			GameMode->StartBenchmark(MakeArrayView(&Scenario.Name, 1));
+		}
+
+		if (GameMode->IsBenchmarkRunning())
+		{
+			if (GetCurrentRunTime() < StartTimeoutSeconds + Scenario.Recording.Frames.Num() * StepSeconds * PlaybackTimeoutScale)
+			{
+				return false;
+			}
+
+			Test->AddError(FString::Printf(TEXT("%s didn't finish in time"), *Scenario.Name.ToString()));
+			return true;
+		}
+
+		const TConstArrayView<FSkatingPerfScenarioMetrics> Results = GameMode->GetBenchmarkResults();
+		if (!Test->TestEqual(TEXT("Scenario results"), Results.Num(), 1))
+		{
+			return true;
+		}
+
+		const FSkatingPerfScenarioMetrics& Result = Results[0];
+		Test->TestEqual(TEXT("Played back frames"), Result.NumFrames, Scenario.Recording.Frames.Num());
+
+		if (Scenario.bRequiresGrinding)
+		{
+			Test->TestTrue(TEXT("Skater grinded"), Result.GrindingFrames > 0);
+		}
+
+		// Steady state skating past the warmup mustn't touch the heap
+		FSkatingPerfBaseline Baseline;
+		const FSkatingPerfScenarioMetrics* BaselineMetrics = Baseline.LoadFromFile(SkatingPerfScenarios::GetDefaultBaselineFilename()) ? Baseline.FindScenario(Result.Name) : nullptr;
+		if (BaselineMetrics && BaselineMetrics->MaxAllocationsPerFrame >= 0.f)
+		{
+			if (SkatingMemory::IsAllocationCounterInstalled())
+			{
+				Test->TestTrue(FString::Printf(TEXT("Allocations per frame %.3f within %.3f"), Result.AllocationsPerFrame, BaselineMetrics->MaxAllocationsPerFrame),
+					Result.AllocationsPerFrame <= BaselineMetrics->MaxAllocationsPerFrame);
+			}
+			else
+			{
+				Test->AddError(TEXT("Allocations aren't counted, run with -SkateCountAllocations"));
+			}
+		}
+
+		Test->AddInfo(FString::Printf(TEXT("%s: GameThreadMs=%.3f, PhysicsQueriesPerFrame=%.3f, AllocationsPerFrame=%.3f, GrindingFrames=%d"),
+			*Result.Name, Result.GameThreadMs, Result.PhysicsQueriesPerFrame, Result.AllocationsPerFrame, Result.GrindingFrames));
+
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+
+	SkatingPerfScenarios::FScenario Scenario;
+
+	bool bStarted = false;
+};
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FSkatingBenchmarkScenarioTest, "SkateboardingSim.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+void FSkatingBenchmarkScenarioTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const SkatingPerfScenarios::FScenario& Scenario : SkatingPerfScenarios::BuildScenarios(SkatingBenchmarkTests::StepSeconds))
+	{
+		OutBeautifiedNames.Add(Scenario.Name.ToString());
+		OutTestCommands.Add(Scenario.Name.ToString());
+	}
+}
+
+bool FSkatingBenchmarkScenarioTest::RunTest(const FString& Parameters)
+{
+	const FName ScenarioName(*Parameters);
+	const TArray<SkatingPerfScenarios::FScenario> Scenarios = SkatingPerfScenarios::BuildScenarios(SkatingBenchmarkTests::StepSeconds);
+	const SkatingPerfScenarios::FScenario* Scenario = Scenarios.FindByPredicate([ScenarioName](const SkatingPerfScenarios::FScenario& Candidate) { return Candidate.Name == ScenarioName; });
+	if (!Scenario)
+	{
+		AddError(FString::Printf(TEXT("Unknown benchmark scenario %s"), *Parameters));
+		return false;
+	}
+
+	ULevelEditorPlaySettings* PlaySettings = GetMutableDefault<ULevelEditorPlaySettings>();
+
+	EPlayNetMode OldPlayNetMode;
+	PlaySettings->GetPlayNetMode(OldPlayNetMode);
+	int32 OldNumberOfClients;
+	PlaySettings->GetPlayNumberOfClients(OldNumberOfClients);
+
+	PlaySettings->SetPlayNetMode(PIE_Standalone);
+	PlaySettings->SetPlayNumberOfClients(1);
+
+	const bool bOldUseFixedTimeStep = FApp::UseFixedTimeStep();
+	const double OldFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(SkatingBenchmarkTests::StepSeconds);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FEditorLoadMap(SkatingBenchmarkTests::MapName));
+	ADD_LATENT_AUTOMATION_COMMAND(FStartPIECommand(false));
+	ADD_LATENT_AUTOMATION_COMMAND(FSkatingRunBenchmarkScenarioCommand(this, *Scenario));
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([PlaySettings, OldPlayNetMode, OldNumberOfClients, bOldUseFixedTimeStep, OldFixedDeltaTime]()
+		{
+			PlaySettings->SetPlayNetMode(OldPlayNetMode);
+			PlaySettings->SetPlayNumberOfClients(OldNumberOfClients);
+			FApp::SetUseFixedTimeStep(bOldUseFixedTimeStep);
+			FApp::SetFixedDeltaTime(OldFixedDeltaTime);
+			return true;
+		}));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,443 @@
+// Copyright Amr Hamed
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Core/SkaterCharacter.h"
+#include "Core/SkatingQuantization.h"
+#include "Engine/Engine.h"
+#include "EngineUtils.h"
+#include "Movement/SkatingMovementComponent.h"
+#include "Obstacles/GrindRailSet.h"
+#include "Obstacles/GrindingSplineComponent.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+
+namespace SkatingNetworkTests
+{
+	const TCHAR* MapName = TEXT("/Game/SkateboardingSim/Maps/ThirdPersonMap");
+
+	/** Time both PIE worlds get to spawn their skaters */
+	constexpr double SpawnTimeoutSeconds = 20.0;
+
+	/** Time the client keeps speeding up and slowing down, then the time corrections get to arrive */
+	constexpr double DriveSeconds = 6.0;
+	constexpr double SettleSeconds = 1.0;
+
+	/** Time the client gets to ollie onto the rail, then the time both sides grind before the client is put out of sync */
+	constexpr double GrindStartTimeoutSeconds = 2.0;
+	constexpr double GrindSeconds = 0.5;
+
+	/** Client grinding distance offset, well past GrindingDistanceNetTolerance */
+	constexpr float GrindingDistanceDesync = 500.f;
+
+	/** The client runs the moves in flight ahead of the server, about a frame or two of grinding */
+	constexpr float GrindingDistanceTolerance = 50.f;
+
+	/** Rail laid from just behind the client's skater along its forward */
+	const FName RailName = TEXT("SkatingNetworkTestRail");
+	constexpr float RailLengthBehind = 100.f;
+	constexpr float RailLength = 3000.f;
+
+	/** Skater the listen server simulates for the remote client, and that client's own skater */
+	bool FindRemoteSkater(USkatingMovementComponent*& OutServerMovement, USkatingMovementComponent*& OutClientMovement)
+	{
+		OutServerMovement = nullptr;
+		OutClientMovement = nullptr;
+
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (!World || Context.WorldType != EWorldType::PIE)
+			{
+				continue;
+			}
+
+			const ENetMode NetMode = World->GetNetMode();
+			for (TActorIterator<ASkaterCharacter> It(World); It; ++It)
+			{
+				USkatingMovementComponent* MovementComponent = It->FindComponentByClass<USkatingMovementComponent>();
+				if (NetMode == NM_ListenServer && It->GetController() && !It->IsLocallyControlled())
+				{
+					OutServerMovement = MovementComponent;
+				}
+				else if (NetMode == NM_Client && It->IsLocallyControlled())
+				{
+					OutClientMovement = MovementComponent;
+				}
+			}
+		}
+
+		return OutServerMovement && OutClientMovement;
+	}
+
+	/** Ollie alpha only changes through charging, which the server replays from the client's moves, so tests set it directly */
+	void SetOllyingAlpha(USkatingMovementComponent* MovementComponent, const float Alpha)
+	{
+		const FFloatProperty* Property = FindFProperty<FFloatProperty>(USkatingMovementComponent::StaticClass(), TEXT("OllyingAlpha"));
+		if (ensure(Property))
+		{
+			Property->SetPropertyValue_InContainer(MovementComponent, Alpha);
+		}
+	}
+
+	/** Spawns the same rail in World, net addressable by its name like a rail placed in the map */
+	AGrindRailSet* SpawnRail(UWorld* World, TConstArrayView<FVector> Points)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.Name = RailName;
+		SpawnParameters.bDeferConstruction = true;
+
+		AGrindRailSet* RailSet = World->SpawnActor<AGrindRailSet>(SpawnParameters);
+		if (!RailSet)
+		{
+			return nullptr;
+		}
+
+		RailSet->SetNetAddressable();
+		RailSet->FinishSpawning(FTransform::Identity);
+		RailSet->AddRail(Points);
+		return RailSet;
+	}
+
+	/** Plays the map as a listen server with a remote client in this editor process and runs Command in it */
+	void RunOnListenServer(const TSharedRef<IAutomationLatentCommand>& Command)
+	{
+		ULevelEditorPlaySettings* PlaySettings = GetMutableDefault<ULevelEditorPlaySettings>();
+
+		EPlayNetMode OldPlayNetMode;
+		PlaySettings->GetPlayNetMode(OldPlayNetMode);
+		int32 OldNumberOfClients;
+		PlaySettings->GetPlayNumberOfClients(OldNumberOfClients);
+		bool bOldRunUnderOneProcess;
+		PlaySettings->GetRunUnderOneProcess(bOldRunUnderOneProcess);
+
+		PlaySettings->SetPlayNetMode(PIE_ListenServer);
+		PlaySettings->SetPlayNumberOfClients(2);
+		PlaySettings->SetRunUnderOneProcess(true);
+
+		ADD_LATENT_AUTOMATION_COMMAND(FEditorLoadMap(MapName));
+		ADD_LATENT_AUTOMATION_COMMAND(FStartPIECommand(false));
+		FAutomationTestFramework::Get().EnqueueLatentCommand(Command);
+		ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([PlaySettings, OldPlayNetMode, OldNumberOfClients, bOldRunUnderOneProcess]()
+			{
+				PlaySettings->SetPlayNetMode(OldPlayNetMode);
+				PlaySettings->SetPlayNumberOfClients(OldNumberOfClients);
+				PlaySettings->SetRunUnderOneProcess(bOldRunUnderOneProcess);
+				return true;
+			}));
+	}
+}
+
+/** Drives the client's speed scale and checks the server never has to correct it */
+class FSkatingDriveSpeedScaleCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FSkatingDriveSpeedScaleCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		using namespace SkatingNetworkTests;
+
+		USkatingMovementComponent* ServerMovement = nullptr;
+		USkatingMovementComponent* ClientMovement = nullptr;
+		if (!FindRemoteSkater(ServerMovement, ClientMovement))
+		{
+			if (DriveStartSeconds < 0.0 && GetCurrentRunTime() < SpawnTimeoutSeconds)
+			{
+				return false;
+			}
+
+			Test->AddError(TEXT("Listen server and client skaters not found"));
+			return true;
+		}
+
+		if (DriveStartSeconds < 0.0)
+		{
+			DriveStartSeconds = GetCurrentRunTime();
+			StartCorrections = ClientMovement->GetNumClientCorrections();
+		}
+
+		const double DriveTime = GetCurrentRunTime() - DriveStartSeconds;
+		if (DriveTime < DriveSeconds)
+		{
+			// Full speed every second then slowing down by less than a quantization step each frame, like held input
+			const int32 Second = FMath::FloorToInt32(DriveTime);
+			if (Second != LastSpeedUpSecond)
+			{
+				LastSpeedUpSecond = Second;
+				ClientMovement->SpeedUp();
+				ClientMovement->SpeedUp();
+			}
+			else
+			{
+				ClientMovement->SlowDown();
+			}
+
+			return false;
+		}
+
+		if (DriveTime < DriveSeconds + SettleSeconds)
+		{
+			return false;
+		}
+
+		Test->TestEqual(TEXT("Client corrections while changing speed"), ClientMovement->GetNumClientCorrections(), StartCorrections);
+		Test->TestEqual(TEXT("Server speed scale"), ServerMovement->GetSpeedScale(), ClientMovement->GetSpeedScale());
+
+		Test->AddInfo(FString::Printf(TEXT("Move bandwidth per skater: %d bits/s to the server, %d bits/s to the client"),
+			ServerMovement->GetNetBitsPerSecond(), ClientMovement->GetNetBitsPerSecond()));
+
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+
+	double DriveStartSeconds = -1.0;
+	int32 LastSpeedUpSecond = INDEX_NONE;
+	int32 StartCorrections = 0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSkatingListenServerSpeedScaleTest, "SkateboardingSim.Network.ListenServerSpeedScale",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSkatingListenServerSpeedScaleTest::RunTest(const FString& Parameters)
+{
+	SkatingNetworkTests::RunOnListenServer(MakeShared<FSkatingDriveSpeedScaleCommand>(this));
+	return true;
+}
+
+/** Puts the client's ollie alpha out of sync and checks the correction brings it back to the server's */
+class FSkatingCorrectOllyingAlphaCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FSkatingCorrectOllyingAlphaCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		using namespace SkatingNetworkTests;
+
+		USkatingMovementComponent* ServerMovement = nullptr;
+		USkatingMovementComponent* ClientMovement = nullptr;
+		if (!FindRemoteSkater(ServerMovement, ClientMovement))
+		{
+			if (DesyncSeconds < 0.0 && GetCurrentRunTime() < SpawnTimeoutSeconds)
+			{
+				return false;
+			}
+
+			Test->AddError(TEXT("Listen server and client skaters not found"));
+			return true;
+		}
+
+		if (DesyncSeconds < 0.0)
+		{
+			// Landing resets ollie alpha on its own, so wait for skaters spawned in the air to land
+			if (!ServerMovement->IsMovingOnGround() || !ClientMovement->IsMovingOnGround())
+			{
+				if (GetCurrentRunTime() < SpawnTimeoutSeconds)
+				{
+					return false;
+				}
+
+				Test->AddError(TEXT("Skaters didn't land"));
+				return true;
+			}
+
+			DesyncSeconds = GetCurrentRunTime();
+			StartCorrections = ClientMovement->GetNumClientCorrections();
+
+			const float ServerOllyingAlpha = ServerMovement->GetOllyingAlpha();
+			SetOllyingAlpha(ClientMovement, ServerOllyingAlpha < 0.5f ? ServerOllyingAlpha + 0.5f : ServerOllyingAlpha - 0.5f);
+			return false;
+		}
+
+		if (GetCurrentRunTime() - DesyncSeconds < SettleSeconds)
+		{
+			return false;
+		}
+
+		Test->TestTrue(TEXT("Client corrected"), ClientMovement->GetNumClientCorrections() > StartCorrections);
+		Test->TestEqual(TEXT("Client ollie alpha"), ClientMovement->GetOllyingAlpha(), ServerMovement->GetOllyingAlpha(), SkatingQuantization::DequantizeUnitFloat8(1));
+
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+
+	double DesyncSeconds = -1.0;
+	int32 StartCorrections = 0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSkatingListenServerOllyingAlphaCorrectionTest, "SkateboardingSim.Network.ListenServerOllyingAlphaCorrection",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSkatingListenServerOllyingAlphaCorrectionTest::RunTest(const FString& Parameters)
+{
+	SkatingNetworkTests::RunOnListenServer(MakeShared<FSkatingCorrectOllyingAlphaCommand>(this));
+	return true;
+}
+
+/** Ollies the client onto a rail, puts its grinding distance out of sync and checks the correction brings it back to the server's */
+class FSkatingCorrectGrindingDistanceCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FSkatingCorrectGrindingDistanceCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		using namespace SkatingNetworkTests;
+
+		USkatingMovementComponent* ServerMovement = nullptr;
+		USkatingMovementComponent* ClientMovement = nullptr;
+		if (!FindRemoteSkater(ServerMovement, ClientMovement))
+		{
+			if (Stage == EStage::Spawning && GetCurrentRunTime() < SpawnTimeoutSeconds)
+			{
+				return false;
+			}
+
+			Test->AddError(TEXT("Listen server and client skaters not found"));
+			return true;
+		}
+
+		ACharacter* ClientSkater = ClientMovement->GetCharacterOwner();
+		const double StageTime = GetCurrentRunTime() - StageStartSeconds;
+
+		switch (Stage)
+		{
+		case EStage::Spawning:
+		{
+			if (!ServerMovement->IsMovingOnGround() || !ClientMovement->IsMovingOnGround())
+			{
+				if (GetCurrentRunTime() < SpawnTimeoutSeconds)
+				{
+					return false;
+				}
+
+				Test->AddError(TEXT("Skaters didn't land"));
+				return true;
+			}
+
+			// Both worlds get the rail the server sees under the skater, so they resolve it to the same name
+			const ACharacter* ServerSkater = ServerMovement->GetCharacterOwner();
+			const FVector Feet = ServerSkater->GetMesh()->GetComponentLocation();
+			const FVector Forward = ServerSkater->GetActorForwardVector();
+			const FVector RailPoints[] = { Feet - Forward * RailLengthBehind, Feet + Forward * RailLength };
+
+			if (!SpawnRail(ServerMovement->GetWorld(), RailPoints) || !SpawnRail(ClientMovement->GetWorld(), RailPoints))
+			{
+				Test->AddError(TEXT("Failed to spawn the rail"));
+				return true;
+			}
+
+			ClientSkater->Jump();
+			SetStage(EStage::Ollying);
+			return false;
+		}
+
+		case EStage::Ollying:
+			// Held grind input, the server starts grinding from the client's moves
+			ClientMovement->TryGrinding();
+			if (ClientMovement->IsGrinding() && ServerMovement->IsGrinding())
+			{
+				SetStage(EStage::Grinding);
+				return false;
+			}
+
+			if (StageTime < GrindStartTimeoutSeconds)
+			{
+				return false;
+			}
+
+			Test->AddError(FString::Printf(TEXT("Skaters didn't start grinding, client %d server %d"), ClientMovement->IsGrinding(), ServerMovement->IsGrinding()));
+			return true;
+
+		case EStage::Grinding:
+			if (StageTime < GrindSeconds)
+			{
+				return false;
+			}
+
+			if (IGrindable* Grindable = Cast<IGrindable>(ClientMovement->GetCurrentGrindable()))
+			{
+				StartCorrections = ClientMovement->GetNumClientCorrections();
+				Grindable->SetGrindingDistance(ClientSkater, ClientMovement->GetGrindingDistance() + GrindingDistanceDesync);
+				SetStage(EStage::Desynced);
+				return false;
+			}
+
+			Test->AddError(TEXT("Client stopped grinding before it was put out of sync"));
+			return true;
+
+		case EStage::Desynced:
+			if (StageTime < SettleSeconds)
+			{
+				return false;
+			}
+
+			break;
+		}
+
+		Test->TestTrue(TEXT("Client corrected"), ClientMovement->GetNumClientCorrections() > StartCorrections);
+
+		const UObject* ServerGrindable = ServerMovement->GetCurrentGrindable();
+		const UObject* ClientGrindable = ClientMovement->GetCurrentGrindable();
+		if (Test->TestTrue(TEXT("Server grinding"), ServerGrindable != nullptr) && Test->TestTrue(TEXT("Client grinding"), ClientGrindable != nullptr))
+		{
+			Test->TestEqual(TEXT("Client grindable"), ClientGrindable->GetFName(), ServerGrindable->GetFName());
+			Test->TestEqual(TEXT("Client grinding distance"), ClientMovement->GetGrindingDistance(), ServerMovement->GetGrindingDistance(), GrindingDistanceTolerance);
+		}
+
+		return true;
+	}
+
+private:
+	enum class EStage : uint8
+	{
+		Spawning,
+		Ollying,
+		Grinding,
+		Desynced
+	};
+
+	void SetStage(const EStage NewStage)
+	{
+		Stage = NewStage;
+		StageStartSeconds = GetCurrentRunTime();
+	}
+
+private:
+	FAutomationTestBase* Test;
+
+	EStage Stage = EStage::Spawning;
+	double StageStartSeconds = 0.0;
+	int32 StartCorrections = 0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSkatingListenServerGrindingCorrectionTest, "SkateboardingSim.Network.ListenServerGrindingCorrection",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSkatingListenServerGrindingCorrectionTest::RunTest(const FString& Parameters)
+{
+	SkatingNetworkTests::RunOnListenServer(MakeShared<FSkatingCorrectGrindingDistanceCommand>(this));
+	return true;
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright Amr Hamed
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Core/SkaterInputRecording.h"
+#include "Core/SkatingGameMode.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+#include "Tests/SkatingTestHelpers.h"
+
+namespace SkatingReplayTests
+{
+	const TCHAR* MapName = TEXT("/Game/SkateboardingSim/Maps/L_Park_01");
+
+	/** Scripted pushes, weaves, random flips and grind attempts at 60 Hz, starting at the park's Player Start */
+	FString GetRecordingFilename()
+	{
+		return FPaths::Combine(FPaths::ProjectConfigDir(), TEXT("Benchmarks"), TEXT("L_Park_01.skrec"));
+	}
+
+	/** Time the PIE world gets to start its game mode */
+	constexpr double StartTimeoutSeconds = 20.0;
+
+	/** Editors slower than the fixed step play the recording slower than real time */
+	constexpr double PlaybackTimeoutScale = 4.0;
+
+	/** Time for the previous PIE session to end before starting the next one */
+	constexpr float EndPlaySeconds = 1.f;
+}
+
+/** Plays the recording back once in the current PIE session and stores the final skater checksum */
+class FSkatingPlayRecordingCommand : public IAutomationLatentCommand
+{
+public:
+	FSkatingPlayRecordingCommand(FAutomationTestBase* InTest, const FSkaterInputRecording& InRecording, TSharedRef<TArray<uint32>> InChecksums)
+		: Test(InTest)
+		, Recording(InRecording)
+		, Checksums(InChecksums)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		using namespace SkatingReplayTests;
+
+		ASkatingGameMode* GameMode = SkatingTestHelpers::FindPIEGameMode();
+		if (!GameMode)
+		{
+			if (!bStarted && GetCurrentRunTime() < StartTimeoutSeconds)
+			{
+				return false;
+			}
+
+			Test->AddError(TEXT("PIE world has no Skating Game Mode"));
+			return true;
+		}
+
+		if (!bStarted)
+		{
+			bStarted = true;
+
+			TActorIterator<APlayerStart> PlayerStart(GameMode->GetWorld());
+			if (!PlayerStart)
+			{
+				Test->AddError(TEXT("Park has no Player Start"));
+				return true;
+			}
+
+			if (!GameMode->StartInputPlayback(Recording, PlayerStart->GetActorTransform()))
+			{
+				Test->AddError(TEXT("Input playback didn't start"));
+				return true;
+			}
+		}
+
+		if (GameMode->IsPlayingBackInput())
+		{
+			if (GetCurrentRunTime() < StartTimeoutSeconds + Recording.Frames.Num() * Recording.StepSeconds * PlaybackTimeoutScale)
+			{
+				return false;
+			}
+
+			Test->AddError(TEXT("Input playback didn't finish in time"));
+			return true;
+		}
+
+		Checksums->Add(GameMode->GetLastPlaybackChecksum());
+		Test->AddInfo(FString::Printf(TEXT("Playback %d checksum 0x%08X"), Checksums->Num(), Checksums->Last()));
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+
+	FSkaterInputRecording Recording;
+
+	TSharedRef<TArray<uint32>> Checksums;
+
+	bool bStarted = false;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSkatingParkReplayDeterminismTest, "SkateboardingSim.Replay.ParkDeterminism",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSkatingParkReplayDeterminismTest::RunTest(const FString& Parameters)
+{
+	using namespace SkatingReplayTests;
+
+	FSkaterInputRecording Recording;
+	if (!Recording.LoadFromFile(GetRecordingFilename()))
+	{
+		AddError(FString::Printf(TEXT("Failed to load input recording '%s'"), *GetRecordingFilename()));
+		return false;
+	}
+
+	ULevelEditorPlaySettings* PlaySettings = GetMutableDefault<ULevelEditorPlaySettings>();
+
+	EPlayNetMode OldPlayNetMode;
+	PlaySettings->GetPlayNetMode(OldPlayNetMode);
+	int32 OldNumberOfClients;
+	PlaySettings->GetPlayNumberOfClients(OldNumberOfClients);
+
+	PlaySettings->SetPlayNetMode(PIE_Standalone);
+	PlaySettings->SetPlayNumberOfClients(1);
+
+	const bool bOldUseFixedTimeStep = FApp::UseFixedTimeStep();
+	const double OldFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Recording.StepSeconds);
+
+	// Each playback gets a fresh PIE world, so the first one can't leave anything behind for the second
+	TSharedRef<TArray<uint32>> Checksums = MakeShared<TArray<uint32>>();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FEditorLoadMap(MapName));
+	for (int32 Playback = 0; Playback < 2; ++Playback)
+	{
+		ADD_LATENT_AUTOMATION_COMMAND(FStartPIECommand(false));
+		ADD_LATENT_AUTOMATION_COMMAND(FSkatingPlayRecordingCommand(this, Recording, Checksums));
+		ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+		ADD_LATENT_AUTOMATION_COMMAND(FWaitLatentCommand(EndPlaySeconds));
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Checksums]()
+		{
+			if (TestEqual(TEXT("Finished playbacks"), Checksums->Num(), 2))
+			{
+				TestEqual(TEXT("Playback checksums"), (*Checksums)[1], (*Checksums)[0]);
+			}
+
+			return true;
+		}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([PlaySettings, OldPlayNetMode, OldNumberOfClients, bOldUseFixedTimeStep, OldFixedDeltaTime]()
+		{
+			PlaySettings->SetPlayNetMode(OldPlayNetMode);
+			PlaySettings->SetPlayNumberOfClients(OldNumberOfClients);
+			FApp::SetUseFixedTimeStep(bOldUseFixedTimeStep);
+			FApp::SetFixedDeltaTime(OldFixedDeltaTime);
+			return true;
+		}));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,30 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Core/SkatingGameMode.h"
+#include "Engine/Engine.h"
+
+namespace SkatingTestHelpers
+{
+	/** Skating Game Mode of the standalone PIE world, nullptr until it started */
+	inline ASkatingGameMode* FindPIEGameMode()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (World && Context.WorldType == EWorldType::PIE)
+			{
+				return World->GetAuthGameMode<ASkatingGameMode>();
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright Amr Hamed
+
+
+#include "UI/SkaterScoreWidget.h"
+#include "Components/TextBlock.h"
+#include "Gameplay/ScoreComponent.h"
+
+void USkaterScoreWidget::OnStackActivated_Implementation()
+{
+	const APawn* Pawn = GetOwningPlayerPawn();
+	UScoreComponent* ScoreComponent = Pawn ? Pawn->FindComponentByClass<UScoreComponent>() : nullptr;
+	if (!ScoreComponent)
+	{
+		return;
+	}
+
+	ScoreComponent->OnScoreAdded.AddDynamic(this, &USkaterScoreWidget::HandleScoreAdded);
+	BoundScoreComponent = ScoreComponent;
+
+	// Catch up on updates missed while suspended
+	SetScoreText(ScoreComponent->GetTotalScore());
+	OnScoreUpdated(0.f, ScoreComponent->GetTotalScore());
+}
+
+void USkaterScoreWidget::OnStackSuspended_Implementation()
+{
+	if (UScoreComponent* ScoreComponent = BoundScoreComponent.Get())
+	{
+		ScoreComponent->OnScoreAdded.RemoveDynamic(this, &USkaterScoreWidget::HandleScoreAdded);
+	}
+
+	BoundScoreComponent.Reset();
+}
+
+void USkaterScoreWidget::HandleScoreAdded(float AddedScore, float TotalScore)
+{
+	SetScoreText(TotalScore);
+	OnScoreUpdated(AddedScore, TotalScore);
+}
+
+void USkaterScoreWidget::SetScoreText(const float TotalScore)
+{
+	if (ScoreText)
+	{
+		ScoreText->SetText(FText::AsNumber(FMath::RoundToInt32(TotalScore)));
+	}
+}
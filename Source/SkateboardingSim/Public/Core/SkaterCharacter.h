@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Core/ISkaterCharacter.h"
+#include "Core/SkaterInputRecording.h"
+#include "Gameplay/SkaterSignificanceSubsystem.h"
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
 #include "SkaterCharacter.generated.h"
@@ -47,8 +49,32 @@ public:
 	 */
 	virtual void MoveBlockedBy(const FHitResult& Impact) override;
 
+	/** Lets skating movement react to landing before Blueprint Landed events */
+	virtual void Landed(const FHitResult& Hit) override;
+
 	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
 
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Significance
+public:
+	UFUNCTION(BlueprintPure, Category = "Significance")
+	FORCEINLINE ESkaterSignificanceTier GetSignificanceTier() const { return SignificanceTier; }
+
+	/** Scales tick, animation and movement update rates to TierSettings */
+	void ApplySignificanceTier(const ESkaterSignificanceTier Tier, const FSkaterSignificanceTierSettings& TierSettings);
+
+	// Input Replay
+public:
+	/** Feeds a recorded input frame through the same handlers as player input */
+	void ApplyRecordedInput(const FSkaterInputFrame& InputFrame);
+
+	/** Returns input handled since last call and resets it */
+	FSkaterInputFrame ConsumeCapturedInput();
+
 
 	// Wall Bouncing
 protected:
@@ -61,9 +87,11 @@ protected:
 	// Input Bindings
 protected:
 	void Move(const FInputActionValue& Value);
+	void MoveCompleted(const FInputActionValue& Value);
 	void SpeedUpTriggered(const FInputActionValue& Value);
 	void SlowDownTriggered(const FInputActionValue& Value);
 	void Ollie(const FInputActionValue& Value);
+	void OllieReleased(const FInputActionValue& Value);
 	void Grind(const FInputActionValue& Value);
 	void Flip(const FInputActionValue& Value);
 
@@ -126,4 +154,12 @@ private:
 
 private:
 	float XMoveValue;
+
+	ESkaterSignificanceTier SignificanceTier = ESkaterSignificanceTier::Full;
+
+	/** Tick option meshes go back to when allowed to tick poses while not rendered */
+	EVisibilityBasedAnimTickOption InitialAnimTickOption;
+
+	/** Input handled this frame, used for recording */
+	FSkaterInputFrame CapturedInput;
 };
@@ -0,0 +1,145 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** Skater state of a single ghost run step */
+struct FSkaterGhostSample
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** World rotation of the skateboard component */
+	FRotator BoardRotation = FRotator::ZeroRotator;
+
+	/** Local rotation of the skateboard root bone, flips and grabs animate it */
+	FRotator BoardRootRotation = FRotator::ZeroRotator;
+
+	/** USkatingTrickRegistry::GetTrickId of the active trick, 0 if none */
+	uint32 TrickId = 0;
+
+	/** Interpolates locations and rotations, trick switches at the end of the step */
+	static FSkaterGhostSample Blend(const FSkaterGhostSample& From, const FSkaterGhostSample& To, const float Alpha);
+};
+
+/**
+ * Ghost run file layout, little endian:
+ * Header { Magic, Version, StepSeconds, NumSamples, NumBlocks, TrickRegistryVersion }
+ * Block Index { Offset, Size } * NumBlocks, offsets are from the start of the file
+ * Blocks, each holds SamplesPerBlock samples (fewer in the last one): a full precision keyframe
+ * followed by deltas quantized against the previously decoded sample, so errors never accumulate.
+ */
+namespace SkaterGhostRun
+{
+	constexpr uint32 FileMagic = 0x534B4748; // 'SKGH'
+	/** Version 1 stored registry indices of tricks and the board root bone's world rotation only */
+	constexpr uint32 FileVersion = 2;
+
+	constexpr int32 SamplesPerBlock = 64;
+
+	/** Location delta step, deltas are 16 bits so up to ~32 meters per step */
+	constexpr float LocationPrecision = 0.1f;
+
+	constexpr int32 HeaderSize = 24;
+	constexpr int32 BlockIndexEntrySize = 8;
+	constexpr int32 KeyframeSize = 12 + 6 + 6 + 6 + 4;
+	constexpr int32 DeltaSize = 6 + 6 + 6 + 6 + 4;
+
+	FORCEINLINE constexpr int32 GetBlockSize(const int32 NumSamples) { return NumSamples > 0 ? KeyframeSize + (NumSamples - 1) * DeltaSize : 0; }
+}
+
+/** Encodes ghost samples block by block as they're recorded */
+class SKATEBOARDINGSIM_API FSkaterGhostRunWriter
+{
+public:
+	/** InTrickRegistryVersion is the USkatingTrickRegistry::GetVersion of the registry recorded tricks come from */
+	explicit FSkaterGhostRunWriter(const float InStepSeconds = 1.f / 30.f, const uint32 InTrickRegistryVersion = 0);
+
+	void AddSample(const FSkaterGhostSample& Sample);
+
+	FORCEINLINE int32 GetNumSamples() const { return NumSamples; }
+
+	/** Serializes header, block index and blocks */
+	TArray<uint8> Finish() const;
+
+	bool SaveToFile(const FString& Filename) const;
+
+private:
+	float StepSeconds;
+
+	uint32 TrickRegistryVersion;
+
+	int32 NumSamples = 0;
+
+	/** Encoded blocks, back to back */
+	TArray<uint8> BlockBytes;
+
+	/** Last sample as the reader will decode it, deltas are taken against it */
+	FSkaterGhostSample LastDecodedSample;
+};
+
+/**
+ * Reads ghost runs, memory mapping the file when the platform allows it.
+ * Only the block index is loaded up front, blocks are decoded on demand into caller owned buffers.
+ */
+class SKATEBOARDINGSIM_API FSkaterGhostRunReader
+{
+public:
+	FSkaterGhostRunReader();
+	~FSkaterGhostRunReader();
+
+	UE_NONCOPYABLE(FSkaterGhostRunReader);
+
+	bool Open(const FString& Filename);
+
+	/** Takes over an already encoded run, e.g. one just recorded */
+	bool Open(TArray<uint8>&& InBytes);
+
+	void Close();
+
+	FORCEINLINE bool IsOpen() const { return !Bytes.IsEmpty(); }
+	FORCEINLINE int32 GetNumSamples() const { return NumSamples; }
+	FORCEINLINE int32 GetNumBlocks() const { return BlockIndex.Num(); }
+	FORCEINLINE float GetStepSeconds() const { return StepSeconds; }
+	FORCEINLINE float GetDuration() const { return NumSamples > 1 ? (NumSamples - 1) * StepSeconds : 0.f; }
+	FORCEINLINE uint32 GetTrickRegistryVersion() const { return TrickRegistryVersion; }
+
+	/**
+	 * Decodes the samples of block Block into OutSamples, which needs SamplesPerBlock + 1 entries.
+	 * The extra entry receives the next block's keyframe, or repeats the last sample, so the whole block can be interpolated.
+	 * @Return number of samples of the block, 0 if it couldn't be decoded
+	 */
+	int32 DecodeBlock(const int32 Block, TArrayView<FSkaterGhostSample> OutSamples) const;
+
+private:
+	bool ParseHeader();
+
+	bool DecodeKeyframe(const int32 Block, FSkaterGhostSample& OutSample) const;
+
+private:
+	struct FBlockIndexEntry
+	{
+		uint32 Offset = 0;
+		uint32 Size = 0;
+	};
+
+	/** Whole file, either mapped or owned */
+	TArrayView<const uint8> Bytes;
+
+	TArray<uint8> OwnedBytes;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	TArray<FBlockIndexEntry> BlockIndex;
+
+	float StepSeconds = 0.f;
+
+	uint32 TrickRegistryVersion = 0;
+
+	int32 NumSamples = 0;
+};
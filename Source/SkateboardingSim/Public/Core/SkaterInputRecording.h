@@ -0,0 +1,57 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Skater input actions captured in a recorded frame */
+enum class ESkaterInputFlags : uint8
+{
+	None			= 0,
+	SpeedUp			= 1 << 0,
+	SlowDown		= 1 << 1,
+	Ollie			= 1 << 2,
+	OllieReleased	= 1 << 3,
+	Grind			= 1 << 4,
+	Flip			= 1 << 5,
+};
+ENUM_CLASS_FLAGS(ESkaterInputFlags);
+
+/** Skater input of a single simulation step, 3 bytes per frame */
+struct SKATEBOARDINGSIM_API FSkaterInputFrame
+{
+	int8 MoveX = 0;
+	int8 MoveY = 0;
+	ESkaterInputFlags Flags = ESkaterInputFlags::None;
+
+	void SetMove(const FVector2D& Move);
+	FVector2D GetMove() const;
+
+	FORCEINLINE bool HasFlag(const ESkaterInputFlags Flag) const { return EnumHasAnyFlags(Flags, Flag); }
+	FORCEINLINE void AddFlag(const ESkaterInputFlags Flag) { EnumAddFlags(Flags, Flag); }
+
+	friend FArchive& operator<<(FArchive& Ar, FSkaterInputFrame& Frame);
+};
+
+/** A recorded skating run that can be played back deterministically */
+struct SKATEBOARDINGSIM_API FSkaterInputRecording
+{
+	static constexpr uint32 FileMagic = 0x534B5243; // 'SKRC'
+	static constexpr uint32 FileVersion = 2;
+
+	/** Frame time the run was recorded with, playback should run with the same fixed time step */
+	float StepSeconds = 1.f / 60.f;
+
+	/** Skater transform when recording started */
+	FTransform StartTransform;
+
+	/** Seed of the skater's random tricks, recordings older than version 2 use 0 */
+	int32 RandomSeed = 0;
+
+	TArray<FSkaterInputFrame> Frames;
+
+	void Serialize(FArchive& Ar);
+
+	bool SaveToFile(const FString& Filename) const;
+	bool LoadFromFile(const FString& Filename);
+};
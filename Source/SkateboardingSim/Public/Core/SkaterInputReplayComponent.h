@@ -0,0 +1,73 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Core/SkaterInputRecording.h"
+#include "SkaterInputReplayComponent.generated.h"
+
+class ASkaterCharacter;
+class USkaterInputReplayComponent;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSkaterInputPlaybackFinished, USkaterInputReplayComponent*);
+
+UENUM(BlueprintType)
+enum class ESkaterInputReplayMode : uint8
+{
+	Idle,
+	Recording,
+	Playing
+};
+
+/** Component that records owner skater's input every frame or feeds a recording back into it */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent, ValidOwnerClass = "SkaterCharacter"))
+class SKATEBOARDINGSIM_API USkaterInputReplayComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USkaterInputReplayComponent();
+
+	UFUNCTION(BlueprintCallable, Category = "Input Replay")
+	void StartRecording();
+
+	/** Stops recording and saves it to Filename, returns whether saving succeeded */
+	UFUNCTION(BlueprintCallable, Category = "Input Replay")
+	bool StopRecording(const FString& Filename);
+
+	/** Feeds InRecording into owner's input handlers starting next frame */
+	void StartPlayback(const FSkaterInputRecording& InRecording);
+
+	UFUNCTION(BlueprintCallable, Category = "Input Replay")
+	void StopPlayback();
+
+	UFUNCTION(BlueprintPure, Category = "Input Replay")
+	FORCEINLINE ESkaterInputReplayMode GetMode() const { return Mode; }
+
+	UFUNCTION(BlueprintPure, Category = "Input Replay")
+	FORCEINLINE int32 GetPlaybackFrame() const { return PlaybackFrame; }
+
+	FORCEINLINE const FSkaterInputRecording& GetRecording() const { return Recording; }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	virtual void BeginPlay() override;
+
+public:
+	/** Called once every recorded frame was played back */
+	FOnSkaterInputPlaybackFinished OnPlaybackFinished;
+
+private:
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	ESkaterInputReplayMode Mode = ESkaterInputReplayMode::Idle;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	int32 PlaybackFrame = 0;
+
+	FSkaterInputRecording Recording;
+
+	UPROPERTY()
+	TObjectPtr<ASkaterCharacter> OwnerSkater;
+};
@@ -0,0 +1,79 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SkatingBenchmarkCourse.generated.h"
+
+class AGrindRailSet;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * Benchmark course built from basic blocks, one straight lane per perf scenario, see SkatingPerfScenarios.
+ * Slopes gets ramps to weave across and Grinding a low rail right ahead of its start, the other lanes are flat.
+ * Drop it in a map or let ASkatingGameMode spawn it when the map has no Player Starts tagged with the scenarios.
+ */
+UCLASS()
+class SKATEBOARDINGSIM_API ASkatingBenchmarkCourse : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ASkatingBenchmarkCourse();
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** World transform Scenario starts from, false if the course has no lane for it */
+	bool FindScenarioStart(const FName Scenario, FTransform& OutStart) const;
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Index of Scenario's lane, INDEX_NONE if there's none */
+	FORCEINLINE int32 FindLane(const FName Scenario) const { return LaneScenarios.IndexOfByKey(Scenario); }
+
+	/** Local space start of Lane's center line, on the floor */
+	FVector GetLaneStart(const int32 Lane) const;
+
+	void AddBlock(const FVector& Center, const FVector& Size, const FRotator& Rotation = FRotator::ZeroRotator);
+
+private:
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	TObjectPtr<UInstancedStaticMeshComponent> Blocks;
+
+	/** Scenario of each lane, lanes are laid side by side along the actor's Y axis */
+	UPROPERTY(EditAnywhere, Category = "Config|Course")
+	TArray<FName> LaneScenarios = { TEXT("Cruising"), TEXT("Slopes"), TEXT("Grinding"), TEXT("Flips"), TEXT("Bails") };
+
+	UPROPERTY(EditAnywhere, Category = "Config|Course", meta = (UIMin = "100", ClampMin = "100"))
+	float LaneLength = 30000.f;
+
+	UPROPERTY(EditAnywhere, Category = "Config|Course", meta = (UIMin = "100", ClampMin = "100"))
+	float LaneWidth = 2000.f;
+
+	/** Unit cube every block of the course is scaled from */
+	UPROPERTY(EditAnywhere, Category = "Config|Course")
+	TSoftObjectPtr<UStaticMesh> BlockMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Cube.Cube")));
+
+	/** Distance between ramps along the Slopes lane */
+	UPROPERTY(EditAnywhere, Category = "Config|Slopes", meta = (UIMin = "100", ClampMin = "100"))
+	float RampSpacing = 1500.f;
+
+	UPROPERTY(EditAnywhere, Category = "Config|Slopes", meta = (UIMin = "0", UIMax = "45", ClampMin = "0", ClampMax = "45", Units = "Degrees"))
+	float RampAngle = 12.f;
+
+	/** Distance between the Grinding start and the rail, the skater ollies onto it while pushing off */
+	UPROPERTY(EditAnywhere, Category = "Config|Grinding", meta = (UIMin = "0", ClampMin = "0"))
+	float RailStartDistance = 100.f;
+
+	UPROPERTY(EditAnywhere, Category = "Config|Grinding", meta = (UIMin = "0", ClampMin = "0"))
+	float RailHeight = 20.f;
+
+	UPROPERTY(Transient)
+	TObjectPtr<AGrindRailSet> RailSet;
+};
@@ -4,14 +4,124 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "Core/SkatingPerfScenarios.h"
 #include "SkatingGameMode.generated.h"
 
+class ASkatingBenchmarkCourse;
+class USkaterInputReplayComponent;
+
 /**
+ * Skating Game Mode
  * 
+ * Supports recording player input with -SkateRecord=<File>
+ * and playing it back headless as a benchmark with -SkateReplay=<File> (e.g. -nullrhi -unattended -benchmark -fps=60)
+ *
+ * -SkateBenchmark runs every scripted perf scenario the same way and compares it to a baseline
+ * (-SkateBenchmarkBaseline=<File>, Config/Benchmarks/SkatingPerfBaseline.json by default),
+ * exiting with a non-zero code when a scenario regressed. -SkateBenchmarkUpdateBaseline writes the results as the new baseline.
+ * Scenarios start at Player Starts tagged with their name, maps without them get an ASkatingBenchmarkCourse spawned.
  */
 UCLASS()
 class SKATEBOARDINGSIM_API ASkatingGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
 	
+public:
+	ASkatingGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void StartPlay() override;
+
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Input Replay
+protected:
+	UFUNCTION(BlueprintPure, Category = "Input Replay")
+	FORCEINLINE bool IsReplayingInput() const { return !InputReplayFilename.IsEmpty() || bIsBenchmarking; }
+
+	/** Spawns a skater without a player and plays back InputReplayFilename on it, exits unattended runs it can't play */
+	void StartInputPlayback();
+
+public:
+	/** Spawns a skater without a player at StartTransform and plays back Recording on it */
+	bool StartInputPlayback(const FSkaterInputRecording& Recording, const FTransform& StartTransform);
+
+	bool IsPlayingBackInput() const;
+
+	/** Checksum of the skater's final state after the last playback, equal checksums mean the playback didn't drift */
+	FORCEINLINE uint32 GetLastPlaybackChecksum() const { return LastPlaybackChecksum; }
+
+protected:
+	void OnInputPlaybackFinished(USkaterInputReplayComponent* InputReplayComponent);
+
+	// Benchmark
+public:
+	/** Plays Scenarios one after the other, all of them if empty, results are read with GetBenchmarkResults once finished */
+	void StartBenchmark(TConstArrayView<FName> Scenarios = {});
+
+	FORCEINLINE bool IsBenchmarkRunning() const { return bIsBenchmarkRunning; }
+
+	/** Results of the last benchmark, in scenario order, scenarios that couldn't start have no frames */
+	FORCEINLINE TConstArrayView<FSkatingPerfScenarioMetrics> GetBenchmarkResults() const { return BenchmarkResults; }
+
+protected:
+	/** Plays the next scripted scenario or finishes the benchmark once all were played */
+	void StartNextBenchmarkScenario();
+
+	/** Where Scenario starts, a tagged Player Start or the benchmark course's lane */
+	bool FindBenchmarkScenarioStart(const FName Scenario, FTransform& OutStart);
+
+	void FinishBenchmark();
+
+private:
+	/** Recording to play back, set from -SkateReplay= */
+	FString InputReplayFilename;
+
+	/** File to record player input to, set from -SkateRecord= */
+	FString InputRecordFilename;
+
+	UPROPERTY()
+	TObjectPtr<USkaterInputReplayComponent> InputReplayComponent;
+
+	double PlaybackStartSeconds = 0.0;
+	uint32 PlaybackStartPhysicsQueries = 0;
+
+	/** Game thread time of played back frames */
+	double PlaybackGameThreadMs = 0.0;
+
+	/** Skating heap allocations of played back frames past the warmup */
+	uint64 PlaybackAllocations = 0;
+	uint64 LastNumScopedAllocations = 0;
+
+	/** Played back frames the skater spent grinding */
+	int32 PlaybackGrindingFrames = 0;
+
+	uint32 LastPlaybackChecksum = 0;
+
+private:
+	/** Set from -SkateBenchmark, compares results to the baseline and exits once the benchmark finished */
+	bool bIsBenchmarking = false;
+
+	bool bIsBenchmarkRunning = false;
+
+	/** Course spawned for maps without tagged Player Starts */
+	UPROPERTY()
+	TObjectPtr<ASkatingBenchmarkCourse> BenchmarkCourse;
+
+	/** Where the benchmark course is spawned, far from the map's own geometry */
+	UPROPERTY(EditDefaultsOnly, Category = "Config|Benchmark")
+	FVector BenchmarkCourseLocation = FVector(0.0, 0.0, 50000.0);
+
+	FString BenchmarkBaselineFilename;
+
+	TArray<SkatingPerfScenarios::FScenario> BenchmarkScenarios;
+	TArray<FSkatingPerfScenarioMetrics> BenchmarkResults;
+
+	/** Scenarios that ran but didn't do what they measure, e.g. grinding without reaching a rail */
+	int32 NumBenchmarkFailures = 0;
 };
@@ -0,0 +1,42 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/** LLM tag of memory allocated by skating code, see -llm and "stat LLM" */
+LLM_DECLARE_TAG_API(Skating, SKATEBOARDINGSIM_API);
+
+/**
+ * Heap allocation counting for skating hot paths.
+ * Allocations are only counted once InstallAllocationCounter wrapped GMalloc, which the module does on startup
+ * with -SkateBenchmark or -SkateCountAllocations, so regular runs only pay for the scope depth.
+ */
+namespace SkatingMemory
+{
+	/**
+	 * Wraps GMalloc with a proxy counting allocations made inside allocation scopes, does nothing if already installed.
+	 * Has to run before gameplay starts, see FSkateboardingSimModule::StartupModule.
+	 */
+	SKATEBOARDINGSIM_API void InstallAllocationCounter();
+
+	SKATEBOARDINGSIM_API bool IsAllocationCounterInstalled();
+
+	/** Heap allocations and reallocations made inside allocation scopes since the counter was installed */
+	SKATEBOARDINGSIM_API uint64 GetNumScopedAllocations();
+
+	/** Counts heap allocations of the current thread while alive */
+	struct SKATEBOARDINGSIM_API FAllocationScope
+	{
+		FAllocationScope();
+		~FAllocationScope();
+
+		UE_NONCOPYABLE(FAllocationScope);
+	};
+}
+
+/** Tags memory allocated in the current scope as Skating and counts its heap allocations */
+#define SKATING_MEMORY_SCOPE() \
+	LLM_SCOPE_BYTAG(Skating); \
+	SkatingMemory::FAllocationScope SkatingAllocationScope
@@ -0,0 +1,89 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/SkaterInputRecording.h"
+#include "SkatingPerfScenarios.generated.h"
+
+/** Performance of a single benchmark scenario, averaged per frame */
+USTRUCT()
+struct FSkatingPerfScenarioMetrics
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	FString Name;
+
+	UPROPERTY()
+	int32 NumFrames = 0;
+
+	UPROPERTY()
+	float GameThreadMs = 0.f;
+
+	UPROPERTY()
+	float PhysicsQueriesPerFrame = 0.f;
+
+	/** Heap allocations of skating memory scopes, counted after the first WarmupSeconds */
+	UPROPERTY()
+	float AllocationsPerFrame = 0.f;
+
+	UPROPERTY()
+	int32 GrindingFrames = 0;
+
+	/** Baseline only, allocations per frame above this fail the run regardless of threshold, negative to not check */
+	UPROPERTY()
+	float MaxAllocationsPerFrame = -1.f;
+};
+
+/** Checked in reference metrics benchmark runs are compared to */
+USTRUCT()
+struct FSkatingPerfBaseline
+{
+	GENERATED_BODY()
+public:
+	/** Relative increase of a metric over its baseline that counts as a regression */
+	UPROPERTY()
+	float RegressionThreshold = 0.15f;
+
+	/** Metrics of each scenario, scenarios without frames weren't recorded yet and fail the comparison */
+	UPROPERTY()
+	TArray<FSkatingPerfScenarioMetrics> Scenarios;
+
+	const FSkatingPerfScenarioMetrics* FindScenario(const FString& Name) const;
+
+	bool LoadFromFile(const FString& Filename);
+	bool SaveToFile(const FString& Filename) const;
+};
+
+/**
+ * Scripted scenarios of the headless skating benchmark, see ASkatingGameMode.
+ * Each scenario starts at the Player Start tagged with its name, so a benchmark map can decide
+ * whether it's flat ground, ramps or a rail. Maps without them use the lanes of ASkatingBenchmarkCourse.
+ */
+namespace SkatingPerfScenarios
+{
+	struct FScenario
+	{
+		FName Name;
+		FSkaterInputRecording Recording;
+
+		/** Fails the scenario if the skater never grinded */
+		bool bRequiresGrinding = false;
+	};
+
+	/** Time every scenario gets to settle (push off, montages and pools warming up) before allocations are counted */
+	constexpr float WarmupSeconds = 2.f;
+
+	/** Default baseline location, Config/Benchmarks/SkatingPerfBaseline.json */
+	FString GetDefaultBaselineFilename();
+
+	/** Builds input of every scenario: Cruising, Slopes, Grinding, Flips and Bails */
+	TArray<FScenario> BuildScenarios(const float StepSeconds);
+
+	/**
+	 * Logs every metric against Baseline and returns the number of regressions.
+	 * Scenarios that didn't run count as regressions, as do scenarios without a recorded baseline unless bAllowMissingBaseline.
+	 */
+	int32 CompareWithBaseline(const FSkatingPerfBaseline& Baseline, TConstArrayView<FSkatingPerfScenarioMetrics> Results, const bool bAllowMissingBaseline = false);
+}
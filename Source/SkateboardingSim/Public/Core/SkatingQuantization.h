@@ -0,0 +1,54 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Quantization shared by everything sending or storing skating state compactly (network moves, recordings) */
+namespace SkatingQuantization
+{
+	/** Quantizes Value in [0, 1] to a byte */
+	FORCEINLINE uint8 QuantizeUnitFloat8(const float Value)
+	{
+		return static_cast<uint8>(FMath::RoundToInt32(FMath::Clamp(Value, 0.f, 1.f) * MAX_uint8));
+	}
+
+	FORCEINLINE float DequantizeUnitFloat8(const uint8 Value)
+	{
+		return static_cast<float>(Value) / MAX_uint8;
+	}
+
+	/** Quantizes a positive distance to 16 bits in steps of Precision, distances beyond the range are clamped */
+	FORCEINLINE uint16 QuantizeDistance16(const float Distance, const float Precision = 1.f)
+	{
+		return static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(Distance / Precision), 0, static_cast<int32>(MAX_uint16)));
+	}
+
+	FORCEINLINE float DequantizeDistance16(const uint16 Value, const float Precision = 1.f)
+	{
+		return static_cast<float>(Value) * Precision;
+	}
+}
+
+/** Rotation compressed to 16 bits per axis, deltas between them wrap around */
+struct FSkatingCompressedRotation
+{
+	uint16 Pitch = 0;
+	uint16 Yaw = 0;
+	uint16 Roll = 0;
+
+	static FSkatingCompressedRotation Compress(const FRotator& Rotation)
+	{
+		return { FRotator::CompressAxisToShort(Rotation.Pitch), FRotator::CompressAxisToShort(Rotation.Yaw), FRotator::CompressAxisToShort(Rotation.Roll) };
+	}
+
+	FRotator Decompress() const
+	{
+		return FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), FRotator::DecompressAxisFromShort(Roll));
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FSkatingCompressedRotation& Rotation)
+	{
+		return Ar << Rotation.Pitch << Rotation.Yaw << Rotation.Roll;
+	}
+};
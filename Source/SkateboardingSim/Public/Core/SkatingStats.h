@@ -0,0 +1,49 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP(TEXT("Skating"), STATGROUP_Skating, STATCAT_Advanced);
+
+// Cycle Counters
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Move Along Floor"), STAT_Skating_MoveAlongFloor, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Adapt To Floor Slope"), STAT_Skating_AdaptToFloorSlope, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Steer"), STAT_Skating_Steer, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Grindable"), STAT_Skating_FindGrindable, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Phys Grinding"), STAT_Skating_PhysGrinding, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Move Character Along Spline"), STAT_Skating_MoveCharacterAlongSpline, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Should Bail"), STAT_Skating_ShouldBail, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd Step"), STAT_Skating_CrowdStep, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd Floor Traces"), STAT_Skating_CrowdFloorTraces, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd Update Instances"), STAT_Skating_CrowdUpdateInstances, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Significance Update"), STAT_Skating_SignificanceUpdate, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Event Dispatch"), STAT_Skating_EventDispatch, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Instant Replay Record"), STAT_Skating_InstantReplayRecord, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+
+// Per Frame Counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Physics Queries"), STAT_Skating_PhysicsQueries, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Grindable Queries"), STAT_Skating_GrindableQueries, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Grind Snaps"), STAT_Skating_GrindSnaps, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bails"), STAT_Skating_Bails, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Trick Starts"), STAT_Skating_TrickStarts, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Crowd Skaters"), STAT_Skating_CrowdSkaters, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Move Bits Received"), STAT_Skating_MoveBits, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Move Response Bits Received"), STAT_Skating_MoveResponseBits, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Events Dispatched"), STAT_Skating_EventsDispatched, STATGROUP_Skating, SKATEBOARDINGSIM_API);
+
+/** Trace channel for skating scopes in builds without stats, enable with -trace=cpu,skating */
+UE_TRACE_CHANNEL_EXTERN(SkatingChannel, SKATEBOARDINGSIM_API);
+
+/**
+ * Scopes a skating cycle counter, visible as a timing event in Insights either way.
+ * Cycle counters already emit CPU trace events, so the trace scope is only added when stats are compiled out.
+ */
+#if STATS
+#define SKATING_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define SKATING_SCOPE_CYCLE_COUNTER(Stat) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, SkatingChannel)
+#endif
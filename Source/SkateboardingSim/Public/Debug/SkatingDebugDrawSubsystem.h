@@ -0,0 +1,79 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SkatingDebugDrawSubsystem.generated.h"
+
+/** Debug draw categories, each one is toggled by its own skate.Debug.* console variable */
+UENUM()
+enum class ESkatingDebugCategory : uint8
+{
+	Steer,
+	Grind,
+	Slope,
+	Bail,
+	Score,
+	Num UMETA(Hidden)
+};
+
+/** A debug line or point drawn every frame until its lifetime runs out */
+struct FSkatingDebugPrimitive
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FColor Color = FColor::White;
+	float RemainingSeconds = -1.f;
+	bool bIsPoint = false;
+};
+
+/**
+ * World Subsystem drawing skating debug primitives from a fixed capacity ring buffer.
+ * Oldest primitives are overwritten when it's full so drawing never grows over a session.
+ * Use SKATING_DEBUG_* macros, they compile out when debug drawing is disabled (e.g. Shipping).
+ */
+UCLASS()
+class SKATEBOARDINGSIM_API USkatingDebugDrawSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static bool IsCategoryEnabled(const ESkatingDebugCategory Category);
+
+	static void DrawLine(const UWorld* World, const ESkatingDebugCategory Category, const FVector& Start, const FVector& End, const FColor& Color, const float Lifetime = 0.f);
+
+	static void DrawPoint(const UWorld* World, const ESkatingDebugCategory Category, const FVector& Location, const FColor& Color, const float Lifetime = 0.f);
+
+	//~ Begin USubsystem Interface.
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	//~ End USubsystem Interface.
+
+	//~ Begin FTickableGameObject Interface.
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return NumPrimitives > 0; }
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface.
+
+private:
+	void AddPrimitive(const FSkatingDebugPrimitive& Primitive);
+
+private:
+	static constexpr int32 Capacity = 2048;
+
+	TArray<FSkatingDebugPrimitive> Primitives;
+
+	/** Slot the next primitive is written to */
+	int32 NextPrimitive = 0;
+
+	int32 NumPrimitives = 0;
+};
+
+#if ENABLE_DRAW_DEBUG
+#define SKATING_DEBUG_LINE(World, Category, Start, End, Color, Lifetime) USkatingDebugDrawSubsystem::DrawLine(World, ESkatingDebugCategory::Category, Start, End, Color, Lifetime)
+#define SKATING_DEBUG_POINT(World, Category, Location, Color, Lifetime) USkatingDebugDrawSubsystem::DrawPoint(World, ESkatingDebugCategory::Category, Location, Color, Lifetime)
+#else
+#define SKATING_DEBUG_LINE(World, Category, Start, End, Color, Lifetime)
+#define SKATING_DEBUG_POINT(World, Category, Location, Color, Lifetime)
+#endif
@@ -7,6 +7,10 @@
 #include "Movement/SkatingTricksComponent.h"
 #include "ScoreComponent.generated.h"
 
+class USkatingEventSubsystem;
+struct FSkatingTrickStartedEvent;
+struct FSkatingTrickEndedEvent;
+
 // Score Delegates
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnScoreAdded, float, AddedScore, float, TotalScore);
 
@@ -19,15 +23,15 @@ class SKATEBOARDINGSIM_API UScoreComponent : public UActorComponent
 public:
 	UScoreComponent();
 
-	/** Starts Accumulating Score from SkatingMove every frame */
+	/** Starts Accumulating Score from SkatingTrick over time */
 	UFUNCTION(BlueprintCallable)
-	void StartAccumulatingScoreForTrick(const FSkatingTrick SkatingMove);
+	void StartAccumulatingScoreForTrick(FSkatingTrickHandle SkatingTrick);
 
 	/** Adds Accumulated score from active trick to total score 
 	* @Param bWasTrickSuccessful if false, accumulated score will be subtracted from total score
 	*/
 	UFUNCTION(BlueprintCallable)
-	void AddTrickAccumulatedScore(const FSkatingTrick SkatingTrick, bool bWasTrickSuccessful);
+	void AddTrickAccumulatedScore(FSkatingTrickHandle SkatingTrick, bool bWasTrickSuccessful);
 
 	UFUNCTION(BlueprintCallable)
 	void AddScore(const float Score);
@@ -35,29 +39,56 @@ public:
 	UFUNCTION(BlueprintPure)
 	FORCEINLINE float GetTotalScore() const { return TotalScore; }
 
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	/** Currently Calculated Score of active trick that is not yet applied */
+	UFUNCTION(BlueprintPure)
+	float GetAccumulatedScore() const;
 
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
+	void OnTrickStarted(const FSkatingTrickStartedEvent& Event);
+
+	void OnTrickEnded(const FSkatingTrickEndedEvent& Event);
+
+	/** Tricks without an event subsystem, broadcast directly by the tricks component */
+	UFUNCTION()
+	void OnSkatingTrickStarted(const FSkatingTrickHandle SkatingTrick);
+
+	UFUNCTION()
+	void OnSkatingTrickEnded(const FSkatingTrickHandle SkatingTrick, bool bWasSuccessful);
+
 	UFUNCTION(BlueprintCallable)
 	void DebugScore(FLinearColor TextColor);
 
 public:
-	/** Delegate called when total score is updated */
+	/** Delegate called when total score is updated, Blueprint adapter of the ScoreAdded skating event */
 	UPROPERTY(BlueprintAssignable, EditDefaultsOnly)
 	FOnScoreAdded OnScoreAdded;
 
 private:
-	UPROPERTY(EditDefaultsOnly, Category = "State")
-	TOptional<FSkatingTrick> ActiveSkatingTrick;
+	/** Registry of owner's tricks component, active trick is looked up in it */
+	UPROPERTY()
+	TObjectPtr<USkatingTrickRegistry> TrickRegistry;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	FSkatingTrickHandle ActiveSkatingTrick;
 
-	/** Currently Calculated Score that is not yet applied */
+	/** World time active trick started at */
 	UPROPERTY(VisibleAnywhere, Category = "State")
-	float AccumulatedScore;
+	double ActiveTrickStartTime;
 
 	UPROPERTY(VisibleAnywhere, Category = "State")
 	float TotalScore;
 
-};
\ No newline at end of file
+	UPROPERTY()
+	TObjectPtr<USkatingTricksComponent> SkatingTricksComponent;
+
+	UPROPERTY()
+	TObjectPtr<USkatingEventSubsystem> EventSubsystem;
+
+	FDelegateHandle TrickStartedHandle;
+	FDelegateHandle TrickEndedHandle;
+};
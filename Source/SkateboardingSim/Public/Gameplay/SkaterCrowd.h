@@ -0,0 +1,84 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Movement/SkaterCrowdSimulation.h"
+#include "SkaterCrowd.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ * Ambient skaters simulated in bulk without characters or movement components.
+ * A single actor tick consumes last frame's async floor traces, steps all skaters
+ * with the shared skating rules, requests new traces and updates instance transforms.
+ */
+UCLASS()
+class SKATEBOARDINGSIM_API ASkaterCrowd : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ASkaterCrowd();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Replaces current skaters with NumSkaters skaters spread around the actor */
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void SpawnSkaters(const int32 NumSkaters);
+
+	UFUNCTION(BlueprintPure, Category = "Crowd")
+	FORCEINLINE int32 GetNumSkaters() const { return CrowdState.Num(); }
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Writes floor results of traces requested last frame, skaters keep their previous floor until results arrive */
+	void ConsumeFloorTraces();
+
+	void RequestFloorTraces();
+
+	void UpdateInstances();
+
+private:
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	TObjectPtr<UInstancedStaticMeshComponent> SkaterInstances;
+
+	/** Skaters spawned on BeginPlay */
+	UPROPERTY(EditAnywhere, Category = "Config|Crowd", meta = (UIMin = "0", ClampMin = "0"))
+	int32 InitialNumSkaters = 100;
+
+	/** Radius around the actor skaters are spawned in */
+	UPROPERTY(EditAnywhere, Category = "Config|Crowd", meta = (UIMin = "0", ClampMin = "0"))
+	float SpawnRadius = 2000.f;
+
+	/** Seed of decisions, same seed and floor gives the same crowd */
+	UPROPERTY(EditAnywhere, Category = "Config|Crowd")
+	int32 RandomSeed = 0;
+
+	UPROPERTY(EditAnywhere, Category = "Config|Crowd")
+	FSkaterCrowdSettings CrowdSettings;
+
+	/** How far above a skater floor traces start */
+	UPROPERTY(EditAnywhere, Category = "Config|Floor", meta = (UIMin = "0", ClampMin = "0"))
+	float FloorTraceHeight = 100.f;
+
+	/** How far below a skater floor traces end */
+	UPROPERTY(EditAnywhere, Category = "Config|Floor", meta = (UIMin = "0", ClampMin = "0"))
+	float FloorTraceDepth = 200.f;
+
+	UPROPERTY(EditAnywhere, Category = "Config|Floor")
+	TEnumAsByte<ECollisionChannel> FloorTraceChannel = ECC_Visibility;
+
+	FSkaterCrowdState CrowdState;
+
+	/** Floor trace of each skater, issued last frame */
+	TArray<FTraceHandle> FloorTraces;
+
+	/** Reused every frame to batch instance updates */
+	TArray<FTransform> InstanceTransforms;
+};
@@ -0,0 +1,124 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Core/SkaterGhostRun.h"
+#include "Movement/SkatingTrickRegistry.h"
+#include "SkaterGhostComponent.generated.h"
+
+class USkatingTricksComponent;
+class USkinnedMeshComponent;
+
+UENUM(BlueprintType)
+enum class ESkaterGhostMode : uint8
+{
+	Idle,
+	Recording,
+	Playing
+};
+
+/**
+ * Records a skater's run as a ghost run, or plays one back on a lightweight ghost actor.
+ * Playback only keeps the block around the current time decoded, in a buffer allocated once,
+ * so many ghosts can run at once without a skater character, movement or per frame allocations.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class SKATEBOARDINGSIM_API USkaterGhostComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USkaterGhostComponent();
+
+	/** Starts sampling owner skater every SampleInterval, owner has to be a skater character */
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+	void StartRecording();
+
+	/** Stops recording and saves the run to Filename, returns whether saving succeeded */
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+	bool StopRecording(const FString& Filename);
+
+	/** Plays the ghost run in Filename back on the owner, returns whether the run could be opened */
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+	bool StartPlayback(const FString& Filename);
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+	void StopPlayback();
+
+	UFUNCTION(BlueprintPure, Category = "Ghost")
+	FORCEINLINE ESkaterGhostMode GetMode() const { return Mode; }
+
+	UFUNCTION(BlueprintPure, Category = "Ghost")
+	FORCEINLINE float GetPlaybackTime() const { return PlaybackTime; }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void RecordSample();
+
+	/** Applies the run at PlaybackTime to owner, decoding another block if needed */
+	void ApplyPlaybackTime();
+
+	void PlayTrick(const uint32 TrickId);
+
+private:
+	/** Time between recorded samples, playback interpolates between them */
+	UPROPERTY(EditAnywhere, Category = "Config", meta = (UIMin = "0.005", ClampMin = "0.005", Units = "Seconds"))
+	float SampleInterval = 1.f / 30.f;
+
+	/** Whether playback starts over once the run ended */
+	UPROPERTY(EditAnywhere, Category = "Config")
+	bool bLoopPlayback = false;
+
+	/** Tag of the owner's skateboard mesh, the first other skeletal mesh is the skater */
+	UPROPERTY(EditAnywhere, Category = "Config")
+	FName SkateboardComponentTag = TEXT("Skateboard");
+
+	/** Registry recorded trick ids are looked up in, tricks aren't played back without it */
+	UPROPERTY(EditAnywhere, Category = "Config")
+	TObjectPtr<USkatingTrickRegistry> TrickRegistry;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	ESkaterGhostMode Mode = ESkaterGhostMode::Idle;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	float PlaybackTime = 0.f;
+
+	/** Block DecodedSamples holds, INDEX_NONE if none */
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	int32 DecodedBlock = INDEX_NONE;
+
+	/** USkatingTrickRegistry::GetTrickId of the trick played by the ghost, 0 if none */
+	uint32 PlayedTrickId = 0;
+
+	/** Last active trick recorded and its id */
+	FSkatingTrickHandle RecordedTrick;
+	uint32 RecordedTrickId = 0;
+
+	float TimeSinceLastSample = 0.f;
+
+	TUniquePtr<FSkaterGhostRunWriter> Writer;
+
+	FSkaterGhostRunReader Reader;
+
+	/** Samples of DecodedBlock followed by the next block's keyframe */
+	TArray<FSkaterGhostSample> DecodedSamples;
+
+	int32 NumDecodedSamples = 0;
+
+	UPROPERTY()
+	TObjectPtr<USkeletalMeshComponent> SkaterMesh;
+
+	UPROPERTY()
+	TObjectPtr<USkinnedMeshComponent> SkateboardMesh;
+
+	UPROPERTY()
+	TObjectPtr<USkatingTricksComponent> TricksComponent;
+};
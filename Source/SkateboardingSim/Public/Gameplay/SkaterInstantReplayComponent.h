@@ -0,0 +1,229 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Core/SkatingQuantization.h"
+#include "Movement/SkatingTrickRegistry.h"
+#include "SkaterInstantReplayComponent.generated.h"
+
+class UPoseableMeshComponent;
+class USkatingEventSubsystem;
+class USkatingTricksComponent;
+struct FSkatingBailedEvent;
+struct FSkatingTrickEndedEvent;
+struct FSkatingTrickStartedEvent;
+
+UENUM(BlueprintType)
+enum class ESkaterInstantReplayMode : uint8
+{
+	Recording,
+	Replaying
+};
+
+UENUM(BlueprintType)
+enum class ESkaterReplayEventType : uint8
+{
+	TrickStarted,
+	TrickEnded,
+	Bailed
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnSkaterReplayEvent, ESkaterReplayEventType, EventType, FSkatingTrickHandle, SkatingTrick, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSkaterReplayFinished);
+
+/** Transforms of a single buffered frame */
+struct FSkaterReplayFrame
+{
+	FVector3f ActorLocation = FVector3f::ZeroVector;
+	FSkatingCompressedRotation ActorRotation;
+
+	FVector3f SkaterMeshLocation = FVector3f::ZeroVector;
+	FSkatingCompressedRotation SkaterMeshRotation;
+
+	FVector3f SkateboardLocation = FVector3f::ZeroVector;
+	FSkatingCompressedRotation SkateboardRotation;
+};
+
+struct FSkaterReplayEvent
+{
+	/** Recorded frame the event happened in */
+	uint32 Frame = 0;
+
+	ESkaterReplayEventType Type = ESkaterReplayEventType::TrickStarted;
+
+	bool bWasSuccessful = false;
+
+	FSkatingTrickHandle Trick;
+};
+
+/** Bone whose parent space rotation is buffered */
+struct FSkaterReplayBone
+{
+	FName Name;
+	int32 BoneIndex = INDEX_NONE;
+	int32 ParentIndex = INDEX_NONE;
+
+	/** Index of the bone on the replay proxy, INDEX_NONE if the proxy doesn't have it */
+	int32 ProxyBoneIndex = INDEX_NONE;
+};
+
+/**
+ * Keeps the last BufferSeconds of owner skater in a ring buffer allocated once at BeginPlay, for instant replays.
+ * Frames hold the actor and mesh transforms, quantized parent space rotations of tracked bones and trick and bail events.
+ * Replaying freezes the buffer and drives poseable proxy meshes from it, the skater itself isn't touched.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent, ValidOwnerClass = "SkaterCharacter"))
+class SKATEBOARDINGSIM_API USkaterInstantReplayComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USkaterInstantReplayComponent();
+
+	/**
+	 * Replays the last Seconds of the buffer, or all of it if Seconds isn't positive, on the proxy meshes.
+	 * Proxies should use the same meshes as the skater, either can be null. Returns whether there was anything to replay.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Instant Replay")
+	bool StartReplay(UPoseableMeshComponent* InSkaterProxy, UPoseableMeshComponent* InSkateboardProxy, const float Seconds = 0.f);
+
+	/** Stops replaying and starts buffering from scratch */
+	UFUNCTION(BlueprintCallable, Category = "Instant Replay")
+	void StopReplay();
+
+	UFUNCTION(BlueprintPure, Category = "Instant Replay")
+	FORCEINLINE ESkaterInstantReplayMode GetMode() const { return Mode; }
+
+	UFUNCTION(BlueprintPure, Category = "Instant Replay")
+	FORCEINLINE float GetReplayTime() const { return ReplayTime; }
+
+	UFUNCTION(BlueprintPure, Category = "Instant Replay")
+	float GetReplayDuration() const;
+
+	/** Seconds currently buffered and available for a replay */
+	UFUNCTION(BlueprintPure, Category = "Instant Replay")
+	float GetBufferedSeconds() const;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void RecordFrame();
+
+	void RecordEvent(const ESkaterReplayEventType Type, const FSkatingTrickHandle Trick, const bool bWasSuccessful);
+
+	/** Applies the buffer at ReplayTime to the proxies and broadcasts events reached since last time */
+	void ApplyReplayTime();
+
+	FORCEINLINE int32 GetFrameSlot(const uint32 Frame) const { return static_cast<int32>(Frame % static_cast<uint32>(Frames.Num())); }
+
+	/** Oldest frame still buffered since recording (re)started */
+	uint32 GetFirstBufferedFrame() const;
+
+	void OnTrickStarted(const FSkatingTrickStartedEvent& Event);
+	void OnTrickEnded(const FSkatingTrickEndedEvent& Event);
+	void OnBailed(const FSkatingBailedEvent& Event);
+
+	/** Tricks without an event subsystem, broadcast directly by the tricks component */
+	UFUNCTION()
+	void OnSkatingTrickStarted(const FSkatingTrickHandle SkatingTrick);
+
+	UFUNCTION()
+	void OnSkatingTrickEnded(const FSkatingTrickHandle SkatingTrick, bool bWasSuccessful);
+
+public:
+	/** Called during replays as they reach a buffered trick or bail */
+	UPROPERTY(BlueprintAssignable)
+	FOnSkaterReplayEvent OnReplayEvent;
+
+	/** Called once a replay reached its end, buffering starts over right after */
+	UPROPERTY(BlueprintAssignable)
+	FOnSkaterReplayFinished OnReplayFinished;
+
+private:
+	/** Seconds kept in the buffer, memory is allocated for all of them at BeginPlay */
+	UPROPERTY(EditAnywhere, Category = "Config", meta = (UIMin = "1", ClampMin = "1", Units = "Seconds"))
+	float BufferSeconds = 10.f;
+
+	/** Time between buffered frames, replays interpolate between them */
+	UPROPERTY(EditAnywhere, Category = "Config", meta = (UIMin = "0.005", ClampMin = "0.005", Units = "Seconds"))
+	float SampleInterval = 1.f / 30.f;
+
+	/** Character mesh bones to buffer, all of them if empty */
+	UPROPERTY(EditAnywhere, Category = "Config")
+	TArray<FName> SkaterBones;
+
+	/** Skateboard bones to buffer, all of them if empty */
+	UPROPERTY(EditAnywhere, Category = "Config")
+	TArray<FName> SkateboardBones;
+
+	/** Most recent trick and bail events kept, older ones are overwritten */
+	UPROPERTY(EditAnywhere, Category = "Config", meta = (UIMin = "1", ClampMin = "1"))
+	int32 MaxEvents = 64;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	ESkaterInstantReplayMode Mode = ESkaterInstantReplayMode::Recording;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	float ReplayTime = 0.f;
+
+	float TimeSinceLastSample = 0.f;
+
+	/** Frames recorded in total, the ring buffer holds the last ones */
+	uint32 NumRecordedFrames = 0;
+
+	/** First frame recorded since last (re)start, frames before it belong to a replayed buffer */
+	uint32 RecordingStartFrame = 0;
+
+	uint32 NumRecordedEvents = 0;
+
+	/** Frames replayed from ReplayFirstFrame on */
+	uint32 ReplayFirstFrame = 0;
+	uint32 ReplayNumFrames = 0;
+
+	/** Next event broadcast during the replay */
+	uint32 NextReplayEvent = 0;
+
+	TArray<FSkaterReplayFrame> Frames;
+
+	/** Rotations of SkaterTrackedBones then SkateboardTrackedBones, for every frame */
+	TArray<FSkatingCompressedRotation> BoneRotations;
+
+	TArray<FSkaterReplayEvent> Events;
+
+	TArray<FSkaterReplayBone> SkaterTrackedBones;
+	TArray<FSkaterReplayBone> SkateboardTrackedBones;
+
+	int32 NumTrackedBones = 0;
+
+	UPROPERTY()
+	TObjectPtr<USkeletalMeshComponent> SkaterMesh;
+
+	UPROPERTY()
+	TObjectPtr<USkeletalMeshComponent> SkateboardMesh;
+
+	UPROPERTY()
+	TObjectPtr<UPoseableMeshComponent> SkaterProxy;
+
+	UPROPERTY()
+	TObjectPtr<UPoseableMeshComponent> SkateboardProxy;
+
+	UPROPERTY()
+	TObjectPtr<USkatingTricksComponent> SkatingTricksComponent;
+
+	UPROPERTY()
+	TObjectPtr<USkatingEventSubsystem> EventSubsystem;
+
+	FDelegateHandle TrickStartedHandle;
+	FDelegateHandle TrickEndedHandle;
+	FDelegateHandle BailedHandle;
+
+	/** Bails are polled while recording without an event subsystem */
+	bool bWasBailing = false;
+};
@@ -0,0 +1,101 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SkaterSignificanceSubsystem.generated.h"
+
+class ASkaterCharacter;
+
+/** How much work a skater gets per frame, from most to least */
+UENUM(BlueprintType)
+enum class ESkaterSignificanceTier : uint8
+{
+	Full,
+	Reduced,
+	Minimal
+};
+
+/** Update rates applied to skaters in a significance tier */
+USTRUCT(BlueprintType)
+struct SKATEBOARDINGSIM_API FSkaterSignificanceTierSettings
+{
+	GENERATED_BODY()
+
+	/** Min significance (skater bounds radius over distance to the closest local player) to be in this tier */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float MinSignificance = 0.f;
+
+	/** Tick interval of the skater and its movement, 0 ticks every frame */
+	UPROPERTY(EditAnywhere, Category = "Significance", meta = (UIMin = "0", ClampMin = "0", Units = "Seconds"))
+	float TickInterval = 0.f;
+
+	/** Lets character and skateboard meshes skip animation updates based on screen size */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	bool bEnableAnimationURO = false;
+
+	/** Only tick animation poses when meshes are rendered */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	bool bOnlyTickPoseWhenRendered = false;
+
+	/** Slope adaptation runs once every this many fixed steps, catching up on skipped time */
+	UPROPERTY(EditAnywhere, Category = "Significance", meta = (UIMin = "1", ClampMin = "1"))
+	int32 SlopeAdaptionStepInterval = 1;
+
+	/** Only one floor query out of this many reaches the physics scene, the others reuse the current floor */
+	UPROPERTY(EditAnywhere, Category = "Significance", meta = (UIMin = "1", ClampMin = "1"))
+	int32 FloorQueryInterval = 1;
+
+	/** Bails play a baked montage instead of simulating ragdolls */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	bool bUseBakedBail = false;
+};
+
+/**
+ * World Subsystem scoring skaters through the Significance Manager by their screen size
+ * from every local player (split-screen included) and applying update rates of matching tiers
+ */
+UCLASS(Config = Game)
+class SKATEBOARDINGSIM_API USkaterSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	USkaterSignificanceSubsystem();
+
+	void RegisterSkater(ASkaterCharacter* Skater);
+
+	void UnregisterSkater(ASkaterCharacter* Skater);
+
+	const FSkaterSignificanceTierSettings& GetTierSettings(const ESkaterSignificanceTier Tier) const;
+
+	//~ Begin FTickableGameObject Interface.
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return NumRegisteredSkaters > 0; }
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface.
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	ESkaterSignificanceTier GetTierForSignificance(const float Significance) const;
+
+	static float CalculateSignificance(const ASkaterCharacter* Skater, const FTransform& Viewpoint);
+
+private:
+	UPROPERTY(Config)
+	FSkaterSignificanceTierSettings FullTierSettings;
+
+	UPROPERTY(Config)
+	FSkaterSignificanceTierSettings ReducedTierSettings;
+
+	UPROPERTY(Config)
+	FSkaterSignificanceTierSettings MinimalTierSettings;
+
+	/** Local player viewpoints, reused every frame */
+	TArray<FTransform> Viewpoints;
+
+	int32 NumRegisteredSkaters = 0;
+};
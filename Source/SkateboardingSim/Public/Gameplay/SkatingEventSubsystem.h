@@ -0,0 +1,223 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/TVariant.h"
+#include "Movement/SkatingTrickRegistry.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SkatingEventSubsystem.generated.h"
+
+class AActor;
+class ACharacter;
+
+// Skating Events, pointers are only guaranteed valid during the frame the event is posted in
+
+struct FSkatingTrickStartedEvent
+{
+	ACharacter* Skater = nullptr;
+	FSkatingTrickHandle Trick;
+};
+
+struct FSkatingTrickEndedEvent
+{
+	ACharacter* Skater = nullptr;
+	FSkatingTrickHandle Trick;
+	bool bWasSuccessful = false;
+};
+
+struct FSkatingLandedEvent
+{
+	ACharacter* Skater = nullptr;
+	FVector Location = FVector::ZeroVector;
+	FVector Normal = FVector::UpVector;
+};
+
+struct FSkatingBailedEvent
+{
+	ACharacter* Skater = nullptr;
+};
+
+struct FSkatingGrindStartedEvent
+{
+	ACharacter* Skater = nullptr;
+	UObject* Grindable = nullptr;
+};
+
+struct FSkatingGrindEndedEvent
+{
+	ACharacter* Skater = nullptr;
+	UObject* Grindable = nullptr;
+};
+
+struct FSkatingScoreAddedEvent
+{
+	AActor* Owner = nullptr;
+	float AddedScore = 0.f;
+	float TotalScore = 0.f;
+};
+
+/** Actor an event is about, listeners of a single skater bind to it */
+template <typename TEvent>
+FORCEINLINE const AActor* GetSkatingEventSkater(const TEvent& Event) { return Event.Skater; }
+
+FORCEINLINE const AActor* GetSkatingEventSkater(const FSkatingScoreAddedEvent& Event) { return Event.Owner; }
+
+/** Queue of typed events dispatched in post order, each event type has its own native delegate and one per skater */
+template <typename... TEvents>
+class TSkatingEventQueue
+{
+public:
+	using FEvent = TVariant<TEvents...>;
+
+	template <typename TEvent>
+	using TDelegate = TMulticastDelegate<void(const TEvent&)>;
+
+	/** Delegates are heap allocated so listeners binding new skaters during dispatch don't move the one broadcasting */
+	template <typename TEvent>
+	using TSkaterDelegates = TMap<const AActor*, TUniquePtr<TDelegate<TEvent>>>;
+
+	template <typename TEvent>
+	void Post(const TEvent& Event)
+	{
+		Pending.Emplace(TInPlaceType<TEvent>(), Event);
+	}
+
+	template <typename TEvent>
+	TDelegate<TEvent>& OnEvent()
+	{
+		return Delegates.template Get<FEvent::template IndexOfType<TEvent>()>();
+	}
+
+	template <typename TEvent>
+	TDelegate<TEvent>& OnEvent(const AActor* Skater)
+	{
+		TUniquePtr<TDelegate<TEvent>>& Delegate = GetSkaterDelegates<TEvent>().FindOrAdd(Skater);
+		if (!Delegate)
+		{
+			Delegate = MakeUnique<TDelegate<TEvent>>();
+		}
+
+		return *Delegate;
+	}
+
+	/** Unbinds a listener of Skater, its delegate is freed once no listener is left */
+	template <typename TEvent>
+	void Remove(const AActor* Skater, const FDelegateHandle Handle)
+	{
+		if (TUniquePtr<TDelegate<TEvent>>* Delegate = GetSkaterDelegates<TEvent>().Find(Skater))
+		{
+			(*Delegate)->Remove(Handle);
+			bHasUnboundSkaterDelegates |= !(*Delegate)->IsBound();
+		}
+	}
+
+	FORCEINLINE bool HasPendingEvents() const { return !Pending.IsEmpty(); }
+
+	/** Broadcasts pending events, events posted by listeners are dispatched in the same batch. Returns the number of dispatched events */
+	int32 Dispatch()
+	{
+		// Index based since listeners may post and grow Pending, each event is copied out for the same reason
+		int32 EventIndex = 0;
+		for (; EventIndex < Pending.Num(); ++EventIndex)
+		{
+			const FEvent Event = Pending[EventIndex];
+			Visit([this](const auto& TypedEvent)
+				{
+					using TEvent = std::decay_t<decltype(TypedEvent)>;
+
+					OnEvent<TEvent>().Broadcast(TypedEvent);
+
+					if (const TUniquePtr<TDelegate<TEvent>>* SkaterDelegate = GetSkaterDelegates<TEvent>().Find(GetSkatingEventSkater(TypedEvent)))
+					{
+						(*SkaterDelegate)->Broadcast(TypedEvent);
+					}
+				}, Event);
+		}
+
+		// Keep capacity so steady state posting doesn't allocate
+		Pending.Reset();
+
+		// Freed after dispatching, listeners may unbind while their delegate is broadcasting
+		if (bHasUnboundSkaterDelegates)
+		{
+			bHasUnboundSkaterDelegates = false;
+			VisitTupleElements([](auto& SkaterDelegatesOfType)
+				{
+					for (auto It = SkaterDelegatesOfType.CreateIterator(); It; ++It)
+					{
+						if (!It.Value()->IsBound())
+						{
+							It.RemoveCurrent();
+						}
+					}
+				}, SkaterDelegates);
+		}
+
+		return EventIndex;
+	}
+
+private:
+	template <typename TEvent>
+	FORCEINLINE TSkaterDelegates<TEvent>& GetSkaterDelegates()
+	{
+		return SkaterDelegates.template Get<FEvent::template IndexOfType<TEvent>()>();
+	}
+
+	TArray<FEvent> Pending;
+
+	TTuple<TDelegate<TEvents>...> Delegates;
+	TTuple<TSkaterDelegates<TEvents>...> SkaterDelegates;
+
+	bool bHasUnboundSkaterDelegates = false;
+};
+
+/**
+ * World Subsystem dispatching native skating events in one batch per frame, after actors and components ticked.
+ * Listeners bind with lambdas or member functions to OnEvent<T>(), or to OnEvent<T>(Skater) for events of a single skater
+ * so dispatching doesn't go through every skater's listeners. There's no reflection involved so posting and dispatching
+ * scale with many skaters. Blueprint facing delegates on components are broadcast next to posting.
+ * Only exists in game worlds, components fall back to direct calls elsewhere.
+ */
+UCLASS()
+class SKATEBOARDINGSIM_API USkatingEventSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	using FEventQueue = TSkatingEventQueue<
+		FSkatingTrickStartedEvent,
+		FSkatingTrickEndedEvent,
+		FSkatingLandedEvent,
+		FSkatingBailedEvent,
+		FSkatingGrindStartedEvent,
+		FSkatingGrindEndedEvent,
+		FSkatingScoreAddedEvent>;
+
+	/** Queues Event for dispatch at the end of the frame */
+	template <typename TEvent>
+	FORCEINLINE void Post(const TEvent& Event) { EventQueue.Post(Event); }
+
+	/** Delegate broadcast for every dispatched event of type TEvent */
+	template <typename TEvent>
+	FORCEINLINE FEventQueue::TDelegate<TEvent>& OnEvent() { return EventQueue.OnEvent<TEvent>(); }
+
+	/** Delegate broadcast for every dispatched event of type TEvent about Skater, unbind with RemoveListener */
+	template <typename TEvent>
+	FORCEINLINE FEventQueue::TDelegate<TEvent>& OnEvent(const AActor* Skater) { return EventQueue.OnEvent<TEvent>(Skater); }
+
+	template <typename TEvent>
+	FORCEINLINE void RemoveListener(const AActor* Skater, const FDelegateHandle Handle) { EventQueue.Remove<TEvent>(Skater, Handle); }
+
+	//~ Begin FTickableGameObject Interface.
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return EventQueue.HasPendingEvents(); }
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface.
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	FEventQueue EventQueue;
+};
@@ -0,0 +1,132 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkaterCrowdSimulation.generated.h"
+
+/** What a crowd skater is currently doing */
+UENUM()
+enum class ESkaterCrowdMode : uint8
+{
+	Rolling,
+	ChargingOllie,
+	Airborne
+};
+
+/** Tuning shared by all skaters of a crowd, defaults match USkatingMovementComponent */
+USTRUCT(BlueprintType)
+struct SKATEBOARDINGSIM_API FSkaterCrowdSettings
+{
+	GENERATED_BODY()
+
+	FSkaterCrowdSettings();
+
+	/** Controls how fast we adapt rotation to slope */
+	UPROPERTY(EditAnywhere, Category = "Ground")
+	float SlopeAdaptionSpeed = 25.f;
+
+	/** Controls how fast we can steer backwards */
+	UPROPERTY(EditAnywhere, Category = "Ground")
+	float BackwardSteeringStrength = 10.f;
+
+	/** Speed scale added when a skater pushes */
+	UPROPERTY(EditAnywhere, Category = "Ground", meta = (UIMin = "0", UIMax = "1", ClampMin = "0", ClampMax = "1"))
+	float SpeedUpDelta = 0.5f;
+
+	/** Speed scale added when a skater slows down */
+	UPROPERTY(EditAnywhere, Category = "Ground", meta = (UIMax = "0", ClampMax = "0"))
+	float SlowDownDelta = -0.01f;
+
+	UPROPERTY(EditAnywhere, Category = "Ground", meta = (UIMin = "0", UIMax = "1", ClampMin = "0", ClampMax = "1"))
+	float MaxSpeedScale = 1.f;
+
+	/** Skaters push below this speed scale and slow down above it */
+	UPROPERTY(EditAnywhere, Category = "Ground", meta = (UIMin = "0", UIMax = "1", ClampMin = "0", ClampMax = "1"))
+	float CruiseSpeedScale = 0.5f;
+
+	/** How fast skaters turn towards their movement direction, in degrees per second */
+	UPROPERTY(EditAnywhere, Category = "Ground")
+	float TurnRate = 100.f;
+
+	/** Ground Speed Range based on OllyingAlpha */
+	UPROPERTY(EditAnywhere, Category = "Ollying")
+	FFloatRange OllyingGroundSpeedRange;
+
+	/** Jump Speed Range based on OllyingAlpha */
+	UPROPERTY(EditAnywhere, Category = "Ollying")
+	FFloatRange OllyingJumpSpeedRange;
+
+	/** Controls how fast we interp OllyingAlpha */
+	UPROPERTY(EditAnywhere, Category = "Ollying")
+	float OllyingInterpSpeed = 2.f;
+
+	/** Chance to start charging an ollie every decision */
+	UPROPERTY(EditAnywhere, Category = "Ollying", meta = (UIMin = "0", UIMax = "1", ClampMin = "0", ClampMax = "1"))
+	float OllieChance = 0.1f;
+
+	UPROPERTY(EditAnywhere, Category = "InAir")
+	float GravityZ = -1715.f;
+
+	/** Time range between two steering/pushing decisions */
+	UPROPERTY(EditAnywhere, Category = "Decisions", meta = (Units = "Seconds"))
+	FFloatRange DecisionInterval;
+};
+
+/**
+ * State of many lightweight skaters kept in parallel arrays (SoA),
+ * stepped in a few passes over contiguous memory instead of one virtual call chain per skater.
+ * Ground movement passes are branch free float math, skaters a pass doesn't apply to get a zero delta rather than being skipped.
+ * Floor results are written by the owner (see ASkaterCrowd) before stepping.
+ */
+struct SKATEBOARDINGSIM_API FSkaterCrowdState
+{
+	TArray<FVector> Positions;
+	TArray<float> Yaws;
+	TArray<float> Pitches;
+	TArray<float> Rolls;
+	TArray<float> SpeedScales;
+	TArray<float> OllyingAlphas;
+	TArray<float> VerticalSpeeds;
+	TArray<ESkaterCrowdMode> Modes;
+
+	/** Steering input in [-1, 1] each skater keeps until its next decision */
+	TArray<float> SteerInputs;
+	TArray<float> DecisionTimers;
+
+	TArray<FVector> FloorNormals;
+	TArray<float> FloorHeights;
+	/** Whether the last floor trace hit, bytes rather than bits so passes stay branch friendly */
+	TArray<uint8> HasFloor;
+
+	FRandomStream RandomStream;
+
+	/** Scratch of the ground movement passes, kept allocated between steps */
+	TArray<float> YawSines;
+	TArray<float> YawCosines;
+	TArray<float> MoveInputsX;
+	TArray<float> MoveInputsY;
+
+	void Reset(const int32 NumSkaters, const int32 Seed);
+
+	void AddSkater(const FVector& Location, const float Yaw);
+
+	/** Runs one step of decisions, ollies, steering, slope adaptation and integration for all skaters */
+	void Step(const FSkaterCrowdSettings& Settings, const float DeltaSeconds);
+
+	FORCEINLINE int32 Num() const { return Positions.Num(); }
+
+	FORCEINLINE FRotator GetRotation(const int32 SkaterIndex) const { return FRotator(Pitches[SkaterIndex], Yaws[SkaterIndex], Rolls[SkaterIndex]); }
+
+private:
+	void StepDecisions(const FSkaterCrowdSettings& Settings, const float DeltaSeconds);
+
+	void StepOllies(const FSkaterCrowdSettings& Settings, const float DeltaSeconds);
+
+	void StepGroundMovement(const FSkaterCrowdSettings& Settings, const float DeltaSeconds);
+
+	/** Fills YawSines and YawCosines from Yaws */
+	void ComputeYawSinCos();
+
+	void StepVerticalMovement(const FSkaterCrowdSettings& Settings, const float DeltaSeconds);
+};
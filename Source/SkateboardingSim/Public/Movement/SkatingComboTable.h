@@ -0,0 +1,104 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkatingComboTable.generated.h"
+
+struct FSkatingTrick;
+
+/** Input symbols trick combos are made of */
+UENUM(BlueprintType)
+enum class ESkatingTrickInput : uint8
+{
+	Up,
+	Down,
+	Left,
+	Right,
+	Ollie,
+	Flip,
+	Grind,
+	Num UMETA(Hidden)
+};
+
+/** Movement states a trick can be started from */
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ESkatingTrickMovementState : uint8
+{
+	None = 0 UMETA(Hidden),
+	OnGround = 1 << 0,
+	InAir = 1 << 1,
+	Grinding = 1 << 2
+};
+ENUM_CLASS_FLAGS(ESkatingTrickMovementState);
+
+/** An input received by the combo engine */
+struct FSkatingComboInput
+{
+	ESkatingTrickInput Input = ESkatingTrickInput::Num;
+	double Time = 0.0;
+};
+
+/** Per skater combo progress: current table state and the last inputs in a fixed ring buffer */
+struct SKATEBOARDINGSIM_API FSkatingComboState
+{
+	static constexpr int32 MaxInputs = 16;
+
+	void Reset();
+
+	void AddInput(const FSkatingComboInput& ComboInput);
+
+	/** Input received Age inputs ago, 0 being the latest. Age must be below GetNumInputs() */
+	FORCEINLINE const FSkatingComboInput& GetInput(const int32 Age) const
+	{
+		return Inputs[(NextInput - 1 - Age + MaxInputs) % MaxInputs];
+	}
+
+	FORCEINLINE int32 GetNumInputs() const { return NumInputs; }
+
+	/** State of the compiled combo table */
+	uint16 TableState = 0;
+
+private:
+	TStaticArray<FSkatingComboInput, MaxInputs> Inputs;
+
+	int32 NextInput = 0;
+	int32 NumInputs = 0;
+};
+
+/**
+ * Trick input sequences compiled into a DFA (Aho-Corasick automaton) stored as a flat transition table,
+ * advancing on an input and finding the tricks it completes costs the same regardless of the number of tricks
+ */
+struct SKATEBOARDINGSIM_API FSkatingComboTable
+{
+	/** Builds the table from InputSequence of Tricks, tricks without a sequence are skipped */
+	void Compile(TConstArrayView<FSkatingTrick> Tricks);
+
+	void Reset();
+
+	FORCEINLINE bool IsEmpty() const { return NumStates <= 1; }
+
+	FORCEINLINE uint16 Advance(const uint16 State, const ESkatingTrickInput Input) const
+	{
+		return Transitions[State * NumInputSymbols + static_cast<int32>(Input)];
+	}
+
+	/** Indices of tricks whose sequence ends at State, longest sequences first */
+	FORCEINLINE TConstArrayView<int32> GetMatches(const uint16 State) const
+	{
+		return TConstArrayView<int32>(Matches.GetData() + MatchStarts[State], MatchStarts[State + 1] - MatchStarts[State]);
+	}
+
+private:
+	static constexpr int32 NumInputSymbols = static_cast<int32>(ESkatingTrickInput::Num);
+
+	/** NumStates * NumInputSymbols next states, state 0 being the root */
+	TArray<uint16> Transitions;
+
+	/** Matches of state S are Matches[MatchStarts[S], MatchStarts[S + 1]) */
+	TArray<int32> MatchStarts;
+	TArray<int32> Matches;
+
+	int32 NumStates = 0;
+};
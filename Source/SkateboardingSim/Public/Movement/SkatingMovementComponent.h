@@ -4,14 +4,49 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Movement/SkatingNetworkMoveData.h"
+#include "WorldCollision.h"
 #include "SkatingMovementComponent.generated.h"
 
+class UAnimMontage;
+class USkatingEventSubsystem;
+struct FSkaterSignificanceTierSettings;
+
+
+/** How a bail is currently driving the meshes */
+UENUM()
+enum class ESkatingBailPhase : uint8
+{
+	None,
+	/** Ragdoll bodies simulating, blending from animation to physics */
+	BlendingIn,
+	Simulating,
+	/** Recovering, blending from physics back to animation */
+	BlendingOut,
+	/** Playing the baked bail montage without physics */
+	Baked
+};
+
+/** Board and character orientation captured once per frame, so every bail check in a frame agrees */
+struct FSkatingLandingSnapshot
+{
+	/** GFrameCounter of the frame this snapshot was taken at */
+	uint64 Frame = MAX_uint64;
+
+	FQuat SkateboardRotation = FQuat::Identity;
+	FQuat CharacterRotation = FQuat::Identity;
+
+	bool bShouldBail = false;
+};
 
 /** Character Movement Component with Skating Capability like Steering, Ollying, Grinding, etc. */
 UCLASS()
 class SKATEBOARDINGSIM_API USkatingMovementComponent : public UCharacterMovementComponent
 {
 	GENERATED_BODY()
+
+	friend class FSavedMove_Skating;
+	friend struct FSkatingMoveResponseDataContainer;
 	
 public:
 	USkatingMovementComponent();
@@ -22,14 +57,68 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
 	/** Handles rotation in different movement modes (e.g. steering, rotating in air, balancing, etc.) */
 	void HandleMoveInput(const float XValue, const float YValue);
 
 	virtual bool CanAttemptJump() const override;
 
+	/** Scales movement update rates, see USkaterSignificanceSubsystem */
+	void ApplySignificanceTier(const FSkaterSignificanceTierSettings& TierSettings);
+
+	/** Number of floor and grindable physics queries issued by all skaters, used for benchmarking */
+	static FORCEINLINE uint32 GetNumPhysicsQueries() { return NumPhysicsQueries; }
+
 protected:
 	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
 
+	/** Runs fixed skating steps after each move, so they're predicted and replayed like the rest of the move */
+	virtual void PerformMovement(float DeltaTime) override;
+
+	// Networking
+public:
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	/** Bits of moves and move responses received for this skater over the last second */
+	UFUNCTION(BlueprintPure, Category = "Movement|Networking")
+	FORCEINLINE int32 GetNetBitsPerSecond() const { return NetBitsPerSecond; }
+
+	/** Corrections this client received from the server since it spawned */
+	FORCEINLINE int32 GetNumClientCorrections() const { return NumClientCorrections; }
+
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	/** Applies the client's speed scale and the grinding it started before running its move */
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+	/** Also corrects clients whose ollie or grinding state diverged */
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+	virtual void OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode, FVector ServerGravityDirection) override;
+
+	virtual bool ClientUpdatePositionAfterServerUpdate() override;
+
+	virtual void ServerMovePacked_ServerReceive(const FCharacterServerMovePackedBits& PackedBits) override;
+
+	virtual void MoveResponsePacked_ClientReceive(const FCharacterMoveResponsePackedBits& PackedBits) override;
+
+	void CountNetBits(const int32 NumBits);
+
+	// Fixed Step
+public:
+	UFUNCTION(BlueprintPure, Category = "Movement|FixedStep")
+	FORCEINLINE float GetFixedStepSeconds() const { return 1.f / FixedStepRate; }
+
+protected:
+	/** Consumes accumulated frame time in fixed steps, bounded by MaxFixedStepsPerFrame */
+	void TickFixedSteps(const float DeltaSeconds);
+
+	/** Runs a single deterministic skating step (slope adaptation, ollie charging and speed scaling) */
+	UFUNCTION(BlueprintCallable, Category = "Movement|FixedStep")
+	void SimulateSkatingStep(const float StepSeconds);
+
 	// Ground Movement
 public:
 	UFUNCTION(BlueprintPure, Category = "Movement|Ground")
@@ -38,6 +127,8 @@ public:
 	void SpeedUp();
 	UFUNCTION(BlueprintCallable, Category = "Movement|Ground")
 	void SlowDown();
+	UFUNCTION(BlueprintPure, Category = "Movement|Ground")
+	FORCEINLINE float GetSpeedScale() const { return SpeedScale; }
 
 	UFUNCTION(BlueprintCallable, Category = "Movement|Ground")
 	void IncreaseOllyingAlpha();
@@ -47,6 +138,11 @@ public:
 protected:
 	virtual void MoveAlongFloor(const FVector& InVelocity, float DeltaSeconds, FStepDownResult* OutStepDownResult = NULL) override;
 
+	/** Slides the current floor plane under the capsule for skipped queries when FloorQueryInterval is above 1 */
+	virtual void FindFloor(const FVector& CapsuleLocation, FFindFloorResult& OutFloorResult, bool bCanUseCachedLocation, const FHitResult* DownwardSweepResult = NULL) const override;
+
+	virtual void ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult = NULL) const override;
+
 	UFUNCTION(BlueprintCallable, Category = "Movement|Ground")
 	void AdaptToFloorSlope(const float DeltaSeconds);
 
@@ -66,6 +162,10 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement|Ground")
 	void SyncMovementSpeedWithOllyingAlpha();
 
+	/** Increases OllyingAlpha by DeltaSeconds worth of charging */
+	UFUNCTION(BlueprintCallable, Category = "Movement|Ground")
+	void ChargeOllie(const float DeltaSeconds);
+
 
 	// Grinding
 public:
@@ -80,10 +180,28 @@ protected:
 	UFUNCTION(BlueprintPure, Category = "Movement|Grinding")
 	bool WasGrinding(TEnumAsByte<EMovementMode> PrevMovementMode, uint8 PrevCustomMode) const;
 
+	// Finds nearest grindable object below us that can be grinded on
+	UFUNCTION(BlueprintCallable, Category = "Movement|Grinding")
+	UObject* FindGrindableObstacle();
+
 	// Performs downward traces to find nearest grindable object and returns it if found
 	UFUNCTION(BlueprintCallable, Category = "Movement|Grinding")
 	TOptional<UObject*> TraceGrindableObstacles(FHitResult& OutHit);
 
+	/** Queues a grindable sweep batched with every other skater's, its result is consumed by a later grind attempt */
+	void QueueAsyncGrindSweep();
+
+	/** Returns the grindable found by the last async sweep if recent enough, nullptr otherwise */
+	UObject* ConsumeAsyncGrindCandidate();
+
+	void OnAsyncGrindSweepCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceData);
+
+	/** Downward grindable sweep from the current location */
+	void GetGrindSweep(FVector& OutStart, FVector& OutEnd, FQuat& OutOrientation) const;
+
+	/** Grindable component of Hit's actor, if any */
+	static UObject* GetGrindableFromHit(const FHitResult& Hit);
+
 	UFUNCTION(BlueprintCallable, Category = "Movement|Grinding")
 	void StartGrinding(UObject* Grindable);
 
@@ -93,19 +211,34 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement|Grinding")
 	void Balance(float Value);
 
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	/** Moves the character along CurrentGrindable, substepped like the built-in movement modes */
+	void PhysGrinding(float deltaTime, int32 Iterations);
+
 public:
 	UFUNCTION(BlueprintPure, Category = "Movement|Grinding")
 	bool IsGrinding() const;
 
+	/** Grindable we're grinding on, nullptr if not grinding */
+	FORCEINLINE UObject* GetCurrentGrindable() const { return CurrentGrindable.IsSet() ? CurrentGrindable.GetValue().Get() : nullptr; }
+
+	/** Distance we've grinded along the current grindable */
+	float GetGrindingDistance() const;
+
 
 	// Bailing
 public:
 	UFUNCTION(BlueprintPure, Category = "Movement|Bailing")
 	bool IsBailing() const;
 
+	/** Whether landing this frame should bail, evaluated once per frame */
 	UFUNCTION(BlueprintCallable, Category = "Movement|Bailing")
 	bool ShouldBail() const;
 
+	/** Returns this frame's landing snapshot, capturing it on first use */
+	const FSkatingLandingSnapshot& GetLandingSnapshot() const;
+
 protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement|Bailing")
 	void StartBailing();
@@ -113,7 +246,14 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement|Bailing")
 	void StopBailing();
 
-	UFUNCTION()
+	/** Moves ragdoll physics blend weight towards its target and ends blending out once done */
+	void TickBailBlend(const float DeltaSeconds);
+
+	/** Turns ragdoll simulation on or off without rebuilding physics state */
+	void SetRagdollSimulation(const bool bSimulate);
+
+public:
+	/** Called by the owner when it lands, bails or recovers onto the skateboard */
 	void OnLanded(const FHitResult& Hit);
 
 private:
@@ -125,11 +265,80 @@ private:
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE void ResetRotationRate() { RotationRate = InitialRotationRate; }
 
+private:
+	/** Runs slope adaptation and ollie charging at a fixed rate instead of every frame */
+	UPROPERTY(EditAnywhere, Category = "Config|FixedStep")
+	bool bUseFixedStep = true;
+
+	/** Rate of fixed skating steps */
+	UPROPERTY(EditAnywhere, Category = "Config|FixedStep", meta = (EditCondition = "bUseFixedStep", UIMin = "10", ClampMin = "10", Units = "Hertz"))
+	float FixedStepRate = 60.f;
+
+	/** Max fixed steps per frame, time beyond this budget is dropped */
+	UPROPERTY(EditAnywhere, Category = "Config|FixedStep", meta = (EditCondition = "bUseFixedStep", UIMin = "1", ClampMin = "1"))
+	int32 MaxFixedStepsPerFrame = 4;
+
+	/** Frame time not yet consumed by fixed steps */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|FixedStep")
+	float FixedStepAccumulator = 0.f;
+
+	/** Whether ollie input is held, consumed by the next fixed step */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|FixedStep")
+	bool bIsChargingOllie = false;
+
+private:
+	/** Ollie alpha difference from the server above which a client gets corrected */
+	UPROPERTY(EditAnywhere, Category = "Config|Networking", meta = (UIMin = "0", UIMax = "1", ClampMin = "0", ClampMax = "1"))
+	float OllyingAlphaNetTolerance = 0.05f;
+
+	/** Grinding distance difference from the server above which a client gets corrected */
+	UPROPERTY(EditAnywhere, Category = "Config|Networking", meta = (UIMin = "0", ClampMin = "0", Units = "Centimeters"))
+	float GrindingDistanceNetTolerance = 10.f;
+
+	/** Measured over one second windows, see CountNetBits */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Networking")
+	int32 NetBitsPerSecond = 0;
+
+	int32 NetBitsInWindow = 0;
+	float NetWindowSeconds = 0.f;
+
+	int32 NumClientCorrections = 0;
+
+	/** Server grinding distance of the last correction, applied once its movement mode has been applied too */
+	TOptional<float> PendingGrindingDistance;
+
+	FSkatingNetworkMoveDataContainer SkatingNetworkMoveDataContainer;
+	FSkatingMoveResponseDataContainer SkatingMoveResponseDataContainer;
+
+private:
+	/** Slope adaptation runs once every this many fixed steps, set by significance */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Significance")
+	int32 SlopeAdaptionStepInterval = 1;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Significance")
+	int32 StepsSinceSlopeAdaption = 0;
+
+	/** Only one floor query out of this many reaches the physics scene, set by significance */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Significance")
+	int32 FloorQueryInterval = 1;
+
+	mutable int32 FloorQueriesSinceTrace = 0;
+
 private:
 	/** Controls how fast we adapt rotation to slope */
 	UPROPERTY(EditAnywhere, Category = "Config|Ground")
 	float SlopeAdaptionSpeed = 25.f;
 
+	/** Pitch and roll differences to the slope below this are left alone, so flat ground doesn't move the character */
+	UPROPERTY(EditAnywhere, Category = "Config|Ground", meta = (UIMin = "0", ClampMin = "0", Units = "Degrees"))
+	float SlopeAdaptionTolerance = 0.05f;
+
+	/** Floor normal the cached slope rotation was computed for */
+	FVector CachedSlopeFloorNormal = FVector::ZeroVector;
+
+	/** Slope rotation of CachedSlopeFloorNormal, its yaw is the one it was computed for */
+	FRotator CachedSlopeRotation = FRotator::ZeroRotator;
+
 	/** Controls how fast we can steer backwards */
 	UPROPERTY(EditAnywhere, Category = "Config|Ground")
 	float BackwardSteeringStrength = 10.f;
@@ -170,6 +379,20 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Config")
 	TArray<TEnumAsByte<EObjectTypeQuery>> GrindingObjectTypes;
 
+	/** Frames an async grindable sweep result stays usable, candidates are still validated against our current location */
+	UPROPERTY(EditAnywhere, Category = "Config|Grinding", meta = (UIMin = "1", ClampMin = "1"))
+	int32 AsyncGrindCandidateMaxAge = 2;
+
+	/** Grindable found by the last async sweep, consumed by the next grind attempt */
+	TWeakObjectPtr<UObject> AsyncGrindCandidate;
+
+	/** GFrameCounter the last async grindable sweep was queued at */
+	uint64 AsyncGrindSweepFrame = 0;
+
+	bool bIsAsyncGrindSweepPending = false;
+
+	FTraceDelegate AsyncGrindSweepDelegate;
+
 	/** Current Object we're grinding on */
 	UPROPERTY(VisibleInstanceOnly, Category = "State|Grinding")
 	TOptional<TObjectPtr<UObject>> CurrentGrindable;
@@ -199,6 +422,31 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Config|Bailing")
 	FCollisionProfileName BailingCollisionProfileName = FCollisionProfileName("Ragdoll");
 
+	/** Time to blend from animation to ragdoll when bailing */
+	UPROPERTY(EditAnywhere, Category = "Config|Bailing", meta = (UIMin = "0", ClampMin = "0", Units = "Seconds"))
+	float BailBlendInDuration = 0.15f;
+
+	/** Time to blend from ragdoll back to animation when recovering */
+	UPROPERTY(EditAnywhere, Category = "Config|Bailing", meta = (UIMin = "0", ClampMin = "0", Units = "Seconds"))
+	float BailBlendOutDuration = 0.3f;
+
+	/** Montage played instead of ragdoll physics when bailing with bUseBakedBail */
+	UPROPERTY(EditAnywhere, Category = "Config|Bailing")
+	TObjectPtr<UAnimMontage> BakedBailMontage;
+
+	/** Whether bails play BakedBailMontage instead of simulating, set by significance */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Bailing")
+	bool bUseBakedBail = false;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Bailing")
+	ESkatingBailPhase BailPhase = ESkatingBailPhase::None;
+
+	/** Current ragdoll physics blend weight of the character mesh */
+	UPROPERTY(VisibleInstanceOnly, Category = "State|Bailing")
+	float BailBlendWeight = 0.f;
+
+	FTimerHandle StopBailingTimerHandle;
+
 private:
 	/** Ground Speed Range based on OllyingAlpha */
 	UPROPERTY(EditAnywhere, Category = "Config|Ollying")
@@ -229,5 +477,14 @@ private:
 	UPROPERTY()
 	TObjectPtr<USkeletalMeshComponent> SkateboardMesh;
 
-	FName SkateboardRootBoneName;
+	/** Skating events are posted to it, cached on BeginPlay */
+	UPROPERTY()
+	TObjectPtr<USkatingEventSubsystem> EventSubsystem;
+
+	/** Skateboard bone checked for bailing, the root bone */
+	int32 SkateboardRootBoneIndex = INDEX_NONE;
+
+	mutable FSkatingLandingSnapshot LandingSnapshot;
+
+	static uint32 NumPhysicsQueries;
 };
@@ -0,0 +1,95 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/SkatingQuantization.h"
+
+/**
+ * Stateless skating rules shared by USkatingMovementComponent and the batched crowd simulation,
+ * so both kinds of skaters steer, adapt to slopes and change speed the same way
+ */
+namespace SkatingMovementRules
+{
+	/** Direction Steer feeds to movement input for a skater facing Yaw and Roll */
+	FORCEINLINE FVector ComputeSteerDirection(const float Yaw, const float Roll, const float XValue, const float YValue, const float BackwardSteeringStrength)
+	{
+		const FRotator RotationWithoutPitch = FRotator(0.f, Yaw, Roll);
+
+		return (FRotationMatrix(RotationWithoutPitch).GetScaledAxis(EAxis::Y) * XValue) + (RotationWithoutPitch.Vector() * (YValue < 0 ? -BackwardSteeringStrength : 1.f)).Normalize();
+	}
+
+	/** Movement input scale Steer applies along its direction */
+	FORCEINLINE float ComputeSteerScale(const float SpeedScale, const float XValue)
+	{
+		return SpeedScale * FMath::Abs(XValue);
+	}
+
+	/**
+	 * Pitch and roll aligning a skater whose yaw has SinYaw and CosYaw with FloorNormal.
+	 * Solved directly from the normal in the yaw frame, the up axis of (Pitch, 0, Roll) is (-cos(Roll) sin(Pitch), sin(Roll), cos(Roll) cos(Pitch))
+	 */
+	FORCEINLINE void ComputeSlopePitchRoll(const float SinYaw, const float CosYaw, const FVector& FloorNormal, float& OutPitch, float& OutRoll)
+	{
+		const float NormalForward = static_cast<float>(FloorNormal.X * CosYaw + FloorNormal.Y * SinYaw);
+		const float NormalRight = static_cast<float>(FloorNormal.Y * CosYaw - FloorNormal.X * SinYaw);
+
+		OutPitch = FMath::RadiansToDegrees(FMath::Atan2(-NormalForward, static_cast<float>(FloorNormal.Z)));
+		OutRoll = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(NormalRight, -1.f, 1.f)));
+	}
+
+	/** Rotation keeping CurrentRotation's yaw while aligning pitch and roll with FloorNormal */
+	FORCEINLINE FRotator ComputeSlopeRotation(const FRotator& CurrentRotation, const FVector& FloorNormal)
+	{
+		float SinYaw, CosYaw;
+		FMath::SinCos(&SinYaw, &CosYaw, FMath::DegreesToRadians(static_cast<float>(CurrentRotation.Yaw)));
+
+		float TargetPitch, TargetRoll;
+		ComputeSlopePitchRoll(SinYaw, CosYaw, FloorNormal, TargetPitch, TargetRoll);
+
+		return FRotator(TargetPitch, CurrentRotation.Yaw, TargetRoll);
+	}
+
+	/** Angle in degrees moved from Current towards Target by at most MaxDelta the short way round, normalized like FMath::RInterpConstantTo's axes */
+	FORCEINLINE float StepAngleTowards(const float Current, const float Target, const float MaxDelta)
+	{
+		return FRotator3f::NormalizeAxis(Current + FMath::Clamp(FRotator3f::NormalizeAxis(Target - Current), -MaxDelta, MaxDelta));
+	}
+
+	/** Rotation after adapting to FloorNormal for DeltaSeconds at AdaptionSpeed */
+	FORCEINLINE FRotator AdaptRotationToSlope(const FRotator& CurrentRotation, const FVector& FloorNormal, const float DeltaSeconds, const float AdaptionSpeed)
+	{
+		return FMath::RInterpConstantTo(CurrentRotation, ComputeSlopeRotation(CurrentRotation, FloorNormal), DeltaSeconds, AdaptionSpeed);
+	}
+
+	/**
+	 * SpeedScale after applying Delta, clamped to [0, MaxSpeedScale] and snapped to the byte network moves send it as,
+	 * so servers replaying moves simulate with the same value. Changes below a quantization step still take a full step,
+	 * otherwise slowing down would stall
+	 */
+	FORCEINLINE float ChangeSpeedScale(const float SpeedScale, const float Delta, const float MaxSpeedScale)
+	{
+		const int32 OldQuantizedSpeedScale = SkatingQuantization::QuantizeUnitFloat8(SpeedScale);
+		int32 QuantizedSpeedScale = SkatingQuantization::QuantizeUnitFloat8(SpeedScale + Delta);
+		if (QuantizedSpeedScale == OldQuantizedSpeedScale && Delta != 0.f)
+		{
+			QuantizedSpeedScale += Delta > 0.f ? 1 : -1;
+		}
+
+		// Rounded down, the server clamps to MaxSpeedScale
+		const int32 MaxQuantizedSpeedScale = FMath::FloorToInt32(FMath::Clamp(MaxSpeedScale, 0.f, 1.f) * MAX_uint8);
+		return SkatingQuantization::DequantizeUnitFloat8(static_cast<uint8>(FMath::Clamp(QuantizedSpeedScale, 0, MaxQuantizedSpeedScale)));
+	}
+
+	/** OllyingAlpha after charging for DeltaSeconds */
+	FORCEINLINE float ChargeOllyingAlpha(const float OllyingAlpha, const float InterpSpeed, const float DeltaSeconds)
+	{
+		return FMath::Min(1.f, OllyingAlpha + (InterpSpeed * DeltaSeconds));
+	}
+
+	/** Value in Range matching OllyingAlpha, used for both ground and jump speeds */
+	FORCEINLINE float GetOllyingSpeed(const FFloatRange& Range, const float OllyingAlpha)
+	{
+		return FMath::Lerp(Range.GetLowerBoundValue(), Range.GetUpperBoundValue(), OllyingAlpha);
+	}
+}
@@ -0,0 +1,97 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/CharacterMovementReplication.h"
+
+class USkatingMovementComponent;
+
+/** Skating state of a move, saved on the client to send and replay it */
+class SKATEBOARDINGSIM_API FSavedMove_Skating : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	//~ Begin FSavedMove_Character Interface.
+	virtual void Clear() override;
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* Character) override;
+	virtual void PostUpdate(ACharacter* Character, EPostUpdateMode PostUpdateMode) override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	//~ End FSavedMove_Character Interface.
+
+	/** Inputs, restored when replaying the move */
+	float SpeedScale = 0.f;
+	float FixedStepAccumulator = 0.f;
+	bool bIsChargingOllie = false;
+
+	/** Simulated state at the end of the move, checked by the server */
+	float OllyingAlpha = 0.f;
+	TWeakObjectPtr<UObject> Grindable;
+	float GrindingDistance = 0.f;
+};
+
+class SKATEBOARDINGSIM_API FNetworkPredictionData_Client_Skating : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Skating(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/** Skating state sent with each move, quantized */
+struct SKATEBOARDINGSIM_API FSkatingNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	//~ Begin FCharacterNetworkMoveData Interface.
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+	//~ End FCharacterNetworkMoveData Interface.
+
+	uint8 QuantizedSpeedScale = 0;
+	uint8 QuantizedOllyingAlpha = 0;
+
+	/** Grindable the client is grinding on, nullptr if not grinding */
+	TObjectPtr<UObject> Grindable;
+	uint16 QuantizedGrindingDistance = 0;
+};
+
+struct SKATEBOARDINGSIM_API FSkatingNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FSkatingNetworkMoveDataContainer();
+
+private:
+	FSkatingNetworkMoveData SkatingMoveData[3];
+};
+
+/** Server skating state sent back with corrections */
+struct SKATEBOARDINGSIM_API FSkatingMoveResponseDataContainer : public FCharacterMoveResponseDataContainer
+{
+	typedef FCharacterMoveResponseDataContainer Super;
+
+	//~ Begin FCharacterMoveResponseDataContainer Interface.
+	virtual void ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+	//~ End FCharacterMoveResponseDataContainer Interface.
+
+	uint8 QuantizedSpeedScale = 0;
+	uint8 QuantizedOllyingAlpha = 0;
+
+	TObjectPtr<UObject> Grindable;
+	uint16 QuantizedGrindingDistance = 0;
+};
+
+namespace SkatingNetworkMoveData
+{
+	/** Precision of replicated grinding distances */
+	constexpr float GrindingDistancePrecision = 2.f;
+
+	/** Writes or reads an optional grindable and its distance */
+	bool SerializeGrindable(FArchive& Ar, UPackageMap* PackageMap, TObjectPtr<UObject>& Grindable, uint16& QuantizedGrindingDistance);
+}
@@ -0,0 +1,184 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Movement/SkatingComboTable.h"
+#include "SkatingTrickRegistry.generated.h"
+
+class UAnimMontage;
+struct FStreamableHandle;
+
+/** Represents a single skating trick like a Flip, a Grab, etc. */
+USTRUCT(BlueprintType)
+struct FSkatingTrick
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FName Name;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TSoftObjectPtr<UAnimMontage> SkaterMontage;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TSoftObjectPtr<UAnimMontage> SkateboardMontage;
+
+	/** Montages Play Rate */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float PlayRate = 1.f;
+
+	/** Score to Accumulate At the Start of trick */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float BaseScore = 50.f;
+
+	/** Score to Accumulate every second as the trick is performed */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float ScorePerSecond = 0.f;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Use ScorePerSecond, score no longer depends on frame rate"))
+	float ScorePerFrame_DEPRECATED = 0.f;
+
+	/** Inputs performing this trick as a combo, tricks without inputs are only performed explicitly */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Combo")
+	TArray<ESkatingTrickInput> InputSequence;
+
+	/** Movement states this trick can be started from */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Combo", meta = (Bitmask, BitmaskEnum = "/Script/SkateboardingSim.ESkatingTrickMovementState"))
+	int32 RequiredMovementStates = static_cast<int32>(ESkatingTrickMovementState::InAir);
+
+	/** Max time between first and last input of InputSequence, 0 for no limit */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Combo", meta = (UIMin = "0", ClampMin = "0", Units = "Seconds"))
+	float MaxSequenceDuration = 0.f;
+
+	FORCEINLINE bool CanStartFrom(const ESkatingTrickMovementState MovementState) const
+	{
+		return EnumHasAnyFlags(static_cast<ESkatingTrickMovementState>(RequiredMovementStates), MovementState);
+	}
+
+	bool operator==(const FSkatingTrick& Other) const
+	{
+		return Name == Other.Name;  // Equality is based only on the Name
+	}
+
+	/** Converts deprecated per frame score, assuming the 60 fps it was tuned at */
+	void PostSerialize(const FArchive& Ar);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSkatingTrick> : public TStructOpsTypeTraitsBase2<FSkatingTrick>
+{
+	enum
+	{
+		WithPostSerialize = true,
+	};
+};
+
+/** Small handle to a trick of a USkatingTrickRegistry, passed around instead of copying the trick */
+USTRUCT(BlueprintType)
+struct FSkatingTrickHandle
+{
+	GENERATED_BODY()
+public:
+	FSkatingTrickHandle() = default;
+	explicit FSkatingTrickHandle(const int32 InIndex) : Index(InIndex) {}
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+	FORCEINLINE int32 GetIndex() const { return Index; }
+
+	FORCEINLINE void Reset() { Index = INDEX_NONE; }
+
+	bool operator==(const FSkatingTrickHandle& Other) const { return Index == Other.Index; }
+	bool operator!=(const FSkatingTrickHandle& Other) const { return Index != Other.Index; }
+
+	friend uint32 GetTypeHash(const FSkatingTrickHandle& Handle) { return ::GetTypeHash(Handle.Index); }
+
+private:
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+};
+
+/**
+ * Data Asset holding all tricks skaters can perform.
+ * Montages are soft references streamed in on demand, so characters don't hard load them.
+ */
+UCLASS(BlueprintType)
+class SKATEBOARDINGSIM_API USkatingTrickRegistry : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Streams in montages of all tricks, does nothing if already requested */
+	void RequestMontagesAsyncLoad();
+
+	/** Returns handle of trick with Name or an invalid handle if there's none */
+	UFUNCTION(BlueprintPure, Category = "Tricks")
+	FSkatingTrickHandle FindTrick(const FName Name) const;
+
+	/** Returns trick of Handle, nullptr if Handle doesn't belong to this registry */
+	FORCEINLINE const FSkatingTrick* GetTrick(const FSkatingTrickHandle Handle) const
+	{
+		return Tricks.IsValidIndex(Handle.GetIndex()) ? &Tricks[Handle.GetIndex()] : nullptr;
+	}
+
+	/** Copies trick of Handle into OutTrick for Blueprints, returns false if Handle doesn't belong to this registry */
+	UFUNCTION(BlueprintPure, Category = "Tricks", meta = (DisplayName = "Get Trick"))
+	bool GetTrickData(const FSkatingTrickHandle Handle, FSkatingTrick& OutTrick) const;
+
+	UFUNCTION(BlueprintPure, Category = "Tricks")
+	FName GetTrickName(const FSkatingTrickHandle Handle) const;
+
+	/** Whether montages of Handle's trick are loaded and it can be played without a hitch */
+	UFUNCTION(BlueprintPure, Category = "Tricks")
+	bool AreTrickMontagesLoaded(const FSkatingTrickHandle Handle) const;
+
+	FORCEINLINE int32 Num() const { return Tricks.Num(); }
+
+	/** Id of trick Name stored in files instead of handles, the same in every session unlike handles or FName indices */
+	static uint32 GetTrickId(const FName Name);
+
+	/** Returns handle of trick with TrickId or an invalid handle if there's none */
+	FSkatingTrickHandle FindTrickById(const uint32 TrickId) const;
+
+	/** Changes whenever tricks are added, removed or renamed, files store it next to trick ids */
+	FORCEINLINE uint32 GetVersion() const { return Version; }
+
+	/** Replaces all tricks, used to migrate tricks configured before registries existed */
+	void SetTricks(TArray<FSkatingTrick>&& InTricks);
+
+	/**
+	 * Feeds Input to ComboState and returns the longest combo it completes that can start from MovementState,
+	 * or an invalid handle if it completes none
+	 */
+	FSkatingTrickHandle AdvanceCombo(FSkatingComboState& ComboState, const ESkatingTrickInput Input, const double Time, const ESkatingTrickMovementState MovementState) const;
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	/** Compiles ComboTable and rebuilds TrickIds and Version */
+	void OnTricksChanged();
+
+private:
+	UPROPERTY(EditDefaultsOnly, Category = "Tricks", meta = (TitleProperty = "Name"))
+	TArray<FSkatingTrick> Tricks;
+
+	/** Max time between two inputs of a combo, later inputs start a new combo */
+	UPROPERTY(EditDefaultsOnly, Category = "Combo", meta = (UIMin = "0", ClampMin = "0", Units = "Seconds"))
+	float ComboInputWindow = 0.4f;
+
+	/** Input sequences of Tricks compiled on load */
+	FSkatingComboTable ComboTable;
+
+	/** GetTrickId of each of Tricks */
+	TArray<uint32> TrickIds;
+
+	uint32 Version = 0;
+
+	/** Keeps streamed montages loaded as long as the registry is */
+	TSharedPtr<FStreamableHandle> MontagesHandle;
+};
@@ -4,45 +4,16 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Movement/SkatingTrickRegistry.h"
 #include "SkatingTricksComponent.generated.h"
 
+class USkatingEventSubsystem;
+struct FSkatingLandedEvent;
 
-/** Represents a single skating trick like a Flip, a Grab, etc. */
-USTRUCT(BlueprintType)
-struct FSkatingTrick
-{
-	GENERATED_BODY()
-public:
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	FName Name;
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	TObjectPtr<UAnimMontage> SkaterMontage;
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	TObjectPtr<UAnimMontage> SkateboardMontage;
-
-	/** Montages Play Rate */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	float PlayRate = 1.f;
-
-	/** Score to Accumulate At the Start of trick */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	float BaseScore = 50.f;
-
-	/** Score to Accumulate as the trick is performed */
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	float ScorePerFrame;
-
-	bool operator==(const FSkatingTrick& Other) const
-	{
-		return Name == Other.Name;  // Equality is based only on the Name
-	}
-};
 
-// Skating Tricks Delegates
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSkatingTrickStarted, const FSkatingTrick, SkatingTrick);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSkatingTrickEnded, const FSkatingTrick, SkatingTrick, bool, bWasSuccessful);
+// Skating Tricks Delegates, trick data is looked up from the registry with the handle
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSkatingTrickStarted, const FSkatingTrickHandle, SkatingTrick);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSkatingTrickEnded, const FSkatingTrickHandle, SkatingTrick, bool, bWasSuccessful);
 
 /** Component responsible for performing skating tricks */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent, ValidOwnerClass = "Character"))
@@ -54,30 +25,65 @@ public:
 	USkatingTricksComponent();
 
 	UFUNCTION(BlueprintPure)
-	bool CanPerformSkatingTrick(const FSkatingTrick& SkatingMove) const;
+	bool CanPerformSkatingTrick(const FSkatingTrickHandle SkatingTrick) const;
 
 	UFUNCTION(BlueprintCallable)
-	bool PerformTrick(const FSkatingTrick& SkatingTrick);
+	bool PerformTrick(const FSkatingTrickHandle SkatingTrick);
 
 	UFUNCTION(BlueprintCallable)
 	bool PerformRandomFlipTrick();
 
+	/** Seeds random flip picks, input replays seed it from their recording so they pick the same flips */
+	FORCEINLINE void SetRandomSeed(const int32 Seed) { RandomStream.Initialize(Seed); }
+
 	UFUNCTION(BlueprintCallable)
 	bool PerformGrindingTrick();
 
+	/**
+	 * Feeds Input to the combo engine and performs the combo it completes, if any
+	 * @Return whether a combo trick was started
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool HandleTrickInput(const ESkatingTrickInput Input);
+
+	/** Turns move input into directional combo inputs, emitted when the dominant direction changes */
+	void HandleTrickDirection(const FVector2D& MoveInput);
+
+	/** Current movement state, matched against tricks required movement states */
+	UFUNCTION(BlueprintPure)
+	ESkatingTrickMovementState GetTrickMovementState() const;
+
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE FSkatingTrickHandle GetActiveSkatingTrick() const { return ActiveTrick; }
+
 	UFUNCTION(BlueprintPure)
-	FORCEINLINE TOptional<FSkatingTrick> GetActiveSkatingTrick() const { return ActiveTrick; }
+	FORCEINLINE USkatingTrickRegistry* GetTrickRegistry() const { return TrickRegistry; }
+
+	/** Moves tricks configured on the component before registries existed into a registry */
+	virtual void PostLoad() override;
 
 protected:
 	virtual void OnRegister() override;
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
+	void OnSkaterLanded(const FSkatingLandedEvent& Event);
+
+	/** Landing without an event subsystem, called directly by the owner */
 	UFUNCTION()
 	void OnOwnerLanded(const FHitResult& Hit);
 
+	/** Ends the active trick, successfully unless we bail */
+	void EndActiveTrick();
+
+	/** Resolves configured trick names to registry handles and starts streaming their montages */
+	void ResolveTricks();
+
 public:
+	/** Blueprint adapters of TrickStarted and TrickEnded skating events, native listeners should use USkatingEventSubsystem */
 	UPROPERTY(BlueprintAssignable)
 	FOnSkatingTrickStarted OnSkatingTrickStarted;
 
@@ -85,17 +91,47 @@ public:
 	FOnSkatingTrickEnded OnSkatingTrickEnded;
 
 protected:
+	/** Registry all tricks performed by this component come from */
 	UPROPERTY(EditAnywhere, Category = "Config")
-	TArray<FSkatingTrick> FlipTricks;
+	TObjectPtr<USkatingTrickRegistry> TrickRegistry;
 
+	/** Names of registry tricks performed as flips */
 	UPROPERTY(EditAnywhere, Category = "Config")
-	FSkatingTrick GrindingTrick;
+	TArray<FName> FlipTrickNames;
+
+	/** Name of registry trick performed when starting to grind */
+	UPROPERTY(EditAnywhere, Category = "Config")
+	FName GrindingTrickName;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Tricks live in TrickRegistry, flips are referenced by FlipTrickNames"))
+	TArray<FSkatingTrick> FlipTricks_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Tricks live in TrickRegistry, the grinding trick is referenced by GrindingTrickName"))
+	FSkatingTrick GrindingTrick_DEPRECATED;
 
-	UPROPERTY(EditDefaultsOnly, Category = "State")
-	TOptional<FSkatingTrick> ActiveTrick;
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	FSkatingTrickHandle ActiveTrick;
+
+private:
+	/** Flip tricks resolved from FlipTrickNames on BeginPlay */
+	TArray<FSkatingTrickHandle> FlipTricks;
+
+	FSkatingTrickHandle GrindingTrick;
+
+	FSkatingComboState ComboState;
+
+	/** Last direction sent to the combo engine, Num when move input is neutral */
+	ESkatingTrickInput LastDirectionInput = ESkatingTrickInput::Num;
+
+	FRandomStream RandomStream;
 
 private:
 	UPROPERTY()
 	TObjectPtr<ACharacter> OwnerCharacter;
+
+	UPROPERTY()
+	TObjectPtr<USkatingEventSubsystem> EventSubsystem;
+
+	FDelegateHandle LandedHandle;
 };
 
@@ -0,0 +1,85 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrindRailSamples.generated.h"
+
+class USplineComponent;
+
+/** Result of a closest point query against FGrindRailSamples */
+struct FGrindRailPoint
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+	float Distance = 0.f;
+};
+
+/**
+ * Arc-length table of a grind rail in SoA layout.
+ * Answers closest point and distance queries without solving against the whole spline.
+ */
+USTRUCT()
+struct SKATEBOARDINGSIM_API FGrindRailSamples
+{
+	GENERATED_BODY()
+
+public:
+	/** Samples Spline every SampleSpacing in local space */
+	void BakeFromSpline(const USplineComponent& Spline, const float SampleSpacing);
+
+	/** Samples the straight segments between Points every SampleSpacing, in the space of Points */
+	void BakeFromPolyline(TConstArrayView<FVector> Points, const float SampleSpacing);
+
+	void Reset();
+
+	/** Finds closest point on the rail to Location, refined inside the closest segment */
+	bool FindClosestPoint(const FVector& Location, FGrindRailPoint& OutPoint) const;
+
+	/** Point at Distance along the rail, clamped to the rail ends */
+	FGrindRailPoint GetPointAtDistance(const float Distance) const;
+
+	FORCEINLINE int32 Num() const { return Positions.Num(); }
+	FORCEINLINE bool IsEmpty() const { return Positions.Num() < 2; }
+	FORCEINLINE float GetLength() const { return Distances.Num() ? Distances.Last() : 0.f; }
+	FORCEINLINE const FBox& GetBounds() const { return Bounds; }
+
+	/** Bulk serializes samples, derived bounds are rebuilt on load */
+	bool Serialize(FArchive& Ar);
+
+private:
+	void BuildChunkBounds();
+
+	/** Evaluates the cubic hermite curve of a segment at Alpha */
+	FVector EvaluateSegment(const int32 SegmentIndex, const float Alpha) const;
+	FVector EvaluateSegmentDerivative(const int32 SegmentIndex, const float Alpha) const;
+
+public:
+	UPROPERTY()
+	TArray<FVector> Positions;
+
+	/** Unit tangents along the rail */
+	UPROPERTY()
+	TArray<FVector> Tangents;
+
+	/** Distance along the rail of every sample */
+	UPROPERTY()
+	TArray<float> Distances;
+
+	/** Bounds of every ChunkSize segments, used to skip far parts of long rails */
+	TArray<FSphere> ChunkBounds;
+
+	/** Bounds of the whole rail */
+	FBox Bounds = FBox(ForceInit);
+
+	static constexpr int32 ChunkSize = 16;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGrindRailSamples> : public TStructOpsTypeTraitsBase2<FGrindRailSamples>
+{
+	enum
+	{
+		WithSerializer = true,
+	};
+};
@@ -0,0 +1,121 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Obstacles/GrindingSplineComponent.h"
+#include "Obstacles/GrindRailSamples.h"
+#include "GrindRailSet.generated.h"
+
+class UStaticMesh;
+
+/** Where a character is grinding on a rail set */
+USTRUCT()
+struct FGrindRailState
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	int32 RailIndex = INDEX_NONE;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	float Distance = 0.f;
+
+	/** Rail end the character is grinding towards */
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	float TargetDistance = 0.f;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	bool bYawInversed = false;
+};
+
+/**
+ * Grind rails of a level baked from the collision of grindable static meshes, one actor per level.
+ * Rails are extracted from long sharp convex edges when baking in editor and on save, then bulk loaded
+ * with the level as plain samples, so big parks don't need a spline component per grindable edge.
+ * Any number of characters can grind the set at once, each with its own rail state.
+ */
+UCLASS()
+class SKATEBOARDINGSIM_API AGrindRailSet : public AActor, public IGrindable
+{
+	GENERATED_BODY()
+
+public:
+	AGrindRailSet();
+
+	//~ Begin IGrindable Interface.
+	virtual void OnGrindingStarted(ACharacter* Character) override;
+	virtual void OnGrindingEnded(ACharacter* Character) override;
+	virtual bool IsGrindable(ACharacter* Character) const override;
+	virtual void UpdateGrinding(ACharacter* Character, const float DeltaSeconds) override;
+	virtual float GetGrindingDistance(const ACharacter* Character) const override;
+	virtual void SetGrindingDistance(ACharacter* Character, const float Distance) override;
+	//~ End IGrindable Interface.
+
+	/** Finds closest point on any rail to Location, returns the rail index or INDEX_NONE if none is within MaxDistance */
+	int32 FindClosestRailPoint(const FVector& Location, const float MaxDistance, FGrindRailPoint& OutPoint) const;
+
+	FORCEINLINE TConstArrayView<FGrindRailSamples> GetRails() const { return Rails; }
+
+	/** Adds a rail along world space Points, for rails built at runtime rather than baked from meshes */
+	void AddRail(TConstArrayView<FVector> Points);
+
+#if WITH_EDITOR
+	/** Extracts rails from the collision of every GrindableMeshes instance in the level */
+	UFUNCTION(CallInEditor, Category = "Config")
+	void BakeRails();
+
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void MoveCharacterToRail(ACharacter* Character, const FGrindRailState& RailState) const;
+
+	void EndGrinding(ACharacter* Character) const;
+
+private:
+	/** Meshes whose level instances get rails baked from their simple collision */
+	UPROPERTY(EditAnywhere, Category = "Config|Baking")
+	TArray<TSoftObjectPtr<UStaticMesh>> GrindableMeshes;
+
+	/** Collision edges shorter than this aren't grindable, chained edges count as one */
+	UPROPERTY(EditAnywhere, Category = "Config|Baking", meta = (UIMin = "0", ClampMin = "0"))
+	float MinRailLength = 100.f;
+
+	/** Min angle between the faces of a collision edge for it to be grindable */
+	UPROPERTY(EditAnywhere, Category = "Config|Baking", meta = (UIMin = "0", UIMax = "180", ClampMin = "0", ClampMax = "180", Units = "Degrees"))
+	float MinEdgeSharpness = 45.f;
+
+	/** Max slope of a grindable edge, steeper edges are walls rather than rails */
+	UPROPERTY(EditAnywhere, Category = "Config|Baking", meta = (UIMin = "0", UIMax = "90", ClampMin = "0", ClampMax = "90", Units = "Degrees"))
+	float MaxRailSlope = 35.f;
+
+	/** Max angle between connected edges chained into the same rail */
+	UPROPERTY(EditAnywhere, Category = "Config|Baking", meta = (UIMin = "0", UIMax = "90", ClampMin = "0", ClampMax = "90", Units = "Degrees"))
+	float MaxChainAngle = 20.f;
+
+	/** Distance between baked rail samples */
+	UPROPERTY(EditAnywhere, Category = "Config|Baking", meta = (UIMin = "1", ClampMin = "1"))
+	float RailSampleSpacing = 25.f;
+
+	/** Max distance between character and rail to be able to start grinding */
+	UPROPERTY(EditAnywhere, Category = "Config|Grinding")
+	float MaxAllowedDistanceToGrind = 100.f;
+
+	/** Speed of grinding along rails */
+	UPROPERTY(EditAnywhere, Category = "Config|Grinding")
+	float GrindingSpeed = 800.f;
+
+	/** Baked world space rails */
+	UPROPERTY()
+	TArray<FGrindRailSamples> Rails;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "State")
+	TMap<TObjectPtr<ACharacter>, FGrindRailState> GrindingCharacters;
+};
@@ -0,0 +1,80 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GrindableSubsystem.generated.h"
+
+class UGrindingSplineComponent;
+struct FGrindRailSamples;
+
+/** A straight piece of a registered grindable */
+struct FGrindableSegment
+{
+	TWeakObjectPtr<UObject> Grindable;
+
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	/** Last query that tested this segment, avoids testing segments spanning several cells twice */
+	mutable uint32 QueryStamp = 0;
+};
+
+/**
+ * World Subsystem keeping a uniform grid of grindable segments,
+ * so finding nearby grindables doesn't need to go through the physics scene
+ */
+UCLASS(Config = Game)
+class SKATEBOARDINGSIM_API UGrindableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds segments of Spline's baked rail samples to the grid */
+	void RegisterGrindableSpline(UGrindingSplineComponent* Spline);
+
+	/** Adds segments of world space Rails to the grid, all owned by Grindable */
+	void RegisterGrindableRails(UObject* Grindable, TConstArrayView<FGrindRailSamples> Rails);
+
+	/** Removes all segments of Grindable from the grid */
+	void UnregisterGrindable(UObject* Grindable);
+
+	/**
+	 * Finds the grindable closest to the capsule going from Start to End
+	 * @Param Radius max distance between the capsule axis and a grindable segment
+	 * @Return closest grindable or nullptr if none is in range
+	 */
+	UObject* FindClosestGrindable(const FVector& Start, const FVector& End, const float Radius) const;
+
+	FORCEINLINE int32 GetNumSegments() const { return Segments.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void AddSegment(UObject* Grindable, const FVector& Start, const FVector& End);
+
+	void AddSegmentToGrid(const int32 SegmentIndex);
+
+	void RemoveSegmentFromGrid(const int32 SegmentIndex);
+
+	FIntVector GetCellCoordinates(const FVector& Location) const;
+
+private:
+	/** Size of a single grid cell */
+	UPROPERTY(Config)
+	float GridCellSize = 400.f;
+
+	/** Sparse so indices in cells stay valid when a grindable's segments are removed */
+	TSparseArray<FGrindableSegment> Segments;
+
+	/** Segment indices overlapping each cell */
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	/** Segment indices of each grindable, so unregistering only touches the cells it occupies */
+	TMap<TObjectKey<UObject>, TArray<int32>> GrindableSegments;
+
+	mutable uint32 CurrentQueryStamp = 0;
+};
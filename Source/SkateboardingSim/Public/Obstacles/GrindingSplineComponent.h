@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/SplineComponent.h"
+#include "Obstacles/GrindRailSamples.h"
 #include "GrindingSplineComponent.generated.h"
 
 // This class does not need to be modified.
@@ -31,8 +32,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Grinding")
 	virtual bool IsGrindable(ACharacter* Character) const { return true; }
 
+	/** Advances Character along the grindable, called by the character's movement component every simulation step */
 	UFUNCTION(BlueprintCallable, Category = "Grinding")
-	virtual void UpdateGrinding(const float DeltaSeconds) {}
+	virtual void UpdateGrinding(ACharacter* Character, const float DeltaSeconds) {}
+
+	/** Distance Character has grinded along the grindable, used to replicate grinding */
+	UFUNCTION(BlueprintCallable, Category = "Grinding")
+	virtual float GetGrindingDistance(const ACharacter* Character) const { return 0.f; }
+
+	/** Puts Character back at Distance along the grindable, it's moved there on the next UpdateGrinding */
+	UFUNCTION(BlueprintCallable, Category = "Grinding")
+	virtual void SetGrindingDistance(ACharacter* Character, const float Distance) {}
 
 };
 
@@ -54,12 +64,35 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Grinding")
 	bool IsGrindable(ACharacter* Character) const override;
 	UFUNCTION(BlueprintCallable, Category = "Grinding")
-	void UpdateGrinding(const float DeltaSeconds) override;
+	void UpdateGrinding(ACharacter* Character, const float DeltaSeconds) override;
+	UFUNCTION(BlueprintCallable, Category = "Grinding")
+	float GetGrindingDistance(const ACharacter* Character) const override;
+	UFUNCTION(BlueprintCallable, Category = "Grinding")
+	void SetGrindingDistance(ACharacter* Character, const float Distance) override;
 	//~ End IGrindable Interface.
 
 public:
 	UGrindingSplineComponent();
 
+	//~ Begin USplineComponent Interface.
+	virtual void UpdateSpline() override;
+	//~ End USplineComponent Interface.
+
+	/** Finds closest point on the baked rail samples to WorldLocation */
+	bool FindClosestRailPoint(const FVector& WorldLocation, FGrindRailPoint& OutPoint) const;
+
+	/** Baked rail samples in local space */
+	FORCEINLINE const FGrindRailSamples& GetRailSamples() const { return RailSamples; }
+
+protected:
+	virtual void OnRegister() override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
 	UFUNCTION(BlueprintCallable)
 	void MoveCharacterToTransformAtCurrentDistance();
 
@@ -98,6 +131,15 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Config")
 	float GrindingSpeed;
 
+	/** Distance between baked rail samples, smaller values are more accurate but take more memory */
+	UPROPERTY(EditDefaultsOnly, Category = "Config", meta = (UIMin = "1", ClampMin = "1"))
+	float RailSampleSpacing = 25.f;
+
+private:
+	/** Samples baked from the spline whenever it's registered or edited */
+	UPROPERTY(Transient)
+	FGrindRailSamples RailSamples;
+
 private:
 	UPROPERTY(VisibleInstanceOnly, Category = "State")
 	TOptional<TObjectPtr<ACharacter>> GrindingCharacter;
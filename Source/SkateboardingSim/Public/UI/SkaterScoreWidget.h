@@ -0,0 +1,46 @@
+// Copyright Amr Hamed
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "UIMStackWidget.h"
+#include "SkaterScoreWidget.generated.h"
+
+class UScoreComponent;
+class UTextBlock;
+
+/**
+ * HUD widget showing the owning player's score.
+ * Only listens to score updates while it's the active widget of its layer, covered it costs nothing.
+ */
+UCLASS()
+class SKATEBOARDINGSIM_API USkaterScoreWidget : public UUserWidget, public IUIMStackWidget
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin IUIMStackWidget Interface.
+	virtual void OnStackActivated_Implementation() override;
+	virtual void OnStackSuspended_Implementation() override;
+	//~ End IUIMStackWidget Interface.
+
+protected:
+	/** Called with every score update received while active, and with the current score on activation */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Score")
+	void OnScoreUpdated(float AddedScore, float TotalScore);
+
+private:
+	UFUNCTION()
+	void HandleScoreAdded(float AddedScore, float TotalScore);
+
+	void SetScoreText(const float TotalScore);
+
+protected:
+	UPROPERTY(BlueprintReadOnly, Category = "Score", meta = (BindWidgetOptional))
+	TObjectPtr<UTextBlock> ScoreText;
+
+private:
+	/** Score component of the owning player's pawn, bound while active */
+	TWeakObjectPtr<UScoreComponent> BoundScoreComponent;
+};
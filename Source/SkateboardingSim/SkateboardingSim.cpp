@@ -1,6 +1,24 @@
 // Copyright Amr Hamed
 
 #include "SkateboardingSim.h"
+#include "Core/SkatingMemory.h"
+#include "Misc/CommandLine.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, SkateboardingSim, "SkateboardingSim" );
+DEFINE_LOG_CATEGORY(LogSkateboardingSim);
+
+class FSkateboardingSimModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Earliest point game code runs, well before gameplay allocates from skating scopes
+		// -SkateCountAllocations counts them without benchmarking, e.g. for the benchmark automation tests
+		if (FParse::Param(FCommandLine::Get(), TEXT("SkateBenchmark")) || FParse::Param(FCommandLine::Get(), TEXT("SkateCountAllocations")))
+		{
+			SkatingMemory::InstallAllocationCounter();
+		}
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FSkateboardingSimModule, SkateboardingSim, "SkateboardingSim" );